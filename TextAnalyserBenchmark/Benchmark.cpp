@@ -0,0 +1,565 @@
+/**
+* Benchmark.cpp
+*
+* Misst alle öffentlichen Funktionen der Bibliothek auf synthetischen Korpora, sequentiell, parallel und als Stream.
+* Pro Fall werden Median und p99 der Laufzeit sowie Byte und Worte pro Sekunde als JSON ausgegeben.
+* Die Kopie des Textes für Funktionen die ihn verändern liegt außerhalb der Messung.
+*
+* Beispiel:	./benchmark --sizes 64K,16M --formats all --output result.json
+*/
+#include "Corpus.h"
+#include "../TextParser/TextAnalyser.h"
+#include "../TextParser/AnalyzedDocument.h"
+#include "../TextParser/CleanupFilters.h"
+#include "../TextParser/CorpusAnalyser.h"
+#include "../TextParser/InvertedIndex.h"
+#include "../TextParser/KeywordSearch.h"
+#include "../TextParser/MappedFile.h"
+#include "../TextParser/PatternMatcher.h"
+#include "../TextParser/SimdKernels.h"
+#include "../TextParser/StopWordFilter.h"
+#include "../TextParser/TokenTable.h"
+#include "../TextParser/Utf8.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+using namespace AnalyserLib;
+using namespace AnalyserBenchmark;
+
+/**
+* Ein Korpus mit allem was die Fälle zusätzlich zum Text brauchen. Die Teile werden erst beim ersten Bedarf
+* erstellt, außerhalb der Messung.
+*/
+struct Fixture
+{
+    string name;
+    string text;
+    /// Anzahl der Worte, für tokens/s
+    uint64_t tokens = 0;
+    /// Kopie für Funktionen die den Text verändern, wird vor jedem Durchlauf neu gefüllt
+    string scratch;
+
+    /// der Korpus in Dokumente von etwa 64 KB, für die Funktionen über mehrere Dokumente
+    const stringList& documents()
+    {
+        if (documentList.empty())
+        {
+            for (size_t begin = 0; begin < text.size();)
+            {
+                size_t end = text.find("\n\n", min(text.size(), begin + (1 << 16)));
+                end = (end == string::npos) ? text.size() : end + 2;
+                documentList.push_back(text.substr(begin, end - begin));
+                begin = end;
+            }
+        }
+        return documentList;
+    }
+
+    const stringList& words()
+    {
+        if (wordList.empty())
+            wordList = splitTextIntoStringList(text, true);
+        return wordList;
+    }
+
+    /// die 200 häufigsten Worte, als Begriffe für KeywordSearch und die Abfragen auf den Index
+    const vector<string>& keywords()
+    {
+        if (keywordList.empty())
+        {
+            wordDistribution counts = createWordDistribution(text, true);
+            vector<pair<int, string>> sorted;
+            for (const auto& entry : counts)
+                sorted.emplace_back(-entry.second, entry.first);
+            sort(sorted.begin(), sorted.end());
+            for (size_t i = 0; i < sorted.size() && i < 200; ++i)
+                keywordList.push_back(sorted[i].second);
+        }
+        return keywordList;
+    }
+
+    const InvertedIndex& index()
+    {
+        if (!invertedIndex)
+        {
+            invertedIndex = make_unique<InvertedIndex>();
+            for (const string& document : documents())
+                invertedIndex->addDocument(document);
+        }
+        return *invertedIndex;
+    }
+
+    /// eine Datei mit dem Korpus für readFile und MappedFile, wird am Ende gelöscht
+    const string& path()
+    {
+        if (filePath.empty())
+        {
+            filePath = "textanalyser_benchmark_" + name + ".txt";
+            ofstream out(filePath, ios::binary);
+            out.write(text.data(), static_cast<streamsize>(text.size()));
+        }
+        return filePath;
+    }
+
+    /// die Dokumente als einzelne Dateien in einem Verzeichnis, für analyseCorpus
+    const stringList& files()
+    {
+        if (fileList.empty())
+        {
+            directory = "textanalyser_benchmark_" + name;
+            filesystem::create_directories(directory);
+            for (size_t i = 0; i < documents().size(); ++i)
+            {
+                fileList.push_back(directory + "/" + to_string(i) + ".txt");
+                ofstream out(fileList.back(), ios::binary);
+                out.write(documents()[i].data(), static_cast<streamsize>(documents()[i].size()));
+            }
+        }
+        return fileList;
+    }
+
+    ~Fixture()
+    {
+        if (!filePath.empty())
+            remove(filePath.c_str());
+        if (!directory.empty())
+            filesystem::remove_all(directory);
+    }
+
+private:
+    stringList documentList;
+    stringList wordList;
+    vector<string> keywordList;
+    unique_ptr<InvertedIndex> invertedIndex;
+    string filePath;
+    stringList fileList;
+    string directory;
+};
+
+/**
+* Ein gemessener Fall. run gibt einen Wert aus dem Ergebnis zurück, damit der Compiler den Aufruf nicht entfernt.
+*/
+struct BenchCase
+{
+    string name;
+    /// auch auf HTML und Markdown messen, sonst nur auf plain
+    bool allFormats;
+    /// vor jedem Durchlauf wird fixture.scratch mit dem Text gefüllt
+    bool copyText;
+    /// einmal pro Korpus vor der Messung
+    function<void(Fixture&)> prepare;
+    function<size_t(Fixture&)> run;
+};
+
+/**
+* Das Ergebnis eines Falls auf einem Korpus, Zeiten in Sekunden
+*/
+struct CaseResult
+{
+    string name;
+    string corpus;
+    uint64_t bytes;
+    uint64_t tokens;
+    size_t iterations;
+    double median;
+    double p99;
+    double minimum;
+    double mean;
+};
+
+/**
+* Einstellungen von der Kommandozeile
+*/
+struct BenchSettings
+{
+    vector<uint64_t> sizes{ 1 << 20 };
+    vector<corpusLanguage> languages{ corpusLanguage::german, corpusLanguage::english };
+    vector<corpusFormat> formats{ corpusFormat::plain };
+    string filter;
+    double minTime = 0.5;
+    size_t minIterations = 5;
+    size_t maxIterations = 1000;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+    string output;
+    bool list = false;
+};
+
+static size_t countTokens(string_view text)
+{
+    size_t n = 0;
+    for (const Token& t : tokenize(text))
+        n += t.value.size();
+    return n;
+}
+
+/**
+* Alle Fälle, gruppiert wie in TextAnalyser.h
+*/
+static vector<BenchCase> makeCases()
+{
+    auto none = [](Fixture&) {};
+    auto documents = [](Fixture& f) { f.documents(); };
+    auto keywords = [](Fixture& f) { f.documents(); f.keywords(); };
+
+    const string german = "\\b\\w{6}\\b";
+    vector<BenchCase> cases = {
+        // Zerlegen
+        { "splitTextIntoStringList", false, false, none, [](Fixture& f) { return splitTextIntoStringList(f.text).size(); } },
+        { "splitTextIntoStringList(lower)", false, false, none, [](Fixture& f) { return splitTextIntoStringList(f.text, true).size(); } },
+        { "splitTextIntoStringListAsync", false, false, none, [](Fixture& f) { return splitTextIntoStringListAsync(f.text).size(); } },
+        { "tokenize", false, false, none, [](Fixture& f) { return countTokens(f.text); } },
+        { "tokenizeUtf8", false, false, none, [](Fixture& f) { size_t n = 0; for (const Token& t : tokenizeUtf8(f.text)) n += t.value.size(); return n; } },
+        { "toLowerUtf8", false, false, none, [](Fixture& f) { string buffer; size_t n = 0; for (const Token& t : tokenize(f.text)) { toLowerUtf8(t.value, buffer); n += buffer.size(); } return n; } },
+        { "TokenTable::build(lower)", false, false, none, [](Fixture& f) { AnalysisOptions o; o.useLowerCase = true; return TokenTable(f.text, o).size(); } },
+
+        // Zählen und Kennzahlen, der StatsCache wird vor jedem Durchlauf geleert
+        { "countTotalWords", false, false, none, [](Fixture& f) { return static_cast<size_t>(countTotalWords(f.text)); } },
+        { "countTotalWordsAsync", false, false, none, [](Fixture& f) { return static_cast<size_t>(countTotalWordsAsync(f.text)); } },
+        { "calculateWordLength", false, false, none, [](Fixture& f) { return static_cast<size_t>(calculateWordLength(f.text)); } },
+        { "calculateSentenceLengthByWords", false, false, none, [](Fixture& f) { return static_cast<size_t>(calculateSentenceLengthByWords(f.text)); } },
+        { "calculateSentenceLengthByLetters", false, false, none, [](Fixture& f) { return static_cast<size_t>(calculateSentenceLengthByLetters(f.text)); } },
+        { "calculateGermanScore", false, false, none, [](Fixture& f) { return static_cast<size_t>(calculateGermanScore(f.text)); } },
+        { "calculateWordLengthDistibution", false, false, none, [](Fixture& f) { return calculateWordLengthDistibution(f.text).size(); } },
+        { "calculateWordLengthDistibutionAsync", false, false, none, [](Fixture& f) { return calculateWordLengthDistibutionAsync(f.text).size(); } },
+
+        // Wortverteilung
+        { "createWordDistribution", false, false, none, [](Fixture& f) { return createWordDistribution(f.text).size(); } },
+        { "createWordDistribution(lower)", false, false, none, [](Fixture& f) { return createWordDistribution(f.text, true).size(); } },
+        { "createWordDistribution(stopWords)", false, false, none, [](Fixture& f) { return createWordDistribution(f.text, StopWordFilter::german(), true).size(); } },
+        { "createWordDistribution(wordList)", false, false, [](Fixture& f) { f.words(); }, [](Fixture& f) { return createWordDistribution(f.words(), StopWordFilter::german()).size(); } },
+        { "createWordDistributionAsync(wordList)", false, false, [](Fixture& f) { f.words(); }, [](Fixture& f) { return createWordDistributionAsync(f.words(), StopWordFilter::german()).size(); } },
+        { "createWordIdDistribution", false, false, none, [](Fixture& f) { Vocabulary v; return createWordIdDistribution(f.text, v, true).size(); } },
+        { "createApproximateWordDistribution", false, false, none, [](Fixture& f) { return static_cast<size_t>(createApproximateWordDistribution(f.text, ApproximateOptions(), true).total()); } },
+
+        // Wortpaare
+        { "findConnectedWords", false, false, none, [](Fixture& f) { return findConnectedWords(f.text).size(); } },
+        { "findConnectedWords(range 4)", false, false, none, [](Fixture& f) { return findConnectedWords(f.text, 2, 4).size(); } },
+        { "findConnectedWordsAsync", false, false, none, [](Fixture& f) { return findConnectedWordsAsync(f.text).size(); } },
+        { "findConnectedWords(stopWords)", false, false, none, [](Fixture& f) { return findConnectedWords(f.text, StopWordFilter::german()).size(); } },
+        { "findConnectedWordIds", false, false, none, [](Fixture& f) { Vocabulary v; return findConnectedWordIds(f.text, v).size(); } },
+        { "findConnectedWordsApproximate", false, false, none, [](Fixture& f) { return static_cast<size_t>(findConnectedWordsApproximate(f.text).total()); } },
+
+        // alles in einem Durchlauf, parallel und als Stream
+        { "analyseText", false, false, none, [](Fixture& f) { return analyseText(f.text).words.size(); } },
+        { "analyseText(stats)", false, false, none, [](Fixture& f) { return static_cast<size_t>(analyseText(f.text, metricStats).stats.words); } },
+        { "analyseTextAsync", false, false, none, [](Fixture& f) { return analyseTextAsync(f.text).words.size(); } },
+        { "StreamAnalyser(64K)", false, false, none, [](Fixture& f) {
+            StreamAnalyser stream;
+            for (size_t pos = 0; pos < f.text.size(); pos += 1 << 16)
+                stream.feed(string_view(f.text).substr(pos, 1 << 16));
+            return stream.finish().words.size(); } },
+        { "analyseStream(istream)", false, true, none, [](Fixture& f) { istringstream in(move(f.scratch)); return analyseStream(in).words.size(); } },
+        { "AnalyzedDocument", false, false, none, [](Fixture& f) {
+            AnalyzedDocument doc = AnalyzedDocument::fromView(f.text);
+            return static_cast<size_t>(doc.stats().words) + doc.wordLengths().size() + doc.words().size() + doc.pairs().size(); } },
+
+        // Aufräumen, auch auf HTML und Markdown
+        { "cleanUpText(plain)", true, true, none, [](Fixture& f) { cleanUpText(f.scratch); return f.scratch.size(); } },
+        { "cleanUpText(removeAllSigns)", true, true, none, [](Fixture& f) { cleanUpText(f.scratch, removeAllSigns); return f.scratch.size(); } },
+        { "cleanUpText(HTML)", true, true, none, [](Fixture& f) { cleanUpText(f.scratch, HTML); return f.scratch.size(); } },
+        { "cleanUpText(Markdown)", true, true, none, [](Fixture& f) { cleanUpText(f.scratch, Markdown); return f.scratch.size(); } },
+        { "stripHtml", true, false, none, [](Fixture& f) { return stripHtml(f.text).size(); } },
+        { "stripMarkdown", true, false, none, [](Fixture& f) { return stripMarkdown(f.text).size(); } },
+
+        // Suche
+        { "findPatterns(regex)", false, false, none, [german](Fixture& f) { return findPatterns(f.text, regex(german)).size(); } },
+        { "findPatterns(string)", false, false, none, [german](Fixture& f) { return findPatterns(f.text, string_view(german)).size(); } },
+        { "PatternMatcher::count", false, false, none, [german](Fixture& f) { return PatternMatcher(german).count(f.text); } },
+        { "KeywordSearch::count", false, false, keywords, [](Fixture& f) { keywordCounts c = KeywordSearch(f.keywords()).count(f.text); return static_cast<size_t>(c[0]); } },
+        { "KeywordSearch::countAsync", false, false, keywords, [](Fixture& f) { keywordCounts c = KeywordSearch(f.keywords()).countAsync(f.documents()); return static_cast<size_t>(c[0]); } },
+        { "InvertedIndex::addDocument", false, false, documents, [](Fixture& f) {
+            InvertedIndex index;
+            for (const string& document : f.documents())
+                index.addDocument(document);
+            return index.wordCount(); } },
+        { "InvertedIndex::phrase", false, false, [](Fixture& f) { f.keywords(); f.index(); }, [](Fixture& f) {
+            size_t hits = 0;
+            const vector<string>& k = f.keywords();
+            for (size_t i = 0; i + 1 < k.size() && i < 50; ++i)
+                hits += f.index().phrase(k[i] + " " + k[i + 1]).size();
+            return hits; } },
+
+        // Dateien
+        { "readFile+createWordDistribution(files)", false, false, [](Fixture& f) { f.files(); }, [](Fixture& f) {
+            // die Schleife die analyseCorpus ersetzt, mit der Summe über alle Dateien
+            wordDistribution total;
+            for (const string& path : f.files())
+            {
+                for (const auto& [word, count] : createWordDistribution(readFile(path, None)))
+                    total[word] += count;
+            }
+            return total.size(); } },
+        { "analyseCorpus(files)", false, false, [](Fixture& f) { f.files(); }, [](Fixture& f) {
+            CorpusOptions options;
+            options.metrics = metricWordDistribution;
+            options.cleanup = None;
+            options.keepDocumentResults = false;
+            return analyseCorpus(f.files(), options).total.words.size(); } },
+        { "readFile", true, false, [](Fixture& f) { f.path(); }, [](Fixture& f) { return readFile(f.path()).size(); } },
+        { "MappedFile+analyseText", true, false, [](Fixture& f) { f.path(); }, [](Fixture& f) { MappedFile file(f.path()); return static_cast<size_t>(analyseText(file.view(), metricStats).stats.words); } },
+    };
+    return cases;
+}
+
+/**
+* Misst einen Fall bis minTime und minIterations erreicht sind. Der erste Durchlauf wärmt Caches auf und zählt nicht.
+*/
+static CaseResult measure(BenchCase& c, Fixture& fixture, const BenchSettings& settings, size_t& sink)
+{
+    using clock = chrono::steady_clock;
+    c.prepare(fixture);
+
+    vector<double> samples;
+    double total = 0;
+    for (size_t i = 0; i == 0 || ((samples.size() < settings.minIterations || total < settings.minTime) && samples.size() < settings.maxIterations); ++i)
+    {
+        if (c.copyText)
+            fixture.scratch = fixture.text;
+        clearCache();
+
+        auto start = clock::now();
+        sink += c.run(fixture);
+        double seconds = chrono::duration<double>(clock::now() - start).count();
+        // der erste Durchlauf wärmt auf
+        if (i == 0)
+            continue;
+        samples.push_back(seconds);
+        total += seconds;
+    }
+
+    sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    CaseResult result;
+    result.name = c.name;
+    result.corpus = fixture.name;
+    result.bytes = fixture.text.size();
+    result.tokens = fixture.tokens;
+    result.iterations = n;
+    result.median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    // nächster Rang, bei weniger als 100 Durchläufen ist das der langsamste
+    result.p99 = samples[(n * 99 + 99) / 100 - 1];
+    result.minimum = samples.front();
+    result.mean = total / static_cast<double>(n);
+    return result;
+}
+
+static string jsonEscape(const string& s)
+{
+    string out;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static const char* simdName(simdLevel level)
+{
+    switch (level)
+    {
+    case simdAVX2: return "avx2";
+    case simdSSE2: return "sse2";
+    default: return "none";
+    }
+}
+
+static void writeJson(ostream& out, const BenchSettings& settings, const vector<CaseResult>& results)
+{
+    out.precision(9);
+    out << "{\n";
+    out << "  \"benchmark\": \"TextAnalyser\",\n";
+    out << "  \"schema\": 1,\n";
+    out << "  \"simd\": \"" << simdName(getSimdLevel()) << "\",\n";
+    out << "  \"threads\": " << getThreadCount() << ",\n";
+    out << "  \"hardwareThreads\": " << thread::hardware_concurrency() << ",\n";
+    out << "  \"seed\": " << settings.seed << ",\n";
+    out << "  \"minTime\": " << settings.minTime << ",\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const CaseResult& r = results[i];
+        out << (i ? ",\n" : "\n");
+        out << "    { \"name\": \"" << jsonEscape(r.name) << "\", \"corpus\": \"" << r.corpus << "\""
+            << ", \"bytes\": " << r.bytes << ", \"tokens\": " << r.tokens << ", \"iterations\": " << r.iterations
+            << ", \"medianSeconds\": " << r.median << ", \"p99Seconds\": " << r.p99
+            << ", \"minSeconds\": " << r.minimum << ", \"meanSeconds\": " << r.mean
+            << ", \"bytesPerSecond\": " << static_cast<double>(r.bytes) / r.median
+            << ", \"tokensPerSecond\": " << static_cast<double>(r.tokens) / r.median << " }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+static vector<string> splitList(const string& value)
+{
+    vector<string> parts;
+    stringstream in(value);
+    string part;
+    while (getline(in, part, ','))
+    {
+        if (!part.empty())
+            parts.push_back(part);
+    }
+    return parts;
+}
+
+static void printUsage()
+{
+    cerr << "Aufruf: benchmark [Optionen]\n"
+        << "  --sizes 64K,1M,1G       Größen der Korpora (default 1M)\n"
+        << "  --languages german,english\n"
+        << "  --formats plain,html,markdown|all   (default plain, HTML und Markdown nur für die Aufräum Funktionen)\n"
+        << "  --filter text           nur Fälle deren Name text enthält\n"
+        << "  --min-time 0.5          Sekunden pro Fall und Korpus\n"
+        << "  --min-iterations 5 --max-iterations 1000\n"
+        << "  --threads n             Threads für die Async Funktionen\n"
+        << "  --seed n                Startwert für die Korpora\n"
+        << "  --output datei.json     JSON in eine Datei statt auf stdout\n"
+        << "  --list                  nur die Namen der Fälle ausgeben\n";
+}
+
+/**
+* Liest die Kommandozeile. Gibt false zurück wenn eine Option ungültig ist.
+*/
+static bool parseArguments(int argc, char** argv, BenchSettings& settings)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--list")
+        {
+            settings.list = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        string value = argv[++i];
+
+        if (arg == "--sizes")
+        {
+            settings.sizes.clear();
+            for (const string& s : splitList(value))
+            {
+                uint64_t size = parseSize(s);
+                if (size == 0)
+                    return false;
+                settings.sizes.push_back(size);
+            }
+        }
+        else if (arg == "--languages")
+        {
+            settings.languages.clear();
+            for (const string& s : splitList(value))
+            {
+                if (s == "german")
+                    settings.languages.push_back(corpusLanguage::german);
+                else if (s == "english")
+                    settings.languages.push_back(corpusLanguage::english);
+                else
+                    return false;
+            }
+        }
+        else if (arg == "--formats")
+        {
+            settings.formats.clear();
+            for (const string& s : splitList(value))
+            {
+                if (s == "plain" || s == "all")
+                    settings.formats.push_back(corpusFormat::plain);
+                if (s == "html" || s == "all")
+                    settings.formats.push_back(corpusFormat::html);
+                if (s == "markdown" || s == "all")
+                    settings.formats.push_back(corpusFormat::markdown);
+            }
+            if (settings.formats.empty())
+                return false;
+        }
+        else if (arg == "--filter")
+            settings.filter = value;
+        else if (arg == "--min-time")
+            settings.minTime = stod(value);
+        else if (arg == "--min-iterations")
+            settings.minIterations = max<size_t>(1, stoul(value));
+        else if (arg == "--max-iterations")
+            settings.maxIterations = max<size_t>(1, stoul(value));
+        else if (arg == "--threads")
+            settings.threads = static_cast<unsigned>(stoul(value));
+        else if (arg == "--seed")
+            settings.seed = stoull(value);
+        else if (arg == "--output")
+            settings.output = value;
+        else
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchSettings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        printUsage();
+        return 1;
+    }
+
+    vector<BenchCase> cases = makeCases();
+    if (settings.list)
+    {
+        for (const BenchCase& c : cases)
+            cout << c.name << "\n";
+        return 0;
+    }
+    if (settings.threads > 0)
+        setThreadCount(settings.threads);
+
+    vector<CaseResult> results;
+    size_t sink = 0;
+    for (uint64_t size : settings.sizes)
+    {
+        for (corpusLanguage language : settings.languages)
+        {
+            for (corpusFormat format : settings.formats)
+            {
+                CorpusSpec spec{ language, format, size, settings.seed };
+                Fixture fixture;
+                fixture.name = corpusName(spec);
+                fixture.text = generateCorpus(spec);
+                fixture.tokens = static_cast<uint64_t>(analyseText(fixture.text, metricStats).stats.words);
+                cerr << fixture.name << ": " << fixture.text.size() << " Byte, " << fixture.tokens << " Worte\n";
+
+                for (BenchCase& c : cases)
+                {
+                    if ((format != corpusFormat::plain && !c.allFormats) || c.name.find(settings.filter) == string::npos)
+                        continue;
+
+                    CaseResult r = measure(c, fixture, settings, sink);
+                    fprintf(stderr, "  %-40s %10.3f ms  p99 %10.3f ms  %9.1f MB/s  %8.2f Mtok/s\n", r.name.c_str(),
+                        r.median * 1e3, r.p99 * 1e3, r.bytes / r.median / 1e6, r.tokens / r.median / 1e6);
+                    results.push_back(r);
+                }
+            }
+        }
+    }
+
+    if (settings.output.empty())
+        writeJson(cout, settings, results);
+    else
+    {
+        ofstream out(settings.output);
+        writeJson(out, settings, results);
+    }
+    // sink verhindert dass die Aufrufe wegoptimiert werden
+    return sink == 1 ? 2 : 0;
+}
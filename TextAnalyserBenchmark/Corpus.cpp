@@ -0,0 +1,367 @@
+#include "Corpus.h"
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace AnalyserBenchmark
+{
+    /**
+    * [intern]
+    * SplitMix64, klein und auf jeder Plattform gleich (die Verteilungen der Standardbibliothek sind es nicht)
+    */
+    class CorpusRandom
+    {
+    public:
+        explicit CorpusRandom(uint64_t seed) : state(seed) {}
+
+        uint64_t next()
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /// Gleichverteilt in [0, n)
+        size_t below(size_t n) { return static_cast<size_t>(next() % n); }
+
+        /// Gleichverteilt in [0, 1)
+        double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+        bool chance(double p) { return unit() < p; }
+
+    private:
+        uint64_t state;
+    };
+
+    /**
+    * [intern]
+    * Silben und häufige Worte einer Sprache. Die Umlaute sind UTF-8 kodiert.
+    */
+    struct LanguageParts
+    {
+        vector<const char*> frequent;
+        vector<const char*> onsets;
+        vector<const char*> nuclei;
+        vector<const char*> codas;
+        vector<const char*> suffixes;
+        /// Anteil der Worte die groß geschrieben werden (Substantive)
+        double capitalized;
+    };
+
+    static const LanguageParts& germanParts()
+    {
+        static const LanguageParts parts{
+            { "der", "die", "und", "in", "den", "von", "zu", "das", "mit", "sich", "des", "auf", "f\xC3\xBCr", "ist", "im",
+              "dem", "nicht", "ein", "eine", "als", "auch", "es", "an", "er", "hat", "aus", "bei", "sie", "nach", "wird",
+              "war", "so", "wie", "um", "noch", "wenn", "nur", "oder", "aber", "vor", "zur", "bis", "mehr", "durch",
+              "man", "\xC3\xBC" "ber", "sein", "dass", "ich", "wir", "kann", "schon", "wieder", "immer", "sehr", "hier" },
+            { "", "b", "br", "d", "f", "fl", "g", "gr", "h", "k", "kl", "l", "m", "n", "p", "pf", "r", "s", "sch", "schw",
+              "sp", "st", "str", "t", "tr", "w", "z", "zw" },
+            { "a", "e", "i", "o", "u", "ei", "au", "ie", "eu", "a", "e", "e", "\xC3\xA4", "\xC3\xB6", "\xC3\xBC" },
+            { "", "", "n", "r", "l", "s", "t", "ch", "ck", "ng", "nd", "rt", "st", "\xC3\x9F", "tz", "m", "ft" },
+            { "", "", "", "en", "er", "ung", "heit", "lich", "chen", "keit", "isch" },
+            0.3
+        };
+        return parts;
+    }
+
+    static const LanguageParts& englishParts()
+    {
+        static const LanguageParts parts{
+            { "the", "of", "and", "to", "a", "in", "is", "that", "for", "it", "as", "was", "with", "be", "by", "on",
+              "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "they", "you", "were",
+              "her", "she", "there", "would", "their", "we", "him", "been", "has", "when", "who", "will", "more", "no",
+              "if", "out", "so", "said", "what", "up", "its", "about", "into", "than", "them", "can", "only", "other" },
+            { "", "b", "bl", "c", "ch", "cl", "d", "f", "fr", "g", "gr", "h", "j", "l", "m", "n", "p", "pr", "r", "s",
+              "sh", "sl", "st", "t", "th", "tr", "w", "wh" },
+            { "a", "e", "i", "o", "u", "ea", "ee", "oo", "ai", "ou", "a", "e", "i" },
+            { "", "", "n", "r", "l", "s", "t", "ck", "ng", "nd", "rt", "st", "ll", "ss", "th", "m", "x" },
+            { "", "", "", "", "ing", "ed", "er", "ly", "tion", "ness" },
+            0.02
+        };
+        return parts;
+    }
+
+    /// [intern] Anzahl der künstlichen Worte zusätzlich zu den häufigen Worten
+    constexpr size_t generatedWords = 30000;
+    /// [intern] Exponent der Zipf Verteilung, natürliche Sprache liegt etwa bei 1
+    constexpr double zipfExponent = 1.07;
+
+    /**
+    * [intern]
+    * Der Wortschatz mit den kumulierten Gewichten der Zipf Verteilung. Die häufigen Worte stehen vorne.
+    */
+    class ZipfVocabulary
+    {
+    public:
+        ZipfVocabulary(const LanguageParts& parts, CorpusRandom& random)
+        {
+            unordered_set<string> known;
+            for (const char* w : parts.frequent)
+            {
+                words.emplace_back(w);
+                known.insert(w);
+            }
+
+            while (words.size() < parts.frequent.size() + generatedWords)
+            {
+                string word;
+                size_t syllables = 1 + random.below(3) + (random.chance(0.2) ? 1 : 0);
+                for (size_t s = 0; s < syllables; ++s)
+                {
+                    word += parts.onsets[random.below(parts.onsets.size())];
+                    word += parts.nuclei[random.below(parts.nuclei.size())];
+                    word += parts.codas[random.below(parts.codas.size())];
+                }
+                word += parts.suffixes[random.below(parts.suffixes.size())];
+                if (random.chance(parts.capitalized))
+                    capitalize(word);
+                if (word.size() > 1 && known.insert(word).second)
+                    words.push_back(move(word));
+            }
+
+            double sum = 0;
+            cumulative.reserve(words.size());
+            for (size_t rank = 1; rank <= words.size(); ++rank)
+            {
+                sum += 1.0 / pow(static_cast<double>(rank), zipfExponent);
+                cumulative.push_back(sum);
+            }
+        }
+
+        const string& draw(CorpusRandom& random) const
+        {
+            double x = random.unit() * cumulative.back();
+            size_t low = 0, high = cumulative.size() - 1;
+            while (low < high)
+            {
+                size_t mid = (low + high) / 2;
+                if (cumulative[mid] <= x)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            return words[low];
+        }
+
+        static void capitalize(string& word)
+        {
+            if (!word.empty() && word[0] >= 'a' && word[0] <= 'z')
+                word[0] = static_cast<char>(word[0] - 'a' + 'A');
+        }
+
+    private:
+        vector<string> words;
+        vector<double> cumulative;
+    };
+
+    /**
+    * [intern]
+    * Schreibt Absätze im gewünschten Format
+    */
+    class CorpusWriter
+    {
+    public:
+        CorpusWriter(const CorpusSpec& spec, const LanguageParts& parts)
+            : spec(spec), random(spec.seed), vocabulary(parts, random)
+        {
+        }
+
+        string write()
+        {
+            string text;
+            text.reserve(static_cast<size_t>(spec.size) + 4096);
+            if (spec.format == corpusFormat::html)
+                text += "<!DOCTYPE html>\n<html><head><title>Korpus</title><style>p { margin: 0; }</style></head><body>\n";
+
+            for (size_t paragraph = 0; text.size() < spec.size; ++paragraph)
+            {
+                switch (spec.format)
+                {
+                case corpusFormat::plain: writePlain(text); break;
+                case corpusFormat::html: writeHtml(text, paragraph); break;
+                case corpusFormat::markdown: writeMarkdown(text, paragraph); break;
+                }
+            }
+
+            if (spec.format == corpusFormat::html)
+                text += "</body></html>\n";
+            return text;
+        }
+
+    private:
+        /// ein Wort mit Markup für das Format, ohne Markup bei plain
+        void writeWord(string& out, const string& word)
+        {
+            if (spec.format == corpusFormat::html)
+            {
+                if (random.chance(0.03))
+                {
+                    string tag = random.chance(0.5) ? "b" : "em";
+                    out += "<" + tag + ">" + word + "</" + tag + ">";
+                }
+                else if (random.chance(0.01))
+                    out += "<a href=\"https://example.org/" + word + "\">" + word + "</a>";
+                else
+                    out += word;
+                return;
+            }
+            if (spec.format == corpusFormat::markdown)
+            {
+                if (random.chance(0.03))
+                    out += "**" + word + "**";
+                else if (random.chance(0.03))
+                    out += "*" + word + "*";
+                else if (random.chance(0.01))
+                    out += "[" + word + "](https://example.org/" + word + ")";
+                else if (random.chance(0.01))
+                    out += "`" + word + "`";
+                else
+                    out += word;
+                return;
+            }
+            out += word;
+        }
+
+        void writeSentence(string& out)
+        {
+            size_t length = 4 + random.below(16);
+            for (size_t i = 0; i < length; ++i)
+            {
+                if (i > 0)
+                    out += (random.chance(0.08) ? ", " : " ");
+                string word = vocabulary.draw(random);
+                if (i == 0)
+                    ZipfVocabulary::capitalize(word);
+                if (spec.format == corpusFormat::html && random.chance(0.005))
+                    word = (spec.language == corpusLanguage::german) ? "&auml;hnlich" : "caf&eacute;";
+                writeWord(out, word);
+            }
+
+            double end = random.unit();
+            out += end < 0.85 ? "." : (end < 0.93 ? "?" : "!");
+        }
+
+        void writeSentences(string& out, size_t count)
+        {
+            for (size_t s = 0; s < count; ++s)
+            {
+                if (s > 0)
+                    out += ' ';
+                writeSentence(out);
+            }
+        }
+
+        void writePlain(string& out)
+        {
+            writeSentences(out, 3 + random.below(5));
+            out += "\n\n";
+        }
+
+        void writeHtml(string& out, size_t paragraph)
+        {
+            if (paragraph % 12 == 0)
+            {
+                out += "<h2>";
+                writeSentences(out, 1);
+                out += "</h2>\n";
+            }
+            if (paragraph % 25 == 7)
+                out += "<!-- Kommentar mit <b>Tags</b> die nicht gez\xC3\xA4hlt werden -->\n";
+            if (paragraph % 40 == 19)
+                out += "<script>var x = 1 < 2 && \"</p>\";</script>\n";
+
+            out += "<p>";
+            writeSentences(out, 3 + random.below(5));
+            out += "</p>\n";
+        }
+
+        void writeMarkdown(string& out, size_t paragraph)
+        {
+            if (paragraph % 10 == 0)
+            {
+                out += "## ";
+                writeSentences(out, 1);
+                out += "\n\n";
+            }
+            if (paragraph % 8 == 3)
+            {
+                for (int item = 0; item < 3; ++item)
+                {
+                    out += "- ";
+                    writeSentences(out, 1);
+                    out += '\n';
+                }
+                out += '\n';
+            }
+            if (paragraph % 30 == 11)
+                out += "```\nint x = 1; // kein Text\n```\n\n";
+            if (paragraph % 15 == 5)
+                out += "> ";
+
+            writeSentences(out, 3 + random.below(5));
+            out += "\n\n";
+        }
+
+        const CorpusSpec& spec;
+        CorpusRandom random;
+        ZipfVocabulary vocabulary;
+    };
+
+    // Siehe Header
+    std::string generateCorpus(const CorpusSpec& spec)
+    {
+        const LanguageParts& parts = (spec.language == corpusLanguage::german) ? germanParts() : englishParts();
+        return CorpusWriter(spec, parts).write();
+    }
+
+    // Siehe Header
+    std::string corpusName(const CorpusSpec& spec)
+    {
+        string name = (spec.language == corpusLanguage::german) ? "german" : "english";
+        switch (spec.format)
+        {
+        case corpusFormat::plain: name += "-plain"; break;
+        case corpusFormat::html: name += "-html"; break;
+        case corpusFormat::markdown: name += "-markdown"; break;
+        }
+        return name + "-" + formatSize(spec.size);
+    }
+
+    // Siehe Header
+    std::uint64_t parseSize(const std::string& text)
+    {
+        size_t digits = 0;
+        uint64_t value = 0;
+        while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9')
+            value = value * 10 + static_cast<uint64_t>(text[digits++] - '0');
+        if (digits == 0)
+            return 0;
+
+        string unit = text.substr(digits);
+        if (unit.empty())
+            return value;
+        if (unit == "K" || unit == "k")
+            return value << 10;
+        if (unit == "M" || unit == "m")
+            return value << 20;
+        if (unit == "G" || unit == "g")
+            return value << 30;
+        return 0;
+    }
+
+    // Siehe Header
+    std::string formatSize(std::uint64_t size)
+    {
+        if (size >= (1ULL << 30) && size % (1ULL << 30) == 0)
+            return to_string(size >> 30) + "G";
+        if (size >= (1ULL << 20) && size % (1ULL << 20) == 0)
+            return to_string(size >> 20) + "M";
+        if (size >= (1ULL << 10) && size % (1ULL << 10) == 0)
+            return to_string(size >> 10) + "K";
+        return to_string(size);
+    }
+}
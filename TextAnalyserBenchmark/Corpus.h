@@ -0,0 +1,67 @@
+/**
+* Corpus.h
+*
+* Erzeugt synthetische Texte für den Benchmark. Die Worte kommen aus einem künstlichen deutschen oder englischen
+* Wortschatz und werden nach einer Zipf Verteilung gezogen, wie bei echten Texten. Mit dem gleichen seed entsteht
+* auf jeder Plattform genau der gleiche Text, die Ergebnisse verschiedener Läufe sind also vergleichbar.
+*/
+#pragma once
+#ifndef TEXTANALYSER_BENCHMARK_CORPUS
+#define TEXTANALYSER_BENCHMARK_CORPUS
+
+#include <cstdint>
+#include <string>
+
+namespace AnalyserBenchmark
+{
+	enum class corpusLanguage
+	{
+		german,
+		english
+	};
+
+	enum class corpusFormat
+	{
+		/// Absätze mit Sätzen, getrennt durch Leerzeilen
+		plain,
+		/// Absätze in <p>, dazu Tags, Links, Entities, Kommentare und <script> Blöcke
+		html,
+		/// Überschriften, Listen, Hervorhebungen, Links, Code und Codeblöcke
+		markdown
+	};
+
+	/**
+	* Beschreibt einen Korpus. Der erzeugte Text endet nach dem Absatz der size erreicht, ist also etwas größer.
+	*/
+	struct CorpusSpec
+	{
+		corpusLanguage language = corpusLanguage::german;
+		corpusFormat format = corpusFormat::plain;
+		std::uint64_t size = 1 << 20;
+		std::uint64_t seed = 1;
+	};
+
+	/**
+	* Erzeugt den Text zu spec. Deutsche Texte sind UTF-8 kodiert und enthalten Umlaute und ß.
+	*/
+	std::string generateCorpus(const CorpusSpec& spec);
+
+	/**
+	* @return	Gibt einen Namen wie "german-plain-1M" zurück
+	*/
+	std::string corpusName(const CorpusSpec& spec);
+
+	/**
+	* Liest eine Größe wie "64K", "16M" oder "1G" (Faktor 1024), ohne Einheit in Byte
+	*
+	* @return	Gibt 0 zurück wenn der Text keine gültige Größe ist
+	*/
+	std::uint64_t parseSize(const std::string& text);
+
+	/**
+	* @return	Gibt die Größe als kurzen Text zurück, z.B. "64K"
+	*/
+	std::string formatSize(std::uint64_t size);
+}
+
+#endif // !TEXTANALYSER_BENCHMARK_CORPUS
@@ -1,6 +1,25 @@
 #include "pch.h"
 #include <string>
 #include "../TextParser/TextAnalyser.h"
+#include "../TextParser/SimdKernels.h"
+#include "../TextParser/MappedFile.h"
+#include "../TextParser/PatternMatcher.h"
+#include "../TextParser/StatsCache.h"
+#include "../TextParser/AnalyzedDocument.h"
+#include "../TextParser/CorpusAnalyser.h"
+#include "../TextParser/CleanupFilters.h"
+#include "../TextParser/InvertedIndex.h"
+#include "../TextParser/KeywordSearch.h"
+#include "../TextParser/Metrics.h"
+#include "../TextParser/ResultFile.h"
+#include "../TextParser/TokenTable.h"
+#include "../TextParser/Utf8.h"
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 #include <vector>
 #include <unordered_map>
@@ -41,12 +60,67 @@ namespace TextAnalyserTest
 		EXPECT_EQ(list.size(), 3);
 	}
 
+	TEST(SplitText, TokenizeWithoutCopy)
+	{
+		string testText = "Das... ist ein    !Kleiner! Text.\nNicht-Ganz soo00        normal?";
+		stringList list = splitTextIntoStringList(testText);
+
+		size_t count = 0;
+		for (const Token& t : tokenize(testText))
+		{
+			EXPECT_EQ(t.value, list[count]);
+			EXPECT_EQ(t.value.data(), testText.data() + t.position);
+			count++;
+		}
+		EXPECT_EQ(count, list.size());
+	}
+
+	// ---------------------------------------------------
+	TEST(CharClass, DefaultTable)
+	{
+		static_assert(defaultCharTable['a'] & charVowel, "die Standardtabelle wird zur Compilezeit erstellt");
+		EXPECT_EQ(defaultCharTable['Z'], charLetter);
+		EXPECT_EQ(defaultCharTable['\xFC'], charLetter);
+		EXPECT_EQ(defaultCharTable['.'], charWordEnd | charSentenceEnd);
+		EXPECT_EQ(defaultCharTable[','], charWordEnd);
+		EXPECT_EQ(defaultCharTable['0'], 0);
+	}
+
+	TEST(CharClass, CustomTable)
+	{
+		CharTable table = makeCharTable(" ");
+		EXPECT_EQ(table['.'], charSentenceEnd);
+		EXPECT_EQ(table[' '], charWordEnd);
+		EXPECT_EQ(splitTextIntoStringList("Das.ist ein", false, " ").size(), 2);
+	}
+
+	// ---------------------------------------------------
+	TEST(Simd, SameStatsOnAllLevels)
+	{
+		string testText;
+		for (int i = 0; i < 40; ++i)
+			testText += "Das ist ein Test, weil noch einer n\xF6tig ist! Ein   letzter Satz... und 00 ohne Ende";
+
+		AnalysisResult expected = analyseText(testText, metricStats | metricWordLength);
+		for (simdLevel level : { simdNone, simdSSE2, simdAVX2 })
+		{
+			setSimdLevel(level);
+			Stats stat = analyseText(testText, metricStats).stats;
+			EXPECT_EQ(stat.letters, expected.stats.letters);
+			EXPECT_EQ(stat.words, expected.stats.words);
+			EXPECT_EQ(stat.sentense, expected.stats.sentense);
+			EXPECT_EQ(stat.syllable, expected.stats.syllable);
+			EXPECT_EQ(splitTextIntoStringList(testText), splitTextIntoStringList(testText, false, defaultWordEnd "\t"));
+		}
+		setSimdLevel(detectSimdLevel());
+	}
+
 	// ---------------------------------------------------
 	TEST(CountWords, CountVsSplitFunction)
 	{
 		string testText = "Das ist ein Kleiner Text. Ganz normal ohne Zeug!";
 		stringList list = splitTextIntoStringList(testText);
-		int count = countTotalWords(testText);
+		std::int64_t count = countTotalWords(testText);
 		EXPECT_EQ(list.size(), count);
 	}
 
@@ -146,7 +220,7 @@ namespace TextAnalyserTest
 
 	TEST(CleanUp, CleanAllSigns)
 	{
-		string testText = u8"Hallo, welt.Dies\nist\nein, robuster.Test.\n\nWrter, ohne Leerzeichen\nwerden.richtig, getrennt\nauch\nbei\nZeilenumbrchen. ist Ist ist";
+		string testText = u8"Hallo, welt.Dies\nist\nein, robuster.Test.\n\nWörter, ohne Leerzeichen\nwerden.richtig, getrennt\nauch\nbei\nZeilenumbrüchen. ist Ist ist";
 		cleanUpText(testText);
 		size_t originSize = testText.size();
 		cleanUpText(testText, cleanupType::removeAllSigns);
@@ -176,6 +250,42 @@ namespace TextAnalyserTest
 		EXPECT_EQ(res[0].value, "Test");
 		EXPECT_EQ(res[0].position, 12);
 	}
+	TEST(FindPattern, MatcherSameAsRegex)
+	{
+		string testText = "Das ist ein Test um worte mit vier Buchstaben zu finden. Preis: 1234,50 Euro, Nr. 42_a; snake_case!";
+		for (const char* pattern : { R"(\b\w{6}\b)", R"(\d+)", R"(Test)", R"([A-Z][a-z]+)", R"(\w+_\w+)",
+			R"(\b[^\s,.]{2,4}\b)", R"(\d{1,3}[,.]?\d*)", R"(^Das)", R"(case!$)", R"(e.{0,2}n)" })
+		{
+			PatternMatcher matcher(pattern);
+			EXPECT_TRUE(matcher.isCompiled()) << pattern;
+
+			searchList expected = findPatterns(testText, regex(pattern));
+			searchList found = findPatterns(testText, pattern);
+			ASSERT_EQ(found.size(), expected.size()) << pattern;
+			for (size_t i = 0; i < found.size(); ++i)
+			{
+				EXPECT_EQ(found[i].value, expected[i].value) << pattern;
+				EXPECT_EQ(found[i].position, expected[i].position) << pattern;
+			}
+		}
+	}
+	TEST(FindPattern, FallbackAndCallback)
+	{
+		string testText = "Test1 test2 TEST3";
+		// Gruppen und Alternativen werden weiter mit std::regex gesucht
+		PatternMatcher fallback(R"((T|t)est\d)");
+		EXPECT_FALSE(fallback.isCompiled());
+		EXPECT_EQ(fallback.count(testText), 2);
+		EXPECT_FALSE(PatternMatcher(R"(\w*)").isCompiled());
+		EXPECT_THROW(PatternMatcher("(offen"), std::regex_error);
+
+		PatternMatcher matcher(R"(\b\w{5}\b)");
+		vector<PatternMatch> matches;
+		matcher.forEachMatch(testText, [&matches](const PatternMatch& m) { matches.push_back(m); });
+		ASSERT_EQ(matches.size(), 3);
+		EXPECT_EQ(matches[1].position, 6);
+		EXPECT_EQ(matches[1].length, 5);
+	}
 	
 	// ---------------------------------------------------
 	TEST(CalculateWord, CountWordLength)
@@ -201,7 +311,7 @@ namespace TextAnalyserTest
 
 	TEST(CalculateWord, CountWordAmount)
 	{
-		string testText = "Das ist ein Test weil noch einer ntig ist.";
+		string testText = "Das ist ein Test weil noch einer nötig ist.";
 		auto result = calculateWordLengthDistibution(testText);
 		EXPECT_EQ(result[2], 0);
 		EXPECT_EQ(result[3], 4);
@@ -212,7 +322,7 @@ namespace TextAnalyserTest
 	// ---------------------------------------------------
 	TEST(ConectedWords, SimpleFind)
 	{
-		string testText = "Das ist ein Test weil noch einer ntig ist, ein letzter.";
+		string testText = "Das ist ein Test weil noch einer nötig ist, ein letzter.";
 		auto result = findConnectedWords(testText,2);
 		EXPECT_EQ(result.size(), 1);
 		auto pair = result.begin();
@@ -225,8 +335,1125 @@ namespace TextAnalyserTest
 	// ---------------------------------------------------
 	TEST(ScoreText, SimpleScore)
 	{
-		string testText = "Das. ist. ein. Test. weil. noch. einer. ntig. ist.";
+		string testText = "Das. ist. ein. Test. weil. noch. einer. nötig. ist.";
 		ReadabilityScore score = calculateGermanScore(testText);
 		EXPECT_EQ(score, ReadabilityScore::VeryEasy);
 	}
+
+	// ---------------------------------------------------
+	TEST(AnalyseText, SameResultAsSingleFunctions)
+	{
+		string testText = "Das ist ein Test weil noch einer nötig ist, ein letzter. Ein Text ohne Zeug!";
+		AnalysisOptions options;
+		options.useLowerCase = true;
+		AnalysisResult result = analyseText(testText, metricAll, options);
+
+		EXPECT_EQ(result.stats.words, countTotalWords(testText));
+		EXPECT_EQ(result.wordLengths, calculateWordLengthDistibution(testText));
+		EXPECT_EQ(result.words, createWordDistribution(testText, true));
+		EXPECT_EQ(result.pairs, findConnectedWords(testText));
+		EXPECT_EQ(result.pairs[strPair("ist", "ein")], 2);
+	}
+
+	TEST(AnalyseText, OnlyRequestedMetrics)
+	{
+		string testText = "Das ist. ein mit. dir gut.";
+		AnalysisResult result = analyseText(testText, metricStats | metricWordLength);
+
+		EXPECT_EQ(result.stats.letters, 18);
+		EXPECT_EQ(result.stats.words, 6);
+		EXPECT_EQ(result.stats.sentense, 3);
+		EXPECT_EQ(result.wordLengths[3], 6);
+		EXPECT_TRUE(result.words.empty());
+		EXPECT_TRUE(result.pairs.empty());
+	}
+	TEST(AnalyseText, SentenceEndInsideWord)
+	{
+		// ';' beendet einen Satz aber kein Wort, "x;y" ist deshalb ein Wort und trennt keine Paare
+		string testText = "ab x;y cd";
+		AnalysisOptions options;
+		options.sentenceEnd = ".;";
+		options.minOccurrences = 1;
+
+		wordPairs expected = { { { "ab", "x;y" }, 1 }, { { "x;y", "cd" }, 1 } };
+		for (int metrics : { int(metricWordPairs), int(metricAll) })
+		{
+			EXPECT_EQ(analyseText(testText, metrics, options).pairs, expected) << metrics;
+			EXPECT_EQ(analyseTextAsync(testText, metrics, options).pairs, expected) << metrics;
+
+			StreamAnalyser analyser(metrics, options);
+			analyser.feed(testText);
+			EXPECT_EQ(analyser.finish().pairs, expected) << metrics;
+		}
+	}
+
+	// ---------------------------------------------------
+	TEST(Async, SameResultAsSync)
+	{
+		string testText;
+		for (int i = 0; i < 3000; ++i)
+			testText += "Das ist ein Test weil noch einer n\xF6tig ist, ein letzter. Aua! Ein Text" + to_string(i % 7) + " ohne Zeug? ";
+
+		setThreadCount(4);
+		EXPECT_EQ(countTotalWordsAsync(testText), countTotalWords(testText));
+		EXPECT_EQ(splitTextIntoStringListAsync(testText, true), splitTextIntoStringList(testText, true));
+		EXPECT_EQ(calculateWordLengthDistibutionAsync(testText), calculateWordLengthDistibution(testText));
+		EXPECT_EQ(findConnectedWordsAsync(testText, 2, 4), findConnectedWords(testText, 2, 4));
+
+		stringList list = splitTextIntoStringList(testText, true);
+		EXPECT_EQ(createWordDistributionAsync(list, { "ein" }), createWordDistribution(list, { "ein" }));
+
+		AnalysisResult expected = analyseText(testText);
+		AnalysisResult result = analyseTextAsync(testText);
+		EXPECT_EQ(result.stats.syllable, expected.stats.syllable);
+		EXPECT_EQ(result.stats.sentense, expected.stats.sentense);
+		EXPECT_EQ(result.words, expected.words);
+		setThreadCount(0);
+	}
+
+	// ---------------------------------------------------
+	TEST(ReadFile, KeepsNewlines)
+	{
+		const string path = "readfile_test.txt";
+		{
+			ofstream file(path, ios::binary);
+			file << "Erste Zeile\r\nzweite Zeile\nEnde";
+		}
+		EXPECT_EQ(readFile(path, cleanupType::None), "Erste Zeile\nzweite Zeile\nEnde");
+		EXPECT_EQ(readFile(path), "Erste Zeile zweite Zeile Ende");
+		EXPECT_EQ(countTotalWords(readFile(path, cleanupType::None)), 5);
+		EXPECT_EQ(readFile("gibt_es_nicht.txt"), "");
+		remove(path.c_str());
+	}
+	TEST(ReadFile, MappedFileWithoutCopy)
+	{
+		const string path = "mappedfile_test.txt";
+		string testText = "Das ist ein Test. Noch ein Test!\nDas ist ein Text ohne Ende";
+		{
+			ofstream file(path, ios::binary);
+			file << testText;
+		}
+		MappedFile file(path);
+		ASSERT_TRUE(file.isOpen());
+		EXPECT_EQ(file.size(), testText.size());
+		EXPECT_EQ(file.view(), testText);
+
+		AnalysisResult expected = analyseText(testText);
+		AnalysisResult result = analyseText(file.view());
+		EXPECT_EQ(result.stats.words, expected.stats.words);
+		EXPECT_EQ(result.words, expected.words);
+		EXPECT_EQ(result.pairs, expected.pairs);
+
+		MappedFile moved = move(file);
+		EXPECT_FALSE(file.isOpen());
+		EXPECT_EQ(moved.view(), testText);
+		moved.close();
+		remove(path.c_str());
+	}
+
+	// ---------------------------------------------------
+	TEST(Stream, SameResultAsAnalyseText)
+	{
+		string testText;
+		for (int i = 0; i < 200; ++i)
+			testText += "Das ist ein Test weil noch einer n\xF6tig ist, ein letzter. Aua! Ein Text" + to_string(i % 7) + " ohne Zeug? ";
+		testText += "Offenes Ende";
+
+		AnalysisOptions custom;
+		custom.wordEnd = " ;\n";
+		custom.sentenceEnd = ";";
+		custom.range = 4;
+
+		for (const AnalysisOptions& options : { AnalysisOptions(), custom })
+		{
+			for (int metrics : { int(metricAll), int(metricStats), int(metricWordPairs), metricWordLength | metricWordDistribution })
+			{
+				AnalysisResult expected = analyseText(testText, metrics, options);
+				for (size_t chunkSize : { 1, 3, 7, 64, 1000 })
+				{
+					StreamAnalyser analyser(metrics, options);
+					for (size_t pos = 0; pos < testText.size(); pos += chunkSize)
+						analyser.feed(string_view(testText).substr(pos, chunkSize));
+					EXPECT_EQ(analyser.size(), testText.size());
+
+					AnalysisResult result = analyser.finish();
+					EXPECT_EQ(result.stats.letters, expected.stats.letters);
+					EXPECT_EQ(result.stats.words, expected.stats.words);
+					EXPECT_EQ(result.stats.sentense, expected.stats.sentense);
+					EXPECT_EQ(result.stats.syllable, expected.stats.syllable);
+					EXPECT_EQ(result.wordLengths, expected.wordLengths);
+					EXPECT_EQ(result.words, expected.words);
+					EXPECT_EQ(result.pairs, expected.pairs);
+				}
+			}
+		}
+	}
+	TEST(Stream, ReadFromStream)
+	{
+		string testText = "Das ist ein Test. Noch ein Test!\nDas ist ein Text ohne Ende";
+		istringstream input(testText);
+		AnalysisResult result = analyseStream(input);
+		AnalysisResult expected = analyseText(testText);
+		EXPECT_EQ(result.stats.words, expected.stats.words);
+		EXPECT_EQ(result.words, expected.words);
+		EXPECT_EQ(result.pairs, expected.pairs);
+
+		StreamAnalyser analyser(metricStats);
+		analyser.feed("Ein Te");
+		analyser.feed("xt");
+		EXPECT_EQ(analyser.finish().stats.words, 2);
+		analyser.feed("Noch einer.");
+		EXPECT_EQ(analyser.finish().stats.sentense, 1);
+	}
+
+	// ---------------------------------------------------
+	TEST(Vocabulary, InternAndLookup)
+	{
+		Vocabulary vocabulary;
+		EXPECT_EQ(vocabulary.intern("Haus"), 0u);
+		EXPECT_EQ(vocabulary.intern("Baum"), 1u);
+		EXPECT_EQ(vocabulary.intern("Haus"), 0u);
+		EXPECT_EQ(vocabulary.find("Baum"), 1u);
+		EXPECT_EQ(vocabulary.find("Maus"), invalidWordId);
+		EXPECT_EQ(vocabulary.size(), 2);
+
+		string longWord(100000, 'a');
+		wordId id = vocabulary.intern(longWord);
+		EXPECT_EQ(vocabulary.word(id), longWord);
+		EXPECT_EQ(vocabulary.word(0), "Haus");
+
+		vocabulary.clear();
+		EXPECT_EQ(vocabulary.size(), 0);
+		EXPECT_EQ(vocabulary.find("Haus"), invalidWordId);
+	}
+	TEST(Vocabulary, SameResultAsStringKeys)
+	{
+		string testText = "Das ist ein Test weil noch einer n\xF6tig ist, ein letzter Test. Aua! Das ist ein Text ohne Zeug und ein Test";
+		Vocabulary vocabulary;
+		wordIdDistribution words = createWordIdDistribution(testText, vocabulary);
+		EXPECT_EQ(words.size(), vocabulary.size());
+		EXPECT_EQ(toWordDistribution(words, vocabulary), createWordDistribution(testText));
+		EXPECT_EQ(toWordDistribution(createWordIdDistribution(testText, vocabulary, true), vocabulary), createWordDistribution(testText, true));
+
+		for (int range : { 2, 3, 6 })
+		{
+			wordIdPairs pairs = findConnectedWordIds(testText, vocabulary, 1, range);
+			EXPECT_EQ(toWordPairs(pairs, vocabulary), findConnectedWords(testText, 1, range));
+		}
+		EXPECT_EQ(toWordPairs(findConnectedWordIds(testText, vocabulary, 2, 3), vocabulary), findConnectedWords(testText, 2, 3));
+		EXPECT_TRUE(findConnectedWordIds(testText, vocabulary, 2, 1).empty());
+	}
+
+	// ---------------------------------------------------
+	TEST(PairCounter, CountPruneMerge)
+	{
+		PairCounter counter;
+		for (wordId i = 0; i < 1000; ++i)
+			counter.add(i % 10, i % 7);
+		counter.add(3, 4, 5);
+		EXPECT_EQ(counter.size(), 70);
+		EXPECT_EQ(counter.count(3, 4), 19);
+		EXPECT_EQ(counter.count(4, 3), 14);
+		EXPECT_EQ(counter.count(11, 0), 0);
+
+		PairCounter other;
+		other.add(3, 4);
+		other.add(100, 200);
+		counter.merge(other);
+		EXPECT_EQ(counter.count(3, 4), 20);
+		EXPECT_EQ(counter.count(100, 200), 1);
+
+		// 1000 = 14 * 70 + 20, nur 20 Paare kommen 15 mal vor, dazu (3, 4)
+		counter.prune(15);
+		EXPECT_EQ(counter.size(), 21);
+		EXPECT_EQ(counter.count(100, 200), 0);
+
+		int total = 0;
+		counter.forEach([&](wordIdPair, int count) { total += count; });
+		EXPECT_EQ(total, 20 * 15 + 20);
+	}
+	TEST(PairCounter, MaxEntriesKeepsFrequentPairs)
+	{
+		PairCounter counter;
+		counter.setMaxEntries(100);
+		for (wordId i = 2; i < 10002; ++i)
+		{
+			counter.add(1, 2);
+			counter.add(i, i + 1);
+		}
+		EXPECT_LE(counter.size(), 100);
+		EXPECT_EQ(counter.count(1, 2), 10000);
+
+		// alle Paare sehr häufig: die Grenze wird in einem Schritt gefunden, die häufigsten bleiben
+		PairCounter frequent;
+		for (wordId i = 0; i < 200; ++i)
+			frequent.add(i, i + 1, 100000 + static_cast<int>(i));
+		frequent.setMaxEntries(100);
+		EXPECT_EQ(frequent.size(), 50);
+		EXPECT_EQ(frequent.count(199, 200), 100199);
+		EXPECT_EQ(frequent.count(150, 151), 100150);
+		EXPECT_EQ(frequent.count(149, 150), 0);
+
+		string testText;
+		for (int i = 0; i < 300; ++i)
+			testText += "Das ist ein Test mit dem Wort" + to_string(i) + ". ";
+		AnalysisOptions options;
+		options.range = 4;
+		options.maxPairEntries = 50;
+		wordPairs pairs = analyseText(testText, metricWordPairs, options).pairs;
+		EXPECT_EQ(pairs[strPair("das", "ist")], 300);
+		EXPECT_EQ(pairs[strPair("ein", "mit")], 300);
+	}
+
+	// ---------------------------------------------------
+	TEST(Approximate, TopWordsWithinErrorBound)
+	{
+		string testText;
+		for (int i = 0; i < 2000; ++i)
+			testText += "der Text ist " + string(i % 3 == 0 ? "sehr " : "") + "lang und wort" + to_string(i % 500) + " ist selten. ";
+
+		ApproximateOptions options;
+		options.width = 256;
+		options.topK = 20;
+		ApproximateCounter counter = createApproximateWordDistribution(testText, options);
+		wordDistribution exact = createWordDistribution(testText);
+
+		vector<HeavyHitter> top = counter.top();
+		ASSERT_EQ(top.size(), 20);
+		EXPECT_EQ(top[0].value, "ist");
+		EXPECT_LE(counter.topErrorBound(), counter.total() / 20);
+		for (const HeavyHitter& h : top)
+		{
+			EXPECT_LE(h.count - h.error, exact[h.value]);
+			EXPECT_GE(h.count, exact[h.value]);
+		}
+		for (const auto& [word, count] : exact)
+		{
+			EXPECT_GE(counter.estimate(word), count);
+			EXPECT_LE(counter.estimate(word), count + counter.errorBound());
+		}
+		EXPECT_EQ(counter.total(), countTotalWords(testText));
+	}
+	TEST(Approximate, MergeAndPairs)
+	{
+		string first = "Der Mann geht nach Hause. Der Mann bleibt. Die Frau geht nach Hause.";
+		string second = "Der Mann geht. Die Frau geht nach Hause!";
+		ApproximateCounter counter = findConnectedWordsApproximate(first, ApproximateOptions(), 3);
+		EXPECT_TRUE(counter.merge(findConnectedWordsApproximate(second, ApproximateOptions(), 3)));
+
+		wordPairs exact = findConnectedWords(first + " " + second, 1, 3);
+		for (const HeavyHitter& h : counter.top())
+			EXPECT_EQ(static_cast<int>(h.count), exact[splitPairKey(h.value)]);
+		EXPECT_EQ(counter.estimate("der mann"), 3);
+		EXPECT_EQ(counter.estimate("nach hause"), 3);
+
+		ApproximateOptions other;
+		other.width = 1024;
+		EXPECT_FALSE(counter.merge(ApproximateCounter(other)));
+		EXPECT_EQ(splitPairKey("der mann"), strPair("der", "mann"));
+	}
+
+	// ---------------------------------------------------
+	TEST(StopWords, FilterIgnoresCase)
+	{
+		const StopWordFilter& german = StopWordFilter::german();
+		EXPECT_TRUE(german.contains("und"));
+		EXPECT_TRUE(german.contains("Und"));
+		EXPECT_TRUE(german.contains("\xDC" "ber"));
+		EXPECT_TRUE(german.contains("f\xFCr"));
+		EXPECT_FALSE(german.contains("Haus"));
+		EXPECT_FALSE(german.contains(""));
+		EXPECT_TRUE(StopWordFilter::english().contains("The"));
+
+		StopWordFilter exact({ "Das", "ist" }, false);
+		EXPECT_TRUE(exact.contains("Das"));
+		EXPECT_FALSE(exact.contains("das"));
+		EXPECT_EQ(exact.size(), 2);
+
+		StopWordFilter many;
+		for (int i = 0; i < 1000; ++i)
+			many.add("wort" + to_string(i));
+		EXPECT_EQ(many.size(), 1000);
+		EXPECT_TRUE(many.contains("WORT999"));
+		EXPECT_FALSE(many.contains("wort1000"));
+	}
+	TEST(StopWords, Utf8AndLatin1)
+	{
+		const StopWordFilter& german = StopWordFilter::german();
+		EXPECT_TRUE(german.contains("f\xC3\xBCr"));
+		EXPECT_TRUE(german.contains("F\xC3\x9CR"));
+		EXPECT_TRUE(german.contains("\xC3\x9C" "ber"));
+		EXPECT_TRUE(german.contains("da\xC3\x9F"));
+		EXPECT_TRUE(german.contains("f\xFCr"));
+		EXPECT_FALSE(german.contains("f\xC3\xBC"));
+
+		string testText = "F\xC3\xBCr den Hund und \xC3\xBC" "ber die Katze. \xC3\x9C" "ber dem Haus!";
+		wordDistribution words = createWordDistribution(testText, german, true);
+		wordDistribution expected = { { "hund", 1 }, { "katze", 1 }, { "haus", 1 } };
+		EXPECT_EQ(words, expected);
+	}
+	TEST(StopWords, DistributionAndPairs)
+	{
+		string testText = "Das ist ein Test und das ist ein Haus. Und der Test ist gut!";
+		wordDistribution words = createWordDistribution(testText, StopWordFilter::german(), true);
+		wordDistribution expected = { { "test", 2 }, { "haus", 1 }, { "gut", 1 } };
+		EXPECT_EQ(words, expected);
+
+		stringList list = splitTextIntoStringList(testText);
+		EXPECT_EQ(createWordDistribution(list, StopWordFilter({ "ist", "ein" }, false)), createWordDistribution(list, { "ist", "ein" }));
+		EXPECT_EQ(createWordDistributionAsync(list, StopWordFilter::german()), createWordDistribution(list, StopWordFilter::german()));
+
+		wordPairs pairs = findConnectedWords(testText, StopWordFilter::german(), 1, 2);
+		wordPairs expectedPairs = { { strPair("test", "haus"), 1 }, { strPair("test", "gut"), 1 } };
+		EXPECT_EQ(pairs, expectedPairs);
+	}
+
+	// ---------------------------------------------------
+	TEST(Cache, LruAndCounters)
+	{
+		StatsCache cache(4, 1);
+		Stats stat = { 1, 2, 3, 4 };
+		for (int i = 0; i < 6; ++i)
+			cache.insert(StatsCache::makeKey("Text " + to_string(i), defaultWordEnd, defaultSentenceEnd), stat);
+
+		Stats found;
+		EXPECT_FALSE(cache.find(StatsCache::makeKey("Text 0", defaultWordEnd, defaultSentenceEnd), found));
+		EXPECT_TRUE(cache.find(StatsCache::makeKey("Text 2", defaultWordEnd, defaultSentenceEnd), found));
+		EXPECT_EQ(found.sentense, 3);
+		// gleicher Text mit anderen Trennzeichen ist ein anderer Eintrag
+		EXPECT_FALSE(cache.find(StatsCache::makeKey("Text 2", " ", defaultSentenceEnd), found));
+
+		cache.insert(StatsCache::makeKey(7, defaultWordEnd, defaultSentenceEnd), stat);
+		EXPECT_TRUE(cache.find(StatsCache::makeKey("Text 2", defaultWordEnd, defaultSentenceEnd), found));
+		EXPECT_FALSE(cache.find(StatsCache::makeKey("Text 3", defaultWordEnd, defaultSentenceEnd), found));
+
+		CacheCounters counters = cache.counters();
+		EXPECT_EQ(counters.hits, 2);
+		EXPECT_EQ(counters.misses, 3);
+		EXPECT_EQ(counters.evictions, 3);
+		EXPECT_EQ(counters.size, 4);
+
+		cache.setCapacity(1);
+		EXPECT_EQ(cache.counters().size, 1);
+		EXPECT_TRUE(cache.find(StatsCache::makeKey("Text 2", defaultWordEnd, defaultSentenceEnd), found));
+	}
+	TEST(Cache, CapacityBelowShardCount)
+	{
+		StatsCache cache(64, 16);
+		Stats stat = { 1, 2, 3, 4 };
+		cache.setCapacity(3);
+		for (int i = 0; i < 100; ++i)
+			cache.insert(StatsCache::makeKey("Text " + to_string(i), defaultWordEnd, defaultSentenceEnd), stat);
+		EXPECT_LE(cache.counters().size, 3);
+		EXPECT_GT(cache.counters().size, 0);
+
+		// 0 schaltet den Cache ab
+		cache.setCapacity(0);
+		EXPECT_EQ(cache.counters().size, 0);
+		cache.insert(StatsCache::makeKey("Text 0", defaultWordEnd, defaultSentenceEnd), stat);
+		Stats found;
+		EXPECT_FALSE(cache.find(StatsCache::makeKey("Text 0", defaultWordEnd, defaultSentenceEnd), found));
+		EXPECT_EQ(cache.counters().size, 0);
+
+		StatsCache single(1, 16);
+		for (int i = 0; i < 10; ++i)
+			single.insert(StatsCache::makeKey(i, defaultWordEnd, defaultSentenceEnd), stat);
+		EXPECT_EQ(single.counters().size, 1);
+	}
+	TEST(Cache, DocumentIdAndThreads)
+	{
+		clearCache();
+		string testText = "Das ist ein Test. Noch ein Test!";
+		Stats stat = getDocumentStats(42, testText);
+		EXPECT_EQ(stat.words, 7);
+		// bei einem Treffer wird der Text nicht gelesen
+		EXPECT_EQ(getDocumentStats(42, "").words, 7);
+		forgetDocument(42);
+		EXPECT_EQ(getDocumentStats(42, "").words, 0);
+
+		vector<string> texts;
+		for (int i = 0; i < 20; ++i)
+			texts.push_back(testText + string(i, 'a'));
+		vector<thread> threads;
+		for (int t = 0; t < 8; ++t)
+			threads.emplace_back([&] {
+				for (int n = 0; n < 200; ++n)
+					EXPECT_EQ(countTotalWords(texts[n % texts.size()]), (n % texts.size()) ? 8 : 7);
+			});
+		for (thread& t : threads)
+			t.join();
+		EXPECT_GE(getCacheCounters().hits, 8 * 200 - 8 * 20);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+	TEST(AnalyzedDocument, SameResultAsFreeFunctions)
+	{
+		string testText = "Das ist ein Test. Der Test ist gut! Noch ein Test ohne Ende";
+		AnalyzedDocument doc(testText);
+
+		EXPECT_EQ(doc.stats().words, countTotalWords(testText));
+		EXPECT_EQ(doc.stats().sentense, 3);
+		EXPECT_EQ(doc.wordLengths(), calculateWordLengthDistibution(testText));
+		EXPECT_EQ(doc.words(), createWordDistribution(testText));
+		EXPECT_EQ(doc.pairs(), findConnectedWords(testText));
+		EXPECT_DOUBLE_EQ(doc.wordLength(), calculateWordLength(testText));
+		EXPECT_DOUBLE_EQ(doc.sentenceLengthByWords(), calculateSentenceLengthByWords(testText));
+		EXPECT_EQ(doc.germanScore(), calculateGermanScore(testText));
+
+		ASSERT_EQ(doc.tokens().size(), 13u);
+		EXPECT_EQ(doc.tokens()[3].value, "Test");
+		ASSERT_EQ(doc.sentences().size(), 3u);
+		EXPECT_EQ(testText.substr(doc.sentences()[0].begin, doc.sentences()[0].end - doc.sentences()[0].begin), "Das ist ein Test.");
+		EXPECT_EQ(testText.substr(doc.sentences()[1].begin, doc.sentences()[1].end - doc.sentences()[1].begin), "Der Test ist gut!");
+		EXPECT_EQ(doc.sentences()[2].end, testText.size());
+
+		// die Sätze passen immer zu stats().sentense, auch bei einem Komma am Ende oder einem freistehenden Punkt
+		AnalyzedDocument comma(string("Hallo. Welt,"));
+		EXPECT_EQ(comma.stats().sentense, 1);
+		EXPECT_EQ(comma.sentences().size(), 1u);
+		AnalyzedDocument looseDot(string("Hallo ."));
+		EXPECT_EQ(looseDot.stats().sentense, 0);
+		EXPECT_EQ(looseDot.sentences().size(), 0u);
+	}
+	TEST(AnalyzedDocument, MemoisesAndMoves)
+	{
+		AnalyzedDocument doc(string("Eins zwei drei. Vier."));
+		const Stats* first = &doc.stats();
+		EXPECT_EQ(first, &doc.stats());
+		string_view before = doc.tokens()[0].value;
+
+		// nach einem move zeigen die Tokens weiter in den Text des Dokuments
+		AnalyzedDocument moved = move(doc);
+		EXPECT_EQ(moved.tokens()[0].value.data(), before.data());
+		EXPECT_EQ(moved.text().data(), before.data());
+		EXPECT_EQ(moved.stats().words, 4);
+
+		string other = "Ein Text; ohne Satzende";
+		AnalysisOptions options;
+		options.wordEnd += ";";
+		AnalyzedDocument view = AnalyzedDocument::fromView(other, options);
+		EXPECT_EQ(view.text().data(), other.data());
+		EXPECT_EQ(view.stats().words, 4);
+		EXPECT_EQ(view.sentences().size(), 1u);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+	TEST(CleanUp, HtmlScriptsCommentsAndEntities)
+	{
+		string html = "<html><head><title>Titel</title><style>p { color: red; }</style>"
+			"<script type=\"text/javascript\">if (a < b && c > d) { x = '</p>'; }</script></head>"
+			"<body><!-- ein <b>Kommentar</b> --><p class='a > b'>M&uuml;ller &amp; S&#246;hne &lt;GmbH&gt;</p>"
+			"<p>A & B &unbekannt; a < b</p></body></html>";
+		EXPECT_EQ(stripHtml(html), " Titel M\xC3\xBCller & S\xC3\xB6hne <GmbH> A & B &unbekannt; a < b ");
+
+		// Entities ergeben UTF-8 wie der Rest einer UTF-8 Seite, so ist es beide Male das gleiche Wort
+		string mixed = stripHtml("<p>M&uuml;ller und M\xC3\xBCller&#8211;&#xDF;&nbsp;</p>");
+		EXPECT_EQ(mixed, " M\xC3\xBCller und M\xC3\xBCller\xE2\x80\x93\xC3\x9F ");
+		EXPECT_EQ(createWordDistribution(stripHtml("<p>M&uuml;ller und M\xC3\xBCller</p>"))["M\xC3\xBCller"], 2);
+
+		// fehlerhaftes HTML wirft keine Exception mehr
+		string broken = "Text <b>fett</b> <a href=\"offen";
+		EXPECT_NO_THROW(cleanUpText(broken, cleanupType::HTML));
+		EXPECT_EQ(broken, "Text fett ");
+	}
+	TEST(CleanUp, HtmlInChunks)
+	{
+		string html;
+		for (int i = 0; i < 200; ++i)
+			html += "<div id=\"d" + to_string(i) + "\"><!-- x --><script>var s = '<b>';</script>Das ist ein Satz &auml;hnlich wie &#x41;.</div>\n";
+		string expected = stripHtml(html);
+
+		for (size_t chunkSize : { 1, 2, 3, 7, 64, 1000 })
+		{
+			string text;
+			HtmlStripper stripper([&text](string_view part) { text += part; });
+			for (size_t pos = 0; pos < html.size(); pos += chunkSize)
+				stripper.feed(string_view(html).substr(pos, chunkSize));
+			stripper.finish();
+			EXPECT_EQ(text, expected) << chunkSize;
+		}
+
+		// der Klartext kann direkt in den StreamAnalyser laufen
+		StreamAnalyser analyser(metricStats);
+		HtmlStripper stripper([&analyser](string_view part) { analyser.feed(part); });
+		stripper.feed(html);
+		stripper.finish();
+		EXPECT_EQ(analyser.finish().stats.words, analyseText(expected, metricStats).stats.words);
+		EXPECT_EQ(countTotalWords(expected), 200 * 7);
+	}
+	TEST(CleanUp, MarkdownToPlainText)
+	{
+		string markdown =
+			"# \xDC" "berschrift #\n"
+			"Ein **fetter** und _kursiver_ Text mit ~~Fehler~~ und snake_case.\n"
+			"> Ein [Link](http://example.com/a_(b)) und ein ![Bild](bild.png \"Titel\") mit `code *x*`.\n"
+			"\n"
+			"- [x] erledigt\n"
+			"1. Punkt\n"
+			"***\n"
+			"```cpp\n"
+			"int bold = 1; // kein Text\n"
+			"```\n"
+			"Ende \\*ohne\\* bold";
+		EXPECT_EQ(stripMarkdown(markdown),
+			"\xDC" "berschrift\n"
+			"Ein fetter und kursiver Text mit Fehler und snake_case.\n"
+			"Ein Link und ein Bild mit code *x*.\n"
+			"\n"
+			"erledigt\n"
+			"Punkt\n"
+			"\n"
+			"\n"
+			"\n"
+			"\n"
+			"Ende *ohne* bold");
+
+		cleanUpText(markdown, cleanupType::Markdown);
+		EXPECT_EQ(markdown, "\xDC" "berschrift Ein fetter und kursiver Text mit Fehler und snake_case. Ein Link und ein Bild mit code *x*. erledigt Punkt Ende *ohne* bold");
+	}
+	TEST(CleanUp, CombinedFlags)
+	{
+		string testText = "<h1>Titel</h1>\n<p>Ein **Satz**, mit   Zeichen!</p>\n\n<p>Noch-einer.</p>";
+		string html = testText;
+		cleanUpText(html, cleanupType::HTML);
+		EXPECT_EQ(html, " Titel Ein **Satz**, mit Zeichen! Noch-einer. ");
+
+		cleanUpText(testText, cleanupType::HTML | cleanupType::Markdown | cleanupType::removeAllSigns);
+		EXPECT_EQ(testText, "Titel Ein Satz mit Zeichen Noch einer ");
+
+		// als Stufe vor dem StreamAnalyser, in kleinen Teilen
+		string markup;
+		for (int i = 0; i < 50; ++i)
+			markup += "<p>Das ist *ein* Satz.</p>\n";
+		StreamAnalyser analyser(metricStats | metricWordDistribution);
+		CleanupPipeline pipeline(cleanupType::HTML | cleanupType::Markdown, [&analyser](string_view part) { analyser.feed(part); });
+		for (size_t pos = 0; pos < markup.size(); pos += 5)
+			pipeline.feed(string_view(markup).substr(pos, 5));
+		pipeline.finish();
+		AnalysisResult result = analyser.finish();
+		EXPECT_EQ(result.stats.words, 50 * 4);
+		EXPECT_EQ(result.stats.sentense, 50);
+		EXPECT_EQ(result.words["ein"], 50);
+	}
+	TEST(CleanUp, MarkdownInChunks)
+	{
+		string markdown;
+		for (int i = 0; i < 100; ++i)
+			markdown += "## Kapitel " + to_string(i) + "\r\nDas ist **ein** [Satz](url).\n```\ncode\n```\n";
+		string expected = stripMarkdown(markdown);
+		EXPECT_EQ(countTotalWords(expected), 100 * 5);
+
+		for (size_t chunkSize : { 1, 5, 13, 4096 })
+		{
+			string text;
+			MarkdownStripper stripper([&text](string_view part) { text += part; });
+			for (size_t pos = 0; pos < markdown.size(); pos += chunkSize)
+				stripper.feed(string_view(markdown).substr(pos, chunkSize));
+			stripper.finish();
+			EXPECT_EQ(text, expected) << chunkSize;
+		}
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+	TEST(KeywordSearch, OverlappingHitsAndOptions)
+	{
+		KeywordSearch search({ "he", "she", "his", "hers", "" });
+		vector<KeywordHit> hits = search.findAll("ushers");
+		ASSERT_EQ(hits.size(), 3);
+		EXPECT_EQ(search.keyword(hits[0].keyword), "she");
+		EXPECT_EQ(hits[0].position, 1);
+		EXPECT_EQ(search.keyword(hits[1].keyword), "he");
+		EXPECT_EQ(hits[1].position, 2);
+		EXPECT_EQ(search.keyword(hits[2].keyword), "hers");
+		EXPECT_EQ(hits[2].length, 4);
+
+		string text = "Das Haus am See. Ein HAUSBOOT im haus, \xC4pfel und \xE4pfel.";
+		KeywordSearch exact({ "Haus", "\xE4pfel" });
+		EXPECT_EQ(exact.count(text), (keywordCounts{ 1, 1 }));
+
+		KeywordOptions options;
+		options.ignoreCase = true;
+		KeywordSearch folded({ "Haus", "\xE4pfel" }, options);
+		EXPECT_EQ(folded.count(text), (keywordCounts{ 3, 2 }));
+
+		options.wholeWords = true;
+		KeywordSearch words({ "Haus", "\xE4pfel", "See" }, options);
+		EXPECT_EQ(words.count(text), (keywordCounts{ 2, 2, 1 }));
+
+		// ganze Worte nach Code Points: "ller" steht in "Müller" hinter einem Buchstaben, » ist keiner
+		KeywordSearch names({ "ller", "Haus", "M\xC3\xBCller" }, options);
+		EXPECT_EQ(names.count("M\xC3\xBCller, \xC3\xA4Haus und \xC2\xBBHaus\xC2\xAB"), (keywordCounts{ 0, 1, 1 }));
+
+		// ignoreCase mit UTF-8, die Treffer zeigen auf den Originaltext
+		options.wholeWords = false;
+		KeywordSearch utf8({ "f\xC3\xBCr" }, options);
+		vector<KeywordHit> utf8Hits = utf8.findAll("F\xC3\x9CR f\xC3\xBCr \xE3\xBC\x80");
+		ASSERT_EQ(utf8Hits.size(), 2);
+		EXPECT_EQ(utf8Hits[0].position, 0);
+		EXPECT_EQ(utf8Hits[1].position, 5);
+		EXPECT_EQ(utf8Hits[1].length, 4);
+	}
+	TEST(KeywordSearch, SameAsNaiveSearchAndCorpus)
+	{
+		vector<string> keywords = { "ab", "abc", "bca", "c", "aaa", "cab" };
+		KeywordSearch search(keywords);
+
+		vector<string> documents;
+		keywordCounts expected(keywords.size(), 0);
+		srand(7);
+		for (int d = 0; d < 50; ++d)
+		{
+			string text;
+			for (int i = 0; i < 200; ++i)
+				text += "abc "[rand() % 4];
+			for (size_t k = 0; k < keywords.size(); ++k)
+			{
+				for (size_t pos = text.find(keywords[k]); pos != string::npos; pos = text.find(keywords[k], pos + 1))
+					expected[k]++;
+			}
+			documents.push_back(text);
+		}
+
+		keywordCounts counts;
+		for (const string& text : documents)
+			search.count(text, counts);
+		EXPECT_EQ(counts, expected);
+		EXPECT_EQ(search.countAsync(documents), expected);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------
+	TEST(InvertedIndex, QueriesMatchScans)
+	{
+		vector<string> texts = {
+			"Der Hund bellt. Der Hund schl\xE4" "ft nicht, die Katze schl\xE4" "ft!",
+			"Eine Katze und ein Hund. Hund und Katze sind Freunde",
+			"Nur ein Text ohne Tiere.",
+			"Hund . Katze",
+			"Hund .Katze"
+		};
+		AnalysisOptions options;
+		options.useLowerCase = true;
+		InvertedIndex index(options);
+		for (const string& text : texts)
+			index.addDocument(text);
+
+		EXPECT_EQ(index.documentCount(), 5);
+		EXPECT_EQ(index.frequency("hund"), 6);
+		EXPECT_EQ(index.frequency("Hund"), 6);
+		EXPECT_EQ(index.documentFrequency("katze"), 4);
+		EXPECT_EQ(index.documents("ein"), (vector<uint32_t>{ 1, 2 }));
+		EXPECT_EQ(index.frequency("vogel"), 0);
+
+		vector<IndexHit> hits = index.lookup("hund");
+		ASSERT_EQ(hits.size(), 6);
+		EXPECT_EQ(hits[1].document, 0);
+		EXPECT_EQ(hits[1].token, 4);
+		EXPECT_EQ(texts[0].substr(hits[1].position, 4), "Hund");
+
+		vector<IndexHit> phrase = index.phrase("der Hund");
+		ASSERT_EQ(phrase.size(), 2);
+		EXPECT_EQ(phrase[1].token, 3);
+		EXPECT_EQ(index.phrase("Hund und Katze").size(), 1);
+		EXPECT_EQ(index.phrase("Katze Hund").size(), 0);
+
+		// near zählt dieselben Paare wie findConnectedWords, auch nicht über ein Satzende hinweg
+		for (int range : { 2, 3, 5 })
+		{
+			int expected = 0;
+			for (const string& text : texts)
+			{
+				wordPairs pairs = findConnectedWords(text, 1, range);
+				expected += pairs[{ "hund", "katze" }] + pairs[{ "katze", "hund" }];
+			}
+			EXPECT_EQ(index.near("hund", "katze", range).size() + index.near("katze", "hund", range).size(), expected) << range;
+		}
+		EXPECT_EQ(index.near("bellt", "der", 5).size(), 0);
+
+		// ein freistehender Punkt trennt die Sätze genauso
+		for (const ProximityHit& hit : index.near("hund", "katze", 2))
+			EXPECT_LT(hit.document, 3u);
+	}
+	TEST(InvertedIndex, SaveAndLoad)
+	{
+		InvertedIndex index;
+		for (int i = 0; i < 100; ++i)
+			index.addDocument("Dokument Nummer " + string(i % 7 + 1, 'x') + ". Noch ein Satz im Dokument.");
+
+		string path = "index_test.bin";
+		ASSERT_TRUE(index.save(path));
+		InvertedIndex loaded;
+		ASSERT_TRUE(loaded.load(path));
+		EXPECT_EQ(loaded.documentCount(), 100);
+		EXPECT_EQ(loaded.wordCount(), index.wordCount());
+		EXPECT_EQ(loaded.frequency("Dokument"), 200);
+		EXPECT_EQ(loaded.documents("xxx").size(), index.documents("xxx").size());
+		EXPECT_EQ(loaded.phrase("Satz im Dokument").size(), 100);
+		EXPECT_EQ(loaded.near("Nummer", "Noch", 5).size(), 0);
+
+		// eine abgeschnittene Datei wird nicht geladen
+		{
+			ifstream in(path, ios::binary);
+			string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+			ofstream out(path, ios::binary | ios::trunc);
+			out << content.substr(0, content.size() / 2);
+		}
+		EXPECT_FALSE(loaded.load(path));
+		EXPECT_EQ(loaded.documentCount(), 0);
+		remove(path.c_str());
+	}
+	// ---------------------------------------------------
+	TEST(Utf8, TokenizeCodePoints)
+	{
+		// "Äpfel, Straße und ×Élan. Wald" in UTF-8, das W mit Gravis (U+1E80)
+		string testText = "\xC3\x84pfel, Stra\xC3\x9F" "e und \xC3\x97\xC3\x89lan. \xE1\xBA\x80" "ald";
+		stringList words;
+		for (const Token& t : tokenizeUtf8(testText))
+		{
+			EXPECT_EQ(t.value.data(), testText.data() + t.position);
+			words.emplace_back(t.value);
+		}
+		EXPECT_EQ(words, stringList({ "\xC3\x84pfel", "Stra\xC3\x9F" "e", "und", "\xC3\x89lan", "\xE1\xBA\x80" "ald" }));
+
+		// ohne Umlaute sind die Worte die gleichen wie bei tokenize
+		string asciiText = "Das... ist ein    !Kleiner! Text.\nNicht-Ganz soo00        normal?";
+		EXPECT_TRUE(isAscii(asciiText));
+		EXPECT_FALSE(isAscii(testText));
+		stringList list = splitTextIntoStringList(asciiText);
+		size_t count = 0;
+		for (const Token& t : tokenizeUtf8(asciiText))
+			EXPECT_EQ(t.value, list[count++]);
+		EXPECT_EQ(count, list.size());
+
+		// jeder lateinische Buchstabe in UTF-8 zählt einmal und trennt kein Wort
+		Stats stat = analyseText("\xC3\x84pfel Stra\xC3\x9F" "e \xC5\x81\xC3\xB3" "d\xC5\xBA", metricStats).stats;
+		EXPECT_EQ(stat.words, 3);
+		EXPECT_EQ(stat.letters, 5 + 6 + 4);
+	}
+
+	TEST(Utf8, LowerCaseIntoBuffer)
+	{
+		string buffer;
+		toLowerUtf8("\xC3\x84\xC3\x96\xC3\x9C \xC3\x89\xC5\x81\xE1\xBA\x9E Abc", buffer);
+		EXPECT_EQ(buffer, "\xC3\xA4\xC3\xB6\xC3\xBC \xC3\xA9\xC5\x82\xC3\x9F abc");
+		// Latin-1 bleibt Latin-1, andere Bytes bleiben wie sie sind
+		toLowerUtf8("\xC4pfel\x80\xD7", buffer);
+		EXPECT_EQ(buffer, "\xE4pfel\x80\xD7");
+		EXPECT_EQ(toLower(U'\u0130'), U'i');
+		EXPECT_TRUE(isLetter(U'\u0142'));
+		EXPECT_FALSE(isLetter(U'\u00D7'));
+
+		string testText = "\xC3\x84pfel \xC3\xA4pfel \xC3\x84PFEL \xC3\x9C" "ber";
+		wordDistribution words = createWordDistribution(testText, true);
+		EXPECT_EQ(words.size(), 2);
+		EXPECT_EQ(words["\xC3\xA4pfel"], 3);
+		EXPECT_EQ(words["\xC3\xBC" "ber"], 1);
+		EXPECT_EQ(splitTextIntoStringList(testText, true)[2], "\xC3\xA4pfel");
+		EXPECT_EQ(createWordDistribution(testText, false).size(), 4);
+	}
+	// ---------------------------------------------------
+	TEST(TokenTable, SameResultAsAnalyseText)
+	{
+		string testText;
+		for (int i = 0; i < 50; ++i)
+			testText += "Der Hund und die KATZE. Die Katze sieht den Hund, der Hund bellt! \xC3\x84pfel und \xC3\xA4pfel " + string(i % 5 + 1, 'x') + "\n";
+
+		AnalysisOptions options;
+		options.useLowerCase = true;
+		options.minOccurrences = 1;
+		options.range = 3;
+		options.stopWords = &StopWordFilter::german();
+		TokenTable table(testText, options);
+		AnalysisResult expected = analyseText(testText, metricAll, options);
+
+		EXPECT_EQ(table.size(), static_cast<size_t>(expected.stats.words));
+		EXPECT_EQ(table.wordCounts(), expected.words);
+		EXPECT_EQ(table.wordLengths(), expected.wordLengths);
+		EXPECT_EQ(table.pairs(), expected.pairs);
+
+		// minOccurrences < 1 ergibt wie bei analyseText keine Paare
+		options.minOccurrences = 0;
+		EXPECT_TRUE(TokenTable(testText, options).pairs().empty());
+		EXPECT_TRUE(analyseText(testText, metricAll, options).pairs.empty());
+
+		// ohne Optionen wie die einzelnen Funktionen
+		TokenTable plain(testText);
+		EXPECT_EQ(plain.wordCounts(), createWordDistribution(testText));
+		EXPECT_EQ(plain.wordLengths(), calculateWordLengthDistibution(testText));
+		EXPECT_EQ(plain.pairs(), findConnectedWords(testText));
+	}
+
+	TEST(TokenTable, ColumnsAndSearch)
+	{
+		AnalysisOptions options;
+		options.useLowerCase = true;
+		TokenTable table(options);
+		table.build("Der Hund. Der HUND bellt");
+
+		ASSERT_EQ(table.size(), 5u);
+		EXPECT_EQ(table.token(3), "hund");
+		EXPECT_EQ(table.position(3), 14u);
+		EXPECT_EQ(table.sentence(1), 0u);
+		EXPECT_EQ(table.sentence(2), 1u);
+		EXPECT_EQ(table.sentenceCount(), 2u);
+		EXPECT_EQ(table.id(1), table.id(3));
+		EXPECT_EQ(table.letters(4), 5u);
+		// alle Worte liegen direkt hintereinander im selben Block
+		for (size_t i = 1; i < table.size(); ++i)
+			EXPECT_EQ(table.token(i).data(), table.token(i - 1).data() + table.token(i - 1).size());
+
+		EXPECT_EQ(table.find("Hund"), vector<size_t>({ 1, 3 }));
+		EXPECT_EQ(table.count("DER"), 2u);
+		EXPECT_EQ(table.count("Katze"), 0u);
+		EXPECT_EQ(table.wordIdCounts()[table.id(0)], 2);
+
+		table.build("Neuer Text");
+		EXPECT_EQ(table.size(), 2u);
+		EXPECT_EQ(table.vocabulary().size(), 2u);
+		EXPECT_EQ(table.token(0), "neuer");
+	}
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+	TEST(Metrics, SnapshotExport)
+	{
+		resetMetrics();
+		addStageMetric(stageCleanup, fieldCalls, 2);
+		addStageMetric(stageCleanup, fieldBytesIn, 300);
+		addCounter(counterHashResizes, 4);
+		updatePeak(peakPairTableBytes, 1024);
+		updatePeak(peakPairTableBytes, 512);
+
+		MetricsSnapshot snapshot = getMetricsSnapshot();
+		EXPECT_EQ(snapshot.stages[stageCleanup].calls, 2u);
+		EXPECT_EQ(snapshot.stages[stageCleanup].bytesIn, 300u);
+		EXPECT_EQ(snapshot.counters[counterHashResizes], 4u);
+		EXPECT_EQ(snapshot.peaks[peakPairTableBytes], 1024u);
+
+		string json = snapshot.toJson();
+		EXPECT_NE(json.find("\"cleanup\":{\"calls\":2,\"seconds\":0,\"bytesIn\":300"), string::npos);
+		EXPECT_NE(json.find("\"hashResizes\":4"), string::npos);
+		EXPECT_NE(json.find("\"statsCache\":{\"hits\":"), string::npos);
+
+		string prometheus = snapshot.toPrometheus();
+		EXPECT_NE(prometheus.find("# TYPE textanalyser_stage_calls_total counter\n"), string::npos);
+		EXPECT_NE(prometheus.find("textanalyser_stage_bytes_in_total{stage=\"cleanup\"} 300\n"), string::npos);
+		EXPECT_NE(prometheus.find("textanalyser_peak_pair_table_bytes 1024\n"), string::npos);
+
+		// Werte aus einem beendeten Thread bleiben erhalten
+		thread([] { addStageMetric(stageCleanup, fieldCalls, 1); }).join();
+		EXPECT_EQ(getMetricsSnapshot().stages[stageCleanup].calls, 3u);
+
+		resetMetrics();
+		snapshot = getMetricsSnapshot();
+		EXPECT_EQ(snapshot.stages[stageCleanup].calls, 0u);
+		EXPECT_EQ(snapshot.peaks[peakPairTableBytes], 0u);
+	}
+
+	TEST(Metrics, StagesDuringAnalysis)
+	{
+		// die Messpunkte gibt es nur wenn die Bibliothek mit ANALYSER_METRICS übersetzt wurde
+		if (!getMetricsSnapshot().enabled)
+			return;
+
+		string text;
+		for (int i = 0; i < 20000; ++i)
+			text += "Der Hund bellt laut. Die Katze schläft im Haus! ";
+		resetMetrics();
+		clearCache();
+
+		// ein zweiter Thread liest die Werte während die Analyse läuft
+		atomic<bool> done{ false };
+		thread reader([&done]
+			{
+				uint64_t last = 0;
+				while (!done)
+				{
+					uint64_t bytes = getMetricsSnapshot().stages[stageAnalyse].bytesIn;
+					EXPECT_GE(bytes, last);
+					last = bytes;
+				}
+			});
+		Stats stats = analyseTextAsync(text, metricStats | metricWordPairs).stats;
+		done = true;
+		reader.join();
+
+		MetricsSnapshot snapshot = getMetricsSnapshot();
+		EXPECT_EQ(snapshot.stages[stageAnalyse].bytesIn, text.size());
+		EXPECT_EQ(snapshot.stages[stageAnalyse].tokens, static_cast<uint64_t>(stats.words));
+		EXPECT_EQ(snapshot.stages[stageAnalyse].sentences, static_cast<uint64_t>(stats.sentense));
+		EXPECT_GT(snapshot.stages[stagePairs].calls, 0u);
+		EXPECT_GT(snapshot.counters[counterHashResizes], 0u);
+		EXPECT_GT(snapshot.peaks[peakPairTableBytes], 0u);
+
+		uint64_t hits = snapshot.cacheHits;
+		countTotalWords(text);
+		countTotalWords(text);
+		snapshot = getMetricsSnapshot();
+		EXPECT_EQ(snapshot.stages[stageStatsHash].calls, 2u);
+		EXPECT_EQ(snapshot.cacheHits, hits + 1);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+	TEST(CorpusAnalyser, SameResultAsAnalyseText)
+	{
+		const string directory = "corpus_test";
+		filesystem::create_directories(directory + "/sub");
+		const string sentences[] = { "Der Hund bellt laut.", "Die Katze schläft!", "Ein Auto fährt schnell vorbei?", "Oben ist es kalt." };
+		stringList paths;
+		for (int f = 0; f < 12; ++f)
+		{
+			string path = directory + (f % 3 ? "/" : "/sub/") + "datei" + to_string(f) + ".txt";
+			ofstream file(path, ios::binary);
+			// eine große Datei die zerlegt wird, dazu kleine Dateien mit \r\n
+			int count = (f == 5) ? 3000 : 5 + f;
+			for (int i = 0; i < count; ++i)
+				file << sentences[(i * 7 + f) % 4] << ((i % 5) ? " " : "\r\n");
+			paths.push_back(path);
+		}
+		paths.push_back(directory + "/gibt_es_nicht.txt");
+
+		CorpusOptions options;
+		options.cleanup = cleanupType::None;
+		options.analysis.minOccurrences = 2;
+		options.splitSize = 4096;
+		options.batchSize = 1000;
+		options.maxBytesInFlight = 16384;
+
+		setThreadCount(4);
+		CorpusResult corpus = analyseCorpus(paths, options);
+		setThreadCount(0);
+
+		ASSERT_EQ(corpus.documents.size(), paths.size());
+		EXPECT_EQ(corpus.failed, 1u);
+		EXPECT_FALSE(corpus.documents.back().ok);
+		EXPECT_LE(corpus.peakBytesInFlight, 16384u);
+
+		AnalysisOptions unpruned = options.analysis;
+		unpruned.minOccurrences = 1;
+		AnalysisResult total;
+		for (size_t d = 0; d + 1 < paths.size(); ++d)
+		{
+			string text = readFile(paths[d], cleanupType::None);
+			AnalysisResult expected = analyseText(text, metricAll, options.analysis);
+			const DocumentResult& document = corpus.documents[d];
+			ASSERT_TRUE(document.ok);
+			EXPECT_EQ(document.size, filesystem::file_size(paths[d]));
+			EXPECT_EQ(document.result.stats.words, expected.stats.words);
+			EXPECT_EQ(document.result.stats.sentense, expected.stats.sentense);
+			EXPECT_EQ(document.result.stats.syllable, expected.stats.syllable);
+			EXPECT_EQ(document.result.wordLengths, expected.wordLengths);
+			EXPECT_EQ(document.result.words, expected.words);
+			EXPECT_EQ(document.result.pairs, expected.pairs);
+			mergeAnalysisResult(total, analyseText(text, metricAll, unpruned));
+		}
+
+		// minOccurrences gilt für die Summe, nicht für die Dokumente einzeln
+		for (auto it = total.pairs.begin(); it != total.pairs.end();)
+			it = (it->second < 2) ? total.pairs.erase(it) : next(it);
+		EXPECT_EQ(corpus.total.stats.words, total.stats.words);
+		EXPECT_EQ(corpus.total.words, total.words);
+		EXPECT_EQ(corpus.total.pairs, total.pairs);
+
+		EXPECT_EQ(listCorpusFiles(directory).size(), 12u);
+		EXPECT_EQ(listCorpusFiles(directory, { ".txt" }, false).size(), 8u);
+		EXPECT_TRUE(listCorpusFiles(directory, { ".html" }).empty());
+
+		options.keepDocumentResults = false;
+		CorpusResult statsOnly = analyseCorpusDirectory(directory, options);
+		EXPECT_EQ(statsOnly.failed, 0u);
+		EXPECT_EQ(statsOnly.total.words, total.words);
+		EXPECT_TRUE(statsOnly.documents[0].result.words.empty());
+		EXPECT_GT(statsOnly.documents[0].result.stats.words, 0);
+
+		filesystem::remove_all(directory);
+	}
+
+	// ------------------------------------------------------------------------------------------------------------------------
+
+	TEST(ResultFile, RoundTripAndQueries)
+	{
+		string text;
+		for (int i = 0; i < 300; ++i)
+			text += "Der Hund" + to_string(i % 40) + " bellt laut. Die Katze schläft im Haus" + to_string(i % 7) + "! ";
+		AnalysisOptions options;
+		options.minOccurrences = 1;
+		AnalysisResult expected = analyseText(text, metricAll, options);
+
+		const string path = "result_test.tarf";
+		ASSERT_TRUE(saveAnalysisResult(expected, path));
+		ResultFile file(path);
+		ASSERT_TRUE(file.isOpen());
+		EXPECT_EQ(file.stats().words, expected.stats.words);
+		EXPECT_EQ(file.stats().syllable, expected.stats.syllable);
+		EXPECT_EQ(file.pairCount(), expected.pairs.size());
+		EXPECT_EQ(file.wordLengths(), expected.wordLengths);
+
+		for (const auto& [word, count] : expected.words)
+		{
+			EXPECT_EQ(file.count(word), static_cast<uint64_t>(count)) << word;
+			EXPECT_EQ(file.word(file.find(word)), word);
+		}
+		for (const auto& [words, count] : expected.pairs)
+			EXPECT_EQ(file.pairCount(words.first, words.second), static_cast<uint64_t>(count));
+		EXPECT_EQ(file.count("Vogel"), 0u);
+		EXPECT_EQ(file.count(""), 0u);
+		EXPECT_EQ(file.find("Aaa"), invalidWordId);
+		EXPECT_EQ(file.pairCount("Hund", "Vogel"), 0u);
+
+		AnalysisResult loaded = file.toAnalysisResult();
+		EXPECT_EQ(loaded.words, expected.words);
+		EXPECT_EQ(loaded.pairs, expected.pairs);
+		file.close();
+
+		// abgeschnittene oder fremde Dateien werden abgelehnt
+		string data = readFile(path, cleanupType::None);
+		ofstream(path, ios::binary | ios::trunc).write(data.data(), data.size() / 2);
+		EXPECT_FALSE(file.open(path));
+		ofstream(path, ios::binary | ios::trunc) << "kein Ergebnis";
+		EXPECT_FALSE(file.open(path));
+		remove(path.c_str());
+	}
+
+	TEST(ResultFile, KWayMerge)
+	{
+		const string texts[] = { "Der Hund bellt. Der Hund läuft.", "Die Katze schläft. Der Hund bellt laut!", "Ein Vogel singt? Der Vogel fliegt.", "" };
+		AnalysisOptions options;
+		options.minOccurrences = 1;
+		stringList paths;
+		AnalysisResult expected;
+		for (size_t i = 0; i < size(texts); ++i)
+		{
+			AnalysisResult result = analyseText(texts[i], metricAll, options);
+			paths.push_back("merge_test" + to_string(i) + ".tarf");
+			ASSERT_TRUE(saveAnalysisResult(result, paths.back()));
+			mergeAnalysisResult(expected, result);
+		}
+
+		ASSERT_TRUE(mergeResultFiles(paths, paths[0]));
+		ResultFile merged(paths[0]);
+		ASSERT_TRUE(merged.isOpen());
+		AnalysisResult loaded = merged.toAnalysisResult();
+		EXPECT_EQ(loaded.stats.words, expected.stats.words);
+		EXPECT_EQ(loaded.stats.sentense, expected.stats.sentense);
+		EXPECT_EQ(loaded.wordLengths, expected.wordLengths);
+		EXPECT_EQ(loaded.words, expected.words);
+		EXPECT_EQ(loaded.pairs, expected.pairs);
+		EXPECT_EQ(merged.count("Hund"), 3u);
+
+		// die Paare sind nach den Ids sortiert
+		pair<wordId, wordId> previous(0, 0);
+		size_t pairs = 0;
+		merged.forEachPair([&](wordId first, wordId second, uint64_t)
+		{
+			EXPECT_TRUE(pairs++ == 0 || make_pair(first, second) > previous);
+			previous = make_pair(first, second);
+		});
+		EXPECT_EQ(pairs, expected.pairs.size());
+		merged.close();
+
+		EXPECT_FALSE(mergeResultFiles({ paths[1], "gibt_es_nicht.tarf" }, "merge_test_out.tarf"));
+		for (const string& path : paths)
+			remove(path.c_str());
+	}
 }
\ No newline at end of file
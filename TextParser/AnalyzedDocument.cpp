@@ -0,0 +1,125 @@
+#include "AnalyzedDocument.h"
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    // Siehe Header
+    AnalyzedDocument::AnalyzedDocument(std::string text, const AnalysisOptions& options)
+        : AnalyzedDocument(make_unique<string>(move(text)), string_view(), options)
+    {
+        content = *ownedText;
+    }
+
+    // Siehe Header
+    AnalyzedDocument AnalyzedDocument::fromView(std::string_view text, const AnalysisOptions& options)
+    {
+        return AnalyzedDocument(nullptr, text, options);
+    }
+
+    /**
+    * [intern]
+    * Gemeinsamer Konstruktor für eigene und gelesene Texte
+    */
+    AnalyzedDocument::AnalyzedDocument(std::unique_ptr<std::string> owned, std::string_view text, const AnalysisOptions& options)
+        : ownedText(move(owned)), content(text), analysisOptions(options)
+    {
+    }
+
+    /**
+    * [intern]
+    * Die Zeichentabelle zu den Trennzeichen aus den options
+    */
+    const CharTable& AnalyzedDocument::table() const
+    {
+        if (!charTable)
+            charTable = makeCharTable(analysisOptions.wordEnd, analysisOptions.sentenceEnd);
+        return *charTable;
+    }
+
+    // Siehe Header
+    const std::vector<Token>& AnalyzedDocument::tokens() const
+    {
+        if (!tokenList)
+        {
+            tokenList.emplace();
+            for (const Token& t : tokenize(content, analysisOptions.wordEnd))
+                tokenList->push_back(t);
+        }
+        return *tokenList;
+    }
+
+    // Siehe Header
+    const std::vector<SentenceSpan>& AnalyzedDocument::sentences() const
+    {
+        if (!sentenceList)
+        {
+            // ein Satz endet wenn das Zeichen hinter einem Wort Wortende und Satzende ist, wie bei Stats
+            sentenceList.emplace();
+            const CharTable& charClass = table();
+            const unsigned char sentenceBound = charWordEnd | charSentenceEnd;
+            bool inSentence = false;
+            size_t begin = 0;
+            size_t end = 0;
+            for (const Token& t : tokens())
+            {
+                if (!inSentence)
+                {
+                    begin = t.position;
+                    inSentence = true;
+                }
+
+                end = t.position + t.value.size();
+                if (end < content.size() && (charClass[content[end]] & sentenceBound) == sentenceBound)
+                {
+                    sentenceList->push_back({ begin, end + 1 });
+                    inSentence = false;
+                }
+            }
+            // ein Wort am Ende des Textes schließt wie bei Stats einen Satz, ein Wort vor einem Komma nicht
+            if (inSentence && end == content.size())
+                sentenceList->push_back({ begin, content.size() });
+        }
+        return *sentenceList;
+    }
+
+    // Siehe Header
+    const TokenTable& AnalyzedDocument::tokenTable() const
+    {
+        if (!tokenColumns)
+            tokenColumns.emplace(content, analysisOptions);
+        return *tokenColumns;
+    }
+
+    // Siehe Header
+    const Stats& AnalyzedDocument::stats() const
+    {
+        if (!stat)
+            stat = analyseText(content, metricStats, analysisOptions).stats;
+        return *stat;
+    }
+
+    // Siehe Header
+    const wordLengthDistibution& AnalyzedDocument::wordLengths() const
+    {
+        if (!lengths)
+            lengths = tokenTable().wordLengths();
+        return *lengths;
+    }
+
+    // Siehe Header
+    const wordDistribution& AnalyzedDocument::words() const
+    {
+        if (!distribution)
+            distribution = tokenTable().wordCounts();
+        return *distribution;
+    }
+
+    // Siehe Header
+    const wordPairs& AnalyzedDocument::pairs() const
+    {
+        if (!pairList)
+            pairList = tokenTable().pairs();
+        return *pairList;
+    }
+}
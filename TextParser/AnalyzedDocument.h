@@ -0,0 +1,95 @@
+/**
+* AnalyzedDocument.h
+*
+* Ein Text zusammen mit allen Ergebnissen die bereits über ihn berechnet wurden. Jedes Ergebnis wird erst beim
+* ersten Abruf berechnet und danach aus dem Speicher zurückgegeben, ohne den Text erneut zu hashen oder zu lesen.
+*/
+#pragma once
+#ifndef TEXTANALYSER_ANALYZEDDOCUMENT
+#define TEXTANALYSER_ANALYZEDDOCUMENT
+
+#include "TextAnalyser.h"
+#include "TokenTable.h"
+#include <optional>
+
+namespace AnalyserLib
+{
+	/**
+	* Ein Satz im Text, von der Position des ersten Wortes bis hinter das Satzende
+	*/
+	struct SentenceSpan
+	{
+		size_t begin;
+		size_t end;
+	};
+
+	/**
+	* Hält einen Text und berechnet Tokens, Sätze, Stats, Wortlängen, Wortverteilung und Wortpaare bei Bedarf.
+	* Die Ergebnisse entsprechen den einzelnen Funktionen mit den übergebenen AnalysisOptions.
+	* Nicht threadsicher, jeder Thread sollte mit einem eigenen Dokument arbeiten.
+	*/
+	class AnalyzedDocument
+	{
+	public:
+		/**
+		* Das Dokument übernimmt den Text
+		*
+		* @param	text: Der Text, wird in das Dokument verschoben
+		*			options: Trennzeichen und Einstellungen für Wortverteilung und Wortpaare
+		*/
+		explicit AnalyzedDocument(std::string text, const AnalysisOptions& options = AnalysisOptions());
+
+		/**
+		* Das Dokument liest nur aus text, z.B. aus einer MappedFile. Der Text muss so lange gültig bleiben wie das Dokument.
+		*/
+		static AnalyzedDocument fromView(std::string_view text, const AnalysisOptions& options = AnalysisOptions());
+
+		AnalyzedDocument(AnalyzedDocument&&) = default;
+		AnalyzedDocument& operator=(AnalyzedDocument&&) = default;
+
+		/// Der Text des Dokuments
+		std::string_view text() const { return content; }
+
+		const AnalysisOptions& options() const { return analysisOptions; }
+
+		/// Alle Worte mit Position, wie tokenize
+		const std::vector<Token>& tokens() const;
+
+		/// Alle Sätze, die Anzahl entspricht stats().sentense
+		const std::vector<SentenceSpan>& sentences() const;
+
+		/// Die normalisierten Worte als Spalten, daraus werden wordLengths, words und pairs berechnet
+		const TokenTable& tokenTable() const;
+
+		const Stats& stats() const;
+		const wordLengthDistibution& wordLengths() const;
+		const wordDistribution& words() const;
+		const wordPairs& pairs() const;
+
+		double wordLength() const { return calculateWordLength(stats()); }
+		double sentenceLengthByWords() const { return calculateSentenceLengthByWords(stats()); }
+		double sentenceLengthByLetters() const { return calculateSentenceLengthByLetters(stats()); }
+		ReadabilityScore germanScore() const { return calculateGermanScore(stats()); }
+
+	private:
+		AnalyzedDocument(std::unique_ptr<std::string> owned, std::string_view text, const AnalysisOptions& options);
+
+		const CharTable& table() const;
+
+		/// der eigene Text, liegt auf dem heap damit content auch nach einem move gültig bleibt
+		std::unique_ptr<std::string> ownedText;
+		std::string_view content;
+		AnalysisOptions analysisOptions;
+
+		mutable std::optional<CharTable> charTable;
+		mutable std::optional<std::vector<Token>> tokenList;
+		mutable std::optional<std::vector<SentenceSpan>> sentenceList;
+		mutable std::optional<TokenTable> tokenColumns;
+		mutable std::optional<Stats> stat;
+		mutable std::optional<wordLengthDistibution> lengths;
+		mutable std::optional<wordDistribution> distribution;
+		mutable std::optional<wordPairs> pairList;
+	};
+}
+
+#endif // !TEXTANALYSER_ANALYZEDDOCUMENT
@@ -0,0 +1,339 @@
+#include "ApproximateCounter.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /**
+    * [intern]
+    * Durchmischt einen 64 bit Wert (Finalizer von MurmurHash3)
+    */
+    static inline uint64_t mixHash(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Siehe Header
+    std::uint64_t hashWord(std::string_view word)
+    {
+        // FNV-1a, danach durchmischt damit auch die oberen Bits gut verteilt sind
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (char c : word)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3ULL;
+        }
+        return mixHash(h);
+    }
+
+    // Siehe Header
+    CountMinSketch::CountMinSketch(size_t width, size_t depth)
+        : columns(1), rows(max<size_t>(1, depth))
+    {
+        while (columns < width)
+            columns <<= 1;
+        counters.assign(columns * rows, 0);
+    }
+
+    // Siehe Header
+    void CountMinSketch::add(std::uint64_t hash, std::uint64_t count)
+    {
+        // jede Zeile nutzt h1 + i * h2 als eigenen Hash (Kirsch-Mitzenmacher)
+        uint64_t h2 = mixHash(hash) | 1;
+        size_t mask = columns - 1;
+        for (size_t i = 0; i < rows; ++i)
+            counters[i * columns + ((hash + i * h2) & mask)] += count;
+        totalCount += count;
+    }
+
+    // Siehe Header
+    std::uint64_t CountMinSketch::estimate(std::uint64_t hash) const
+    {
+        uint64_t h2 = mixHash(hash) | 1;
+        size_t mask = columns - 1;
+        uint64_t result = UINT64_MAX;
+        for (size_t i = 0; i < rows; ++i)
+            result = min(result, counters[i * columns + ((hash + i * h2) & mask)]);
+        return result;
+    }
+
+    // Siehe Header
+    bool CountMinSketch::merge(const CountMinSketch& other)
+    {
+        if (columns != other.columns || rows != other.rows)
+            return false;
+
+        for (size_t i = 0; i < counters.size(); ++i)
+            counters[i] += other.counters[i];
+        totalCount += other.totalCount;
+        return true;
+    }
+
+    // Siehe Header
+    double CountMinSketch::epsilon() const
+    {
+        return exp(1.0) / static_cast<double>(columns);
+    }
+
+    // Siehe Header
+    double CountMinSketch::delta() const
+    {
+        return exp(-static_cast<double>(rows));
+    }
+
+    // Siehe Header
+    SpaceSaving::SpaceSaving(size_t capacity)
+        : maxEntries(max<size_t>(1, capacity))
+    {
+        // index zeigt in die strings von entries, deshalb darf der vector nicht umziehen
+        entries.reserve(maxEntries);
+    }
+
+    // Siehe Header
+    SpaceSaving::SpaceSaving(const SpaceSaving& other)
+        : maxEntries(other.maxEntries)
+    {
+        entries.reserve(maxEntries);
+        rebuild(other.entries);
+        totalCount = other.totalCount;
+    }
+
+    // Siehe Header
+    SpaceSaving& SpaceSaving::operator=(const SpaceSaving& other)
+    {
+        if (this != &other)
+        {
+            SpaceSaving copy(other);
+            *this = move(copy);
+        }
+        return *this;
+    }
+
+    // Siehe Header
+    void SpaceSaving::add(std::string_view key, std::uint64_t count)
+    {
+        totalCount += count;
+
+        auto it = index.find(key);
+        if (it != index.end())
+        {
+            entries[it->second].count += count;
+            siftDown(heapPos[it->second]);
+            return;
+        }
+
+        if (entries.size() < maxEntries)
+        {
+            size_t idx = entries.size();
+            entries.push_back({ string(key), count, 0 });
+            index.emplace(entries[idx].value, idx);
+            heapPos.push_back(heap.size());
+            heap.push_back(idx);
+            // der neue Eintrag kann kleiner als seine Eltern sein
+            for (size_t pos = heap.size() - 1; pos > 0;)
+            {
+                size_t parent = (pos - 1) / 2;
+                if (entries[heap[parent]].count <= entries[heap[pos]].count)
+                    break;
+                swapHeap(pos, parent);
+                pos = parent;
+            }
+            return;
+        }
+
+        // das seltenste Wort wird ersetzt, seine Häufigkeit ist die Fehlergrenze des neuen
+        size_t idx = heap[0];
+        HeavyHitter& entry = entries[idx];
+        index.erase(entry.value);
+        entry.error = entry.count;
+        entry.count += count;
+        entry.value.assign(key);
+        index.emplace(entry.value, idx);
+        siftDown(0);
+    }
+
+    // Siehe Header
+    const HeavyHitter* SpaceSaving::find(std::string_view key) const
+    {
+        auto it = index.find(key);
+        return it == index.end() ? nullptr : &entries[it->second];
+    }
+
+    // Siehe Header
+    std::vector<HeavyHitter> SpaceSaving::top() const
+    {
+        vector<HeavyHitter> result = entries;
+        sort(result.begin(), result.end(), [](const HeavyHitter& a, const HeavyHitter& b)
+            {
+                return a.count != b.count ? a.count > b.count : a.value < b.value;
+            });
+        return result;
+    }
+
+    // Siehe Header
+    std::uint64_t SpaceSaving::minCount() const
+    {
+        return entries.size() < maxEntries ? 0 : entries[heap[0]].count;
+    }
+
+    // Siehe Header
+    void SpaceSaving::merge(const SpaceSaving& other)
+    {
+        // Worte die in einer Liste fehlen können dort höchstens minCount() mal vorgekommen sein
+        uint64_t ownMin = minCount(), otherMin = other.minCount();
+        vector<HeavyHitter> merged;
+        merged.reserve(entries.size() + other.entries.size());
+
+        for (const HeavyHitter& e : entries)
+        {
+            const HeavyHitter* o = other.find(e.value);
+            if (o)
+                merged.push_back({ e.value, e.count + o->count, e.error + o->error });
+            else
+                merged.push_back({ e.value, e.count + otherMin, e.error + otherMin });
+        }
+        for (const HeavyHitter& o : other.entries)
+        {
+            if (!find(o.value))
+                merged.push_back({ o.value, o.count + ownMin, o.error + ownMin });
+        }
+
+        if (merged.size() > maxEntries)
+        {
+            nth_element(merged.begin(), merged.begin() + maxEntries, merged.end(), [](const HeavyHitter& a, const HeavyHitter& b)
+                {
+                    return a.count > b.count;
+                });
+            merged.resize(maxEntries);
+        }
+
+        uint64_t total = totalCount + other.totalCount;
+        rebuild(move(merged));
+        totalCount = total;
+    }
+
+    /**
+    * [intern]
+    * Legt index und heap für die übergebenen Einträge neu an
+    */
+    void SpaceSaving::rebuild(std::vector<HeavyHitter> values)
+    {
+        entries.clear();
+        index.clear();
+        heap.clear();
+        heapPos.clear();
+        for (HeavyHitter& v : values)
+            entries.push_back(move(v));
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            index.emplace(entries[i].value, i);
+            heap.push_back(i);
+            heapPos.push_back(i);
+        }
+        for (size_t pos = heap.size() / 2; pos > 0; --pos)
+            siftDown(pos - 1);
+    }
+
+    /**
+    * [intern]
+    * Verschiebt einen Eintrag im Min-Heap nach unten bis beide Kinder größer sind
+    */
+    void SpaceSaving::siftDown(size_t pos)
+    {
+        while (true)
+        {
+            size_t smallest = pos;
+            size_t left = pos * 2 + 1, right = left + 1;
+            if (left < heap.size() && entries[heap[left]].count < entries[heap[smallest]].count)
+                smallest = left;
+            if (right < heap.size() && entries[heap[right]].count < entries[heap[smallest]].count)
+                smallest = right;
+            if (smallest == pos)
+                return;
+            swapHeap(pos, smallest);
+            pos = smallest;
+        }
+    }
+
+    /// [intern] Tauscht zwei Plätze im Heap
+    void SpaceSaving::swapHeap(size_t a, size_t b)
+    {
+        swap(heap[a], heap[b]);
+        heapPos[heap[a]] = a;
+        heapPos[heap[b]] = b;
+    }
+
+    // Siehe Header
+    ApproximateCounter::ApproximateCounter(const ApproximateOptions& options)
+        : sketch(options.width, options.depth), heavyHitters(options.topK)
+    {
+    }
+
+    // Siehe Header
+    void ApproximateCounter::add(std::string_view key, std::uint64_t count)
+    {
+        sketch.add(hashWord(key), count);
+        heavyHitters.add(key, count);
+    }
+
+    // Siehe Header
+    std::uint64_t ApproximateCounter::estimate(std::string_view key) const
+    {
+        uint64_t result = sketch.estimate(hashWord(key));
+        if (const HeavyHitter* entry = heavyHitters.find(key))
+            result = min(result, entry->count);
+        return result;
+    }
+
+    // Siehe Header
+    std::vector<HeavyHitter> ApproximateCounter::top() const
+    {
+        vector<HeavyHitter> result = heavyHitters.top();
+        for (HeavyHitter& entry : result)
+        {
+            // die Untergrenze von Space-Saving bleibt, die Obergrenze kann der Sketch verbessern
+            uint64_t lower = entry.count - entry.error;
+            entry.count = min(entry.count, sketch.estimate(hashWord(entry.value)));
+            entry.error = entry.count - lower;
+        }
+        stable_sort(result.begin(), result.end(), [](const HeavyHitter& a, const HeavyHitter& b)
+            {
+                return a.count > b.count;
+            });
+        return result;
+    }
+
+    // Siehe Header
+    bool ApproximateCounter::merge(const ApproximateCounter& other)
+    {
+        if (heavyHitters.capacity() != other.heavyHitters.capacity() || !sketch.merge(other.sketch))
+            return false;
+        heavyHitters.merge(other.heavyHitters);
+        return true;
+    }
+
+    // Siehe Header
+    double ApproximateCounter::errorBound() const
+    {
+        return sketch.epsilon() * static_cast<double>(sketch.total());
+    }
+
+    // Siehe Header
+    double ApproximateCounter::confidence() const
+    {
+        return 1.0 - sketch.delta();
+    }
+
+    // Siehe Header
+    std::uint64_t ApproximateCounter::topErrorBound() const
+    {
+        return heavyHitters.total() / heavyHitters.capacity();
+    }
+}
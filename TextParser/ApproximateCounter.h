@@ -0,0 +1,190 @@
+/**
+* ApproximateCounter.h
+*
+* Zählt Worte oder Wortpaare näherungsweise mit fester Speichergröße. Ein Count-Min Sketch schätzt die Häufigkeit
+* jedes Wortes, Space-Saving merkt sich die topK häufigsten Worte. Beide können zusammengeführt werden,
+* z.B. aus mehreren Threads oder Dateien.
+*/
+#pragma once
+#ifndef TEXTANALYSER_APPROXIMATECOUNTER
+#define TEXTANALYSER_APPROXIMATECOUNTER
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace AnalyserLib
+{
+	/**
+	* Ein häufiges Wort aus der näherungsweisen Zählung. Die echte Häufigkeit liegt zwischen count - error und count.
+	*/
+	struct HeavyHitter
+	{
+		std::string value;
+		std::uint64_t count;
+		std::uint64_t error;
+	};
+
+	/**
+	* Count-Min Sketch: depth Zeilen mit je width Zählern. Die Schätzung ist nie zu klein und mit Wahrscheinlichkeit
+	* 1 - delta() höchstens um epsilon() * total() zu groß.
+	*/
+	class CountMinSketch
+	{
+	public:
+		/**
+		* @param	width: Zähler pro Zeile, wird auf eine Zweierpotenz aufgerundet
+		*			depth: Anzahl der Zeilen
+		*/
+		explicit CountMinSketch(size_t width = 1 << 16, size_t depth = 4);
+
+		/**
+		* Zählt einen Schlüssel, hash muss für gleiche Schlüssel immer gleich sein (siehe hashWord)
+		*/
+		void add(std::uint64_t hash, std::uint64_t count = 1);
+
+		/**
+		* @return	Gibt die geschätzte Häufigkeit zurück
+		*/
+		std::uint64_t estimate(std::uint64_t hash) const;
+
+		/**
+		* Addiert einen anderen Sketch
+		*
+		* @return	false wenn width oder depth nicht übereinstimmen, dann wird nichts geändert
+		*/
+		bool merge(const CountMinSketch& other);
+
+		size_t width() const { return columns; }
+		size_t depth() const { return rows; }
+		/// Summe aller gezählten Häufigkeiten
+		std::uint64_t total() const { return totalCount; }
+		/// relativer Fehler bezogen auf total(), e / width
+		double epsilon() const;
+		/// Wahrscheinlichkeit dass der Fehler überschritten wird, e^-depth
+		double delta() const;
+
+	private:
+		size_t columns;
+		size_t rows;
+		std::vector<std::uint64_t> counters;
+		std::uint64_t totalCount = 0;
+	};
+
+	/**
+	* Space-Saving: merkt sich höchstens capacity Worte. Ist die Liste voll ersetzt ein neues Wort das seltenste,
+	* es übernimmt dessen Häufigkeit als Fehler. Jede Häufigkeit ist höchstens um total() / capacity zu groß.
+	*/
+	class SpaceSaving
+	{
+	public:
+		explicit SpaceSaving(size_t capacity = 1000);
+
+		SpaceSaving(const SpaceSaving& other);
+		SpaceSaving& operator=(const SpaceSaving& other);
+		SpaceSaving(SpaceSaving&&) = default;
+		SpaceSaving& operator=(SpaceSaving&&) = default;
+
+		void add(std::string_view key, std::uint64_t count = 1);
+
+		/**
+		* @return	Gibt den Eintrag zum Wort zurück oder nullptr wenn es nicht in der Liste ist
+		*/
+		const HeavyHitter* find(std::string_view key) const;
+
+		/**
+		* @return	Gibt alle Einträge absteigend nach Häufigkeit sortiert zurück
+		*/
+		std::vector<HeavyHitter> top() const;
+
+		/**
+		* Führt eine andere Liste mit dieser zusammen. Die Fehlergrenze bleibt erhalten.
+		*/
+		void merge(const SpaceSaving& other);
+
+		size_t capacity() const { return maxEntries; }
+		size_t size() const { return entries.size(); }
+		std::uint64_t total() const { return totalCount; }
+		/// Häufigkeit des seltensten Eintrags wenn die Liste voll ist, sonst 0. Obergrenze für alle Worte die fehlen.
+		std::uint64_t minCount() const;
+
+	private:
+		void rebuild(std::vector<HeavyHitter> values);
+		void siftDown(size_t pos);
+		void swapHeap(size_t a, size_t b);
+
+		size_t maxEntries;
+		std::uint64_t totalCount = 0;
+		/// Einträge, die Reihenfolge ändert sich nicht
+		std::vector<HeavyHitter> entries;
+		/// Min-Heap nach count über die Indizes von entries
+		std::vector<size_t> heap;
+		std::vector<size_t> heapPos;
+		std::unordered_map<std::string_view, size_t> index;
+	};
+
+	/**
+	* Einstellungen für die näherungsweise Zählung
+	*/
+	struct ApproximateOptions
+	{
+		/// Zähler pro Zeile im Count-Min Sketch
+		size_t width = 1 << 16;
+		/// Zeilen im Count-Min Sketch
+		size_t depth = 4;
+		/// wie viele häufige Worte gespeichert werden
+		size_t topK = 1000;
+	};
+
+	/**
+	* Count-Min Sketch und Space-Saving zusammen. Der Speicher hängt nur von den ApproximateOptions ab,
+	* nicht von der Anzahl der unterschiedlichen Worte.
+	*/
+	class ApproximateCounter
+	{
+	public:
+		explicit ApproximateCounter(const ApproximateOptions& options = ApproximateOptions());
+
+		void add(std::string_view key, std::uint64_t count = 1);
+
+		/**
+		* @return	Gibt die geschätzte Häufigkeit eines Wortes zurück, sie ist nie zu klein
+		*/
+		std::uint64_t estimate(std::string_view key) const;
+
+		/**
+		* @return	Gibt die häufigsten Worte absteigend sortiert zurück. count ist die kleinere der beiden Schätzungen.
+		*/
+		std::vector<HeavyHitter> top() const;
+
+		/**
+		* Führt einen anderen Zähler mit diesem zusammen
+		*
+		* @return	false wenn die ApproximateOptions nicht zusammenpassen, dann wird nichts geändert
+		*/
+		bool merge(const ApproximateCounter& other);
+
+		std::uint64_t total() const { return sketch.total(); }
+		/// estimate() ist mit Wahrscheinlichkeit confidence() höchstens um errorBound() zu groß
+		double errorBound() const;
+		double confidence() const;
+		/// jeder Wert aus top() ist sicher höchstens um topErrorBound() zu groß
+		std::uint64_t topErrorBound() const;
+
+		const CountMinSketch& getSketch() const { return sketch; }
+		const SpaceSaving& getTop() const { return heavyHitters; }
+
+	private:
+		CountMinSketch sketch;
+		SpaceSaving heavyHitters;
+	};
+
+	/**
+	* 64 bit Hash für Worte, auf allen Plattformen gleich damit Sketches aus verschiedenen Läufen zusammenpassen
+	*/
+	std::uint64_t hashWord(std::string_view word);
+}
+
+#endif // !TEXTANALYSER_APPROXIMATECOUNTER
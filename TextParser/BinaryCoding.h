@@ -0,0 +1,89 @@
+/**
+* BinaryCoding.h
+*
+* Bausteine für die Binärdateien von InvertedIndex und ResultFile: varints mit 7 bit pro Byte, Zahlen mit fester
+* Breite (little endian, unabhängig von der Plattform) und ein Leser der nie über das Ende des Puffers liest.
+*/
+#pragma once
+#ifndef TEXTANALYSER_BINARYCODING
+#define TEXTANALYSER_BINARYCODING
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace AnalyserLib
+{
+	/**
+	* Schreibt v als varint: 7 bit pro Byte, das höchste Bit zeigt an dass noch ein Byte folgt
+	*/
+	inline void writeVarint(std::vector<std::uint8_t>& out, std::uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			out.push_back(static_cast<std::uint8_t>(v) | 0x80);
+			v >>= 7;
+		}
+		out.push_back(static_cast<std::uint8_t>(v));
+	}
+
+	/**
+	* Schreibt v mit 8 Byte, das niedrigste Byte zuerst
+	*/
+	inline void writeFixed64(std::vector<std::uint8_t>& out, std::uint64_t v)
+	{
+		for (int i = 0; i < 8; ++i)
+			out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+	}
+
+	/**
+	* Liest 8 Byte die mit writeFixed64 geschrieben wurden, ohne Prüfung der Länge
+	*/
+	inline std::uint64_t readFixed64(const std::uint8_t* p)
+	{
+		std::uint64_t v = 0;
+		for (int i = 0; i < 8; ++i)
+			v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+		return v;
+	}
+
+	/**
+	* Liest Werte aus einem Puffer. Am Ende des Puffers oder bei einem zu langen varint wird ok false und es kommt 0 zurück.
+	*/
+	struct ByteReader
+	{
+		const std::uint8_t* p;
+		const std::uint8_t* end;
+		bool ok = true;
+
+		std::uint64_t varint()
+		{
+			std::uint64_t v = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (p >= end)
+					break;
+				std::uint8_t b = *p++;
+				v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+				if (!(b & 0x80))
+					return v;
+			}
+			ok = false;
+			return 0;
+		}
+
+		std::string_view bytes(size_t size)
+		{
+			if (static_cast<size_t>(end - p) < size)
+			{
+				ok = false;
+				return {};
+			}
+			std::string_view s(reinterpret_cast<const char*>(p), size);
+			p += size;
+			return s;
+		}
+	};
+}
+
+#endif // !TEXTANALYSER_BINARYCODING
@@ -0,0 +1,826 @@
+#include "CleanupFilters.h"
+#include "Utf8.h"
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /// [intern] Ab dieser Größe wird der Ausgabepuffer auch mitten in einem feed an den sink gegeben
+    constexpr size_t flushSize = 64 * 1024;
+
+    /// [intern] Entities werden nur bis zu dieser Länge gesammelt, längere bleiben unverändert im Text
+    constexpr size_t maxEntityLength = 32;
+
+    /**
+    * [intern]
+    * Benannte Entities, die Werte sind UTF-8 kodiert
+    */
+    struct NamedEntity
+    {
+        string_view name;
+        string_view value;
+    };
+    constexpr NamedEntity namedEntities[] = {
+        { "amp", "&" }, { "lt", "<" }, { "gt", ">" }, { "quot", "\"" }, { "apos", "'" }, { "nbsp", " " },
+        { "auml", "\xC3\xA4" }, { "ouml", "\xC3\xB6" }, { "uuml", "\xC3\xBC" }, { "Auml", "\xC3\x84" },
+        { "Ouml", "\xC3\x96" }, { "Uuml", "\xC3\x9C" }, { "szlig", "\xC3\x9F" }, { "ndash", "-" }, { "mdash", "-" },
+        { "hellip", "..." }, { "laquo", "\xC2\xAB" }, { "raquo", "\xC2\xBB" }, { "bdquo", "\"" }, { "ldquo", "\"" }, { "rdquo", "\"" },
+        { "lsquo", "'" }, { "rsquo", "'" }, { "shy", "" }
+    };
+
+    /// [intern] A-Z zu a-z, wie toLowerCase
+    inline char lowerAscii(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+    inline bool isAsciiLetter(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    inline bool isAsciiDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    /**
+    * [intern]
+    * Hängt einen Unicode Code Point als UTF-8 an out an, ein geschütztes Leerzeichen als ' '
+    */
+    void appendCodePoint(string& out, uint32_t cp)
+    {
+        if (cp == 0xA0)
+            out += ' ';
+        else
+            appendUtf8(out, cp);
+    }
+
+    /**
+    * [intern]
+    * Dekodiert den Namen einer Entity ohne '&' und ';'. Gibt false zurück wenn sie unbekannt oder ungültig ist.
+    */
+    bool decodeEntity(string_view name, string& out)
+    {
+        if (name.size() > 1 && name[0] == '#')
+        {
+            bool hex = (name[1] == 'x' || name[1] == 'X');
+            string_view digits = name.substr(hex ? 2 : 1);
+            if (digits.empty())
+                return false;
+
+            uint32_t cp = 0;
+            for (char c : digits)
+            {
+                uint32_t digit;
+                if (isAsciiDigit(c))
+                    digit = c - '0';
+                else if (hex && lowerAscii(c) >= 'a' && lowerAscii(c) <= 'f')
+                    digit = lowerAscii(c) - 'a' + 10;
+                else
+                    return false;
+
+                cp = cp * (hex ? 16 : 10) + digit;
+                if (cp > 0x10FFFF)
+                    return false;
+            }
+            if (cp == 0)
+                return false;
+
+            appendCodePoint(out, cp);
+            return true;
+        }
+
+        for (const NamedEntity& e : namedEntities)
+        {
+            if (e.name == name)
+            {
+                out += e.value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Siehe Header
+    HtmlStripper::HtmlStripper(textSink sink)
+        : sink(move(sink))
+    {
+    }
+
+    /**
+    * [intern]
+    * Ein Tag ersetzt sich durch ein Leerzeichen, mehrere Tags hintereinander nur durch eins
+    */
+    void HtmlStripper::emitSpace()
+    {
+        if (out.empty() ? !flushedSpace : out.back() != ' ')
+            out += ' ';
+    }
+
+    /**
+    * [intern]
+    * Wird beim '>' eines Tags aufgerufen. Nach <script> und <style> wird bis zum passenden End-Tag alles übersprungen.
+    */
+    void HtmlStripper::endTag()
+    {
+        emitSpace();
+        state = State::text;
+        if (!closingTag)
+        {
+            if (tagName == "script")
+                rawTextEnd = "</script";
+            else if (tagName == "style")
+                rawTextEnd = "</style";
+            else
+                return;
+
+            state = State::rawText;
+            rawTextMatched = 0;
+        }
+    }
+
+    /**
+    * [intern]
+    * Eine Entity wurde mit ';' beendet. Unbekannte Entities bleiben wie sie im Text standen.
+    */
+    void HtmlStripper::endEntity()
+    {
+        if (!decodeEntity(entity, out))
+        {
+            out += '&';
+            out += entity;
+            out += ';';
+        }
+        state = State::text;
+    }
+
+    /**
+    * [intern]
+    * Gibt den Ausgabepuffer an den sink
+    */
+    void HtmlStripper::flush()
+    {
+        if (!out.empty())
+        {
+            flushedSpace = (out.back() == ' ');
+            sink(out);
+            out.clear();
+        }
+    }
+
+    // Siehe Header
+    void HtmlStripper::feed(std::string_view chunk)
+    {
+        const char* p = chunk.data();
+        const char* end = p + chunk.size();
+
+        while (p < end)
+        {
+            if (out.size() >= flushSize)
+                flush();
+
+            switch (state)
+            {
+            case State::text:
+            {
+                // den Text bis zum nächsten '<' oder '&' am Stück kopieren
+                const char* run = p;
+                while (p < end && *p != '<' && *p != '&')
+                    ++p;
+                out.append(run, p - run);
+                if (p < end)
+                {
+                    if (*p == '<')
+                        state = State::tagOpen;
+                    else
+                    {
+                        state = State::entity;
+                        entity.clear();
+                    }
+                    ++p;
+                }
+                break;
+            }
+            case State::tagOpen:
+                closingTag = false;
+                tagName.clear();
+                if (*p == '!')
+                {
+                    state = State::declarationOpen;
+                    dashes = 0;
+                    ++p;
+                }
+                else if (*p == '?')
+                {
+                    state = State::declaration;
+                    ++p;
+                }
+                else if (*p == '/')
+                {
+                    closingTag = true;
+                    state = State::tagName;
+                    ++p;
+                }
+                else if (isAsciiLetter(*p))
+                    state = State::tagName;
+                else
+                {
+                    // kein Tag, z.B. "a < b": das '<' bleibt im Text und das Zeichen wird normal verarbeitet
+                    out += '<';
+                    state = State::text;
+                }
+                break;
+
+            case State::tagName:
+                if (isAsciiLetter(*p) || isAsciiDigit(*p))
+                {
+                    if (tagName.size() < 8)
+                        tagName += lowerAscii(*p);
+                    ++p;
+                }
+                else
+                    state = State::tagBody;
+                break;
+
+            case State::tagBody:
+                if (*p == '>')
+                    endTag();
+                else if (*p == '"' || *p == '\'')
+                {
+                    quote = *p;
+                    state = State::tagQuote;
+                }
+                ++p;
+                break;
+
+            case State::tagQuote:
+            {
+                const void* found = memchr(p, quote, end - p);
+                if (!found)
+                    p = end;
+                else
+                {
+                    p = static_cast<const char*>(found) + 1;
+                    state = State::tagBody;
+                }
+                break;
+            }
+            case State::declarationOpen:
+                // "<!--" beginnt einen Kommentar, alles andere wie <!DOCTYPE> ist eine Deklaration bis '>'
+                if (*p == '-' && dashes < 2)
+                {
+                    if (++dashes == 2)
+                    {
+                        state = State::comment;
+                        dashes = 0;
+                    }
+                    ++p;
+                }
+                else
+                    state = State::declaration;
+                break;
+
+            case State::declaration:
+            {
+                const void* found = memchr(p, '>', end - p);
+                if (!found)
+                    p = end;
+                else
+                {
+                    p = static_cast<const char*>(found) + 1;
+                    emitSpace();
+                    state = State::text;
+                }
+                break;
+            }
+            case State::comment:
+                if (*p == '-')
+                    dashes++;
+                else if (*p == '>' && dashes >= 2)
+                {
+                    emitSpace();
+                    state = State::text;
+                }
+                else
+                    dashes = 0;
+                ++p;
+                break;
+
+            case State::rawText:
+                if (rawTextMatched == 0)
+                {
+                    const void* found = memchr(p, '<', end - p);
+                    if (!found)
+                    {
+                        p = end;
+                        break;
+                    }
+                    p = static_cast<const char*>(found) + 1;
+                    rawTextMatched = 1;
+                }
+                else if (lowerAscii(*p) == rawTextEnd[rawTextMatched])
+                {
+                    ++p;
+                    if (++rawTextMatched == rawTextEnd.size())
+                    {
+                        // das End-Tag wird wie jeder andere Tag bis '>' übersprungen
+                        closingTag = true;
+                        tagName.clear();
+                        state = State::tagBody;
+                    }
+                }
+                else
+                    rawTextMatched = 0;
+                break;
+
+            case State::entity:
+                if (*p == ';')
+                {
+                    endEntity();
+                    ++p;
+                }
+                else if ((isAsciiLetter(*p) || isAsciiDigit(*p) || (*p == '#' && entity.empty())) && entity.size() < maxEntityLength)
+                {
+                    entity += *p;
+                    ++p;
+                }
+                else
+                {
+                    // keine Entity, z.B. "A & B": der Text bleibt unverändert und das Zeichen wird normal verarbeitet
+                    out += '&';
+                    out += entity;
+                    state = State::text;
+                }
+                break;
+            }
+        }
+
+        flush();
+    }
+
+    // Siehe Header
+    void HtmlStripper::finish()
+    {
+        if (state == State::tagOpen)
+            out += '<';
+        else if (state == State::entity)
+        {
+            out += '&';
+            out += entity;
+        }
+        // ein offener Tag, Kommentar oder Script am Ende wird verworfen
+
+        flush();
+        flushedSpace = false;
+        state = State::text;
+        tagName.clear();
+        entity.clear();
+        rawTextMatched = 0;
+    }
+
+    // Siehe Header
+    std::string stripHtml(std::string_view html)
+    {
+        string text;
+        text.reserve(html.size());
+        HtmlStripper stripper([&text](string_view part) { text += part; });
+        stripper.feed(html);
+        stripper.finish();
+        return text;
+    }
+
+    /**
+    * [intern]
+    * Zeichen bei denen die Inline Verarbeitung von Markdown anhält, alle anderen werden am Stück kopiert
+    */
+    constexpr bool isMarkdownSign(char c)
+    {
+        return c == '\\' || c == '`' || c == '!' || c == '[' || c == ']' || c == '*' || c == '_' || c == '~';
+    }
+
+    struct MarkdownSignTable
+    {
+        bool flags[256] = {};
+
+        constexpr MarkdownSignTable()
+        {
+            for (int c = 0; c < 256; ++c)
+                flags[c] = isMarkdownSign(static_cast<char>(c));
+        }
+
+        constexpr bool operator[](char c) const { return flags[static_cast<unsigned char>(c)]; }
+    };
+    constexpr MarkdownSignTable markdownSigns;
+
+    inline bool isAsciiPunct(char c)
+    {
+        return (c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+    }
+
+    inline bool isWordChar(char c)
+    {
+        return isAsciiLetter(c) || isAsciiDigit(c) || static_cast<unsigned char>(c) >= 0x80;
+    }
+
+    /// [intern] Entfernt Leerzeichen und Tabs am Anfang
+    inline string_view trimStart(string_view s)
+    {
+        size_t i = 0;
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\t'))
+            ++i;
+        return s.substr(i);
+    }
+
+    /// [intern] Entfernt Leerzeichen und Tabs am Ende
+    inline string_view trimEnd(string_view s)
+    {
+        size_t n = s.size();
+        while (n > 0 && (s[n - 1] == ' ' || s[n - 1] == '\t'))
+            --n;
+        return s.substr(0, n);
+    }
+
+    /**
+    * [intern]
+    * Gibt die Länge der Markierung zurück wenn die Zeile einen Code Block mit ``` oder ~~~ beginnt bzw. beendet, sonst 0
+    */
+    size_t fenceLengthOf(string_view line, char& fence)
+    {
+        if (line.empty() || (line[0] != '`' && line[0] != '~'))
+            return 0;
+        size_t n = 0;
+        while (n < line.size() && line[n] == line[0])
+            ++n;
+        if (n < 3)
+            return 0;
+        fence = line[0];
+        return n;
+    }
+
+    /**
+    * [intern]
+    * Prüft ob die Zeile eine Trennlinie (---, ***, ___) oder die Unterstreichung einer Überschrift (===, ---) ist
+    */
+    bool isRuleLine(string_view line)
+    {
+        if (line.empty() || (line[0] != '-' && line[0] != '*' && line[0] != '_' && line[0] != '='))
+            return false;
+        size_t count = 0;
+        for (char c : line)
+        {
+            if (c == line[0])
+                count++;
+            else if (c != ' ' && c != '\t')
+                return false;
+        }
+        return count >= 3 || line[0] == '=';
+    }
+
+    /**
+    * [intern]
+    * Entfernt einen Listenpunkt ("- ", "* ", "+ ", "1. ", "1) ") und eine Aufgabenbox ("[ ] ", "[x] ") am Anfang der Zeile
+    */
+    string_view stripListMarker(string_view line)
+    {
+        size_t i = 0;
+        if (!line.empty() && (line[0] == '-' || line[0] == '*' || line[0] == '+'))
+            i = 1;
+        else
+        {
+            while (i < line.size() && i < 9 && isAsciiDigit(line[i]))
+                ++i;
+            if (i == 0 || i >= line.size() || (line[i] != '.' && line[i] != ')'))
+                return line;
+            ++i;
+        }
+        if (i < line.size() && line[i] != ' ' && line[i] != '\t')
+            return line;
+
+        line = trimStart(line.substr(i));
+        if (line.size() >= 3 && line[0] == '[' && (line[1] == ' ' || line[1] == 'x' || line[1] == 'X') && line[2] == ']')
+            line = trimStart(line.substr(3));
+        return line;
+    }
+
+    // Siehe Header
+    MarkdownStripper::MarkdownStripper(textSink sink)
+        : sink(move(sink))
+    {
+    }
+
+    /**
+    * [intern]
+    * Gibt den Ausgabepuffer an den sink
+    */
+    void MarkdownStripper::flush()
+    {
+        if (!out.empty())
+        {
+            sink(out);
+            out.clear();
+        }
+    }
+
+    /**
+    * [intern]
+    * Verarbeitet eine Zeile ohne '\n'. Zuerst die Markierungen am Zeilenanfang, danach der Text mit processInline.
+    */
+    void MarkdownStripper::processLine(std::string_view line, bool lineEnd)
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        string_view content = trimStart(line);
+        char fence = 0;
+        size_t fenceSize = fenceLengthOf(content, fence);
+        if (inFence)
+        {
+            // der Block endet mit der gleichen Markierung, mindestens so lang wie am Anfang und ohne Text danach
+            if (fenceSize >= fenceLength && fence == fenceChar && trimStart(content.substr(fenceSize)).empty())
+                inFence = false;
+        }
+        else if (fenceSize > 0)
+        {
+            inFence = true;
+            fenceChar = fence;
+            fenceLength = fenceSize;
+        }
+        else
+        {
+            // Zitate, auch verschachtelt
+            while (!content.empty() && content[0] == '>')
+                content = trimStart(content.substr(1));
+
+            size_t level = 0;
+            while (level < content.size() && level < 7 && content[level] == '#')
+                ++level;
+            if (level > 0 && level <= 6 && (level == content.size() || content[level] == ' ' || content[level] == '\t'))
+            {
+                // Überschrift, auch mit # am Ende
+                content = trimEnd(content.substr(level));
+                size_t n = content.size();
+                while (n > 0 && content[n - 1] == '#')
+                    --n;
+                if (n == 0 || content[n - 1] == ' ' || content[n - 1] == '\t')
+                    content = trimEnd(content.substr(0, n));
+                processInline(trimStart(content));
+            }
+            else if (!isRuleLine(content))
+                processInline(stripListMarker(content));
+        }
+
+        if (lineEnd)
+            out += '\n';
+    }
+
+    /**
+    * [intern]
+    * Entfernt die Markdown Zeichen innerhalb einer Zeile. Text ohne Markdown Zeichen wird am Stück kopiert.
+    */
+    void MarkdownStripper::processInline(std::string_view text)
+    {
+        size_t i = 0;
+        const size_t n = text.size();
+        // Anzahl der offenen '[' von Links und Bildern
+        int linkDepth = 0;
+
+        while (i < n)
+        {
+            size_t run = i;
+            while (i < n && !markdownSigns[text[i]])
+                ++i;
+            out.append(text.data() + run, i - run);
+            if (i == n)
+                break;
+
+            char c = text[i];
+            switch (c)
+            {
+            case '\\':
+                if (i + 1 < n && isAsciiPunct(text[i + 1]))
+                {
+                    out += text[i + 1];
+                    i += 2;
+                }
+                else
+                    out += text[i++];
+                break;
+
+            case '`':
+            {
+                // Inline Code endet mit einer gleich langen Folge von `, der Inhalt bleibt unverändert
+                size_t ticks = 0;
+                while (i + ticks < n && text[i + ticks] == '`')
+                    ++ticks;
+                size_t start = i + ticks;
+                size_t close = start;
+                while ((close = text.find('`', close)) != string_view::npos)
+                {
+                    size_t closeTicks = 0;
+                    while (close + closeTicks < n && text[close + closeTicks] == '`')
+                        ++closeTicks;
+                    if (closeTicks == ticks)
+                        break;
+                    close += closeTicks;
+                }
+
+                if (close == string_view::npos)
+                    i = start;
+                else
+                {
+                    out.append(text.data() + start, close - start);
+                    i = close + ticks;
+                }
+                break;
+            }
+            case '!':
+                // bei Bildern bleibt der Alt Text
+                if (i + 1 < n && text[i + 1] == '[')
+                {
+                    linkDepth++;
+                    i += 2;
+                }
+                else
+                    out += text[i++];
+                break;
+
+            case '[':
+                linkDepth++;
+                ++i;
+                break;
+
+            case ']':
+                ++i;
+                if (linkDepth == 0)
+                {
+                    out += ']';
+                    break;
+                }
+                linkDepth--;
+                if (i < n && text[i] == '(')
+                {
+                    // die Adresse wird übersprungen, Klammern in der Adresse werden mitgezählt
+                    int depth = 0;
+                    for (; i < n; ++i)
+                    {
+                        if (text[i] == '(')
+                            depth++;
+                        else if (text[i] == ')' && --depth == 0)
+                        {
+                            ++i;
+                            break;
+                        }
+                    }
+                }
+                else if (i < n && text[i] == '[')
+                {
+                    size_t close = text.find(']', i);
+                    i = (close == string_view::npos) ? n : close + 1;
+                }
+                break;
+
+            case '_':
+                // ein _ innerhalb eines Wortes gehört zum Wort, z.B. snake_case
+                if (i > 0 && i + 1 < n && isWordChar(text[i - 1]) && isWordChar(text[i + 1]))
+                    out += '_';
+                ++i;
+                break;
+
+            default:
+                // * und ~ für Hervorhebungen und Durchstreichen
+                ++i;
+                break;
+            }
+        }
+    }
+
+    // Siehe Header
+    void MarkdownStripper::feed(std::string_view chunk)
+    {
+        while (!chunk.empty())
+        {
+            const void* found = memchr(chunk.data(), '\n', chunk.size());
+            if (!found)
+            {
+                pending.append(chunk.data(), chunk.size());
+                break;
+            }
+
+            size_t lineEnd = static_cast<const char*>(found) - chunk.data();
+            if (pending.empty())
+                processLine(chunk.substr(0, lineEnd), true);
+            else
+            {
+                pending.append(chunk.data(), lineEnd);
+                processLine(pending, true);
+                pending.clear();
+            }
+            chunk.remove_prefix(lineEnd + 1);
+
+            if (out.size() >= flushSize)
+                flush();
+        }
+
+        flush();
+    }
+
+    // Siehe Header
+    void MarkdownStripper::finish()
+    {
+        if (!pending.empty())
+            processLine(pending, false);
+
+        flush();
+        pending.clear();
+        inFence = false;
+    }
+
+    // Siehe Header
+    std::string stripMarkdown(std::string_view markdown)
+    {
+        string text;
+        text.reserve(markdown.size());
+        MarkdownStripper stripper([&text](string_view part) { text += part; });
+        stripper.feed(markdown);
+        stripper.finish();
+        return text;
+    }
+
+    // Siehe Header
+    CleanupPipeline::CleanupPipeline(cleanupType type, textSink sink)
+        : type(type), sink(move(sink))
+    {
+        toSpace[static_cast<unsigned char>('\n')] = true;
+        if (type & removeAllSigns)
+        {
+            for (char c : string_view(",.!?-"))
+                toSpace[static_cast<unsigned char>(c)] = true;
+        }
+
+        if (type & Markdown)
+            markdown.emplace([this](string_view part) { collapse(part); });
+        if (type & HTML)
+            html.emplace([this](string_view part) { feedMarkup(part); });
+    }
+
+    /**
+    * [intern]
+    * Gibt einen Teil an die Markdown Stufe, falls sie aktiv ist, sonst direkt an collapse
+    */
+    void CleanupPipeline::feedMarkup(std::string_view chunk)
+    {
+        if (markdown)
+            markdown->feed(chunk);
+        else
+            collapse(chunk);
+    }
+
+    /**
+    * [intern]
+    * Die letzte Stufe: ersetzt Zeilenumbrüche und Zeichen durch Leerzeichen und fasst Leerzeichen zusammen, in einem Durchlauf
+    */
+    void CleanupPipeline::collapse(std::string_view chunk)
+    {
+        out.resize(chunk.size());
+        char* dest = out.data();
+        bool space = lastSpace;
+        for (char c : chunk)
+        {
+            if (toSpace[static_cast<unsigned char>(c)])
+                c = ' ';
+            if (c == ' ' && space)
+                continue;
+            *dest++ = c;
+            space = (c == ' ');
+        }
+        lastSpace = space;
+
+        size_t size = dest - out.data();
+        if (size > 0)
+            sink(string_view(out.data(), size));
+    }
+
+    // Siehe Header
+    void CleanupPipeline::feed(std::string_view chunk)
+    {
+        if (type == None)
+            sink(chunk);
+        else if (html)
+            html->feed(chunk);
+        else
+            feedMarkup(chunk);
+    }
+
+    // Siehe Header
+    void CleanupPipeline::finish()
+    {
+        if (html)
+            html->finish();
+        if (markdown)
+            markdown->finish();
+        lastSpace = false;
+    }
+}
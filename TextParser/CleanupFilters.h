@@ -0,0 +1,193 @@
+/**
+* CleanupFilters.h
+*
+* Filter die Auszeichnungen aus einem Text entfernen, bevor er analysiert wird. Jeder Filter läuft in einem
+* einzigen Durchlauf über den Text, bekommt ihn in beliebigen Teilen und gibt den Klartext an einen textSink weiter,
+* z.B. direkt an einen StreamAnalyser.
+*/
+#pragma once
+#ifndef TEXTANALYSER_CLEANUPFILTERS
+#define TEXTANALYSER_CLEANUPFILTERS
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace AnalyserLib
+{
+	/**
+	* Bekommt den Klartext eines Filters in Teilen. Der string_view ist nur während des Aufrufs gültig.
+	*/
+	using textSink = std::function<void(std::string_view)>;
+
+	/**
+	* Enum zum einstellen mit welcher methode der Text aufgeräumt werden soll. Die Werte können mit | kombiniert werden.
+	*/
+	enum cleanupType
+	{
+		None = 0,
+		plain = 1,
+		removeAllSigns = 2,
+		HTML = 4,
+		Markdown = 8
+	};
+
+	constexpr cleanupType operator|(cleanupType lhs, cleanupType rhs)
+	{
+		return static_cast<cleanupType>(static_cast<int>(lhs) | static_cast<int>(rhs));
+	}
+
+	/**
+	* Entfernt HTML Tags mit einem Zustandsautomaten in linearer Zeit. Der Inhalt von <script> und <style> sowie
+	* Kommentare und Deklarationen werden übersprungen, jeder Tag wird durch ein Leerzeichen ersetzt.
+	* Entities wie &amp; &lt; &auml; oder &#228; werden dekodiert und als UTF-8 ausgegeben, passend zu UTF-8 Seiten
+	* (&nbsp; wird ein Leerzeichen). Fehlerhaftes HTML wird nie mit einer Exception abgebrochen:
+	* ein einzelnes '<' ohne Tag bleibt im Text, unbekannte Entities bleiben unverändert und ein offener Tag am Ende wird verworfen.
+	*/
+	class HtmlStripper
+	{
+	public:
+		/**
+		* @param	sink: Bekommt den Klartext, höchstens einmal pro feed Aufruf bzw. pro 64 KB
+		*/
+		explicit HtmlStripper(textSink sink);
+
+		/**
+		* Verarbeitet den nächsten Teil des HTML Textes. Der Teil darf mitten in einem Tag oder einer Entity enden.
+		*/
+		void feed(std::string_view chunk);
+
+		/**
+		* Beendet den Text und gibt den Rest an den sink. Danach kann ein neuer Text mit feed begonnen werden.
+		*/
+		void finish();
+
+	private:
+		enum class State { text, tagOpen, tagName, tagBody, tagQuote, declarationOpen, declaration, comment, rawText, entity };
+
+		void endTag();
+		void endEntity();
+		void emitSpace();
+		void flush();
+
+		textSink sink;
+		std::string out;
+		/// ob das letzte Zeichen vor out ein Leerzeichen war
+		bool flushedSpace = false;
+		State state = State::text;
+		/// Name des aktuellen Tags in lowercase, nur die ersten Zeichen werden gebraucht
+		std::string tagName;
+		bool closingTag = false;
+		char quote = 0;
+		/// Anzahl der '-' am Anfang einer Deklaration bzw. vor dem Ende eines Kommentars
+		int dashes = 0;
+		/// das End-Tag für script bzw. style und wie viele Zeichen davon schon gefunden wurden
+		std::string_view rawTextEnd;
+		size_t rawTextMatched = 0;
+		std::string entity;
+	};
+
+	/**
+	* Entfernt alle HTML Tags aus einem Text, siehe HtmlStripper
+	*
+	* @param	html: Der HTML Text
+	* @return	Gibt den Klartext zurück
+	*/
+	std::string stripHtml(std::string_view html);
+	/**
+	* Wandelt Markdown in einem Durchlauf in Klartext um. Entfernt werden Überschriften- und Zitatzeichen, Listenpunkte,
+	* Trennlinien, Hervorhebungen mit * _ und ~, Backslash Escapes sowie die Adressen von Links und Bildern,
+	* von denen nur der Text bzw. der Alt Text bleibt. Inline Code bleibt als Text erhalten, Code Blöcke mit ``` oder ~~~
+	* werden übersprungen. Zeilenumbrüche bleiben erhalten. Ein Teil wird Zeile für Zeile verarbeitet, gespeichert wird
+	* nur die angefangene Zeile am Ende eines Teils.
+	*/
+	class MarkdownStripper
+	{
+	public:
+		/**
+		* @param	sink: Bekommt den Klartext, höchstens einmal pro feed Aufruf bzw. pro 64 KB
+		*/
+		explicit MarkdownStripper(textSink sink);
+
+		/**
+		* Verarbeitet den nächsten Teil des Markdown Textes. Der Teil darf mitten in einer Zeile enden.
+		*/
+		void feed(std::string_view chunk);
+
+		/**
+		* Beendet den Text und gibt den Rest an den sink. Danach kann ein neuer Text mit feed begonnen werden.
+		*/
+		void finish();
+
+	private:
+		void processLine(std::string_view line, bool lineEnd);
+		void processInline(std::string_view text);
+		void flush();
+
+		textSink sink;
+		std::string out;
+		/// die angefangene Zeile vom Ende des letzten Teils
+		std::string pending;
+		/// ob gerade ein Code Block offen ist, mit dem Zeichen und der Länge seiner Markierung
+		bool inFence = false;
+		char fenceChar = 0;
+		size_t fenceLength = 0;
+	};
+
+	/**
+	* Wandelt einen Markdown Text in Klartext um, siehe MarkdownStripper
+	*
+	* @param	markdown: Der Markdown Text
+	* @return	Gibt den Klartext zurück
+	*/
+	std::string stripMarkdown(std::string_view markdown);
+
+	/**
+	* Räumt einen Text mit allen Methoden aus einem cleanupType auf, ohne Zwischenkopien des ganzen Textes.
+	* Jeder Teil läuft zuerst durch den HtmlStripper, dann durch den MarkdownStripper (falls gesetzt) und zuletzt durch
+	* einen einzigen Durchlauf der Zeilenumbrüche und mit removeAllSigns die Zeichen ,.!?- durch Leerzeichen ersetzt
+	* und mehrere Leerzeichen zu einem zusammenfasst. Mit None wird der Text unverändert weitergegeben.
+	*
+	* Beispiel:	CleanupPipeline pipeline(HTML | removeAllSigns, [&](std::string_view part) { analyser.feed(part); });
+	*/
+	class CleanupPipeline
+	{
+	public:
+		/**
+		* @param	type: Kombination aus cleanupType Werten
+		*			sink: Bekommt den aufgeräumten Text, höchstens einmal pro feed Aufruf bzw. pro 64 KB
+		*/
+		CleanupPipeline(cleanupType type, textSink sink);
+
+		/// Die Stufen zeigen auf die Pipeline, sie kann deshalb nicht kopiert oder verschoben werden
+		CleanupPipeline(const CleanupPipeline&) = delete;
+		CleanupPipeline& operator=(const CleanupPipeline&) = delete;
+
+		/**
+		* Verarbeitet den nächsten Teil des Textes. Der Teil darf an jeder Stelle enden.
+		*/
+		void feed(std::string_view chunk);
+
+		/**
+		* Beendet den Text und gibt den Rest an den sink. Danach kann ein neuer Text mit feed begonnen werden.
+		*/
+		void finish();
+
+	private:
+		void feedMarkup(std::string_view chunk);
+		void collapse(std::string_view chunk);
+
+		cleanupType type;
+		textSink sink;
+		std::optional<HtmlStripper> html;
+		std::optional<MarkdownStripper> markdown;
+		/// Zeichen die zu einem Leerzeichen werden
+		bool toSpace[256] = {};
+		std::string out;
+		/// ob das letzte weitergegebene Zeichen ein Leerzeichen war
+		bool lastSpace = false;
+	};
+}
+
+#endif // !TEXTANALYSER_CLEANUPFILTERS
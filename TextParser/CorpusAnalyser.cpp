@@ -0,0 +1,567 @@
+#include "CorpusAnalyser.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /**
+    * [intern]
+    * Eine ganze Datei oder ein Teil einer großen Datei. begin und end sind die ungefähren Grenzen, die genauen
+    * werden beim Laden am nächsten Satzende gesucht. Der letzte Teil einer Datei geht bis zum Ende (end = UINT64_MAX).
+    */
+    struct CorpusPart
+    {
+        size_t document;
+        size_t part;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /// [intern] Teile die zusammen geladen und analysiert werden
+    struct CorpusBatch
+    {
+        vector<CorpusPart> parts;
+        uint64_t bytes = 0;
+    };
+
+    /// [intern] Ein geladener und aufgeräumter Teil
+    struct LoadedPart
+    {
+        CorpusPart part;
+        bool ok = false;
+        /// der letzte Buchstabe vor dem Teil ist ein Vokal, für die Silben
+        bool lastVowel = false;
+        string text;
+    };
+
+    /// [intern] Ein geladenes Paket, bytes ist der Anteil am Budget
+    struct LoadedBatch
+    {
+        vector<LoadedPart> parts;
+        uint64_t bytes = 0;
+    };
+
+    /**
+    * [intern]
+    * Addiert die Einträge einer map. Aus einer temporären map werden neue Einträge ohne Kopie umgehängt.
+    */
+    template<class Map>
+    void addCounts(Map& into, const Map& from)
+    {
+        for (const auto& [key, count] : from)
+            into[key] += count;
+    }
+
+    template<class Map>
+    void addCounts(Map& into, Map&& from)
+    {
+        if (into.size() < from.size())
+            into.swap(from);
+        while (!from.empty())
+        {
+            auto node = from.extract(from.begin());
+            auto found = into.find(node.key());
+            if (found != into.end())
+                found->second += node.mapped();
+            else
+                into.insert(move(node));
+        }
+    }
+
+    /// [intern] Addiert die Stats
+    static void addStats(Stats& into, const Stats& from)
+    {
+        into.letters += from.letters;
+        into.words += from.words;
+        into.sentense += from.sentense;
+        into.syllable += from.syllable;
+    }
+
+    // Siehe Header
+    void mergeAnalysisResult(AnalysisResult& into, const AnalysisResult& from)
+    {
+        addStats(into.stats, from.stats);
+        addCounts(into.wordLengths, from.wordLengths);
+        addCounts(into.words, from.words);
+        addCounts(into.pairs, from.pairs);
+    }
+
+    // Siehe Header
+    void mergeAnalysisResult(AnalysisResult& into, AnalysisResult&& from)
+    {
+        addStats(into.stats, from.stats);
+        addCounts(into.wordLengths, move(from.wordLengths));
+        addCounts(into.words, move(from.words));
+        addCounts(into.pairs, move(from.pairs));
+    }
+
+    /// [intern] Entfernt alle Paare die seltener als minOccurrences vorkommen
+    static void prunePairs(wordPairs& pairs, int minOccurrences)
+    {
+        if (minOccurrences <= 1)
+            return;
+        for (auto it = pairs.begin(); it != pairs.end();)
+        {
+            if (it->second < minOccurrences)
+                it = pairs.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    /**
+    * [intern]
+    * Sucht ab pos die Grenze für einen Teil: direkt nach einem Satzende dem ein Leerzeichen oder Zeilenende folgt.
+    * Wortpaare gehen nie über ein Satzende hinweg, die Teile können also unabhängig analysiert werden.
+    */
+    static size_t findPartBound(string_view content, uint64_t pos, const CharTable& table)
+    {
+        const unsigned char bound = charWordEnd | charSentenceEnd;
+        for (size_t i = static_cast<size_t>(min<uint64_t>(pos, content.size())); i + 1 < content.size(); ++i)
+        {
+            char next = content[i + 1];
+            if ((table[content[i]] & (bound | charLetter)) == bound && (next == ' ' || next == '\n' || next == '\r'))
+                return i + 1;
+        }
+        return content.size();
+    }
+
+    /// [intern] Prüft ob der letzte Buchstabe vor end ein Vokal ist
+    static bool letterBeforeIsVowel(string_view text, size_t end, const CharTable& table)
+    {
+        for (size_t i = end; i > 0; --i)
+        {
+            unsigned char flags = table[text[i - 1]];
+            if (flags & charLetter)
+                return (flags & charVowel) != 0;
+        }
+        return false;
+    }
+
+    /// [intern] Prüft ob der erste Buchstabe ein Vokal ist
+    static bool firstLetterIsVowel(string_view text, const CharTable& table)
+    {
+        for (char c : text)
+        {
+            unsigned char flags = table[c];
+            if (flags & charLetter)
+                return (flags & charVowel) != 0;
+        }
+        return false;
+    }
+
+    /**
+    * [intern]
+    * Teilt die Dateien in Pakete ein. Große Dateien werden zerlegt, kleine zusammengefasst.
+    * Die größten Pakete kommen zuerst, damit am Ende keine große Datei allein übrig bleibt.
+    */
+    static vector<CorpusBatch> planBatches(vector<DocumentResult>& documents, vector<size_t>& partCounts, const CorpusOptions& options)
+    {
+        const uint64_t splitSize = max<uint64_t>(options.splitSize, 1);
+        vector<CorpusBatch> batches;
+        CorpusBatch small;
+        for (size_t d = 0; d < documents.size(); ++d)
+        {
+            // Dateien deren Größe unbekannt ist werden trotzdem versucht, das Laden meldet dann den Fehler
+            error_code error;
+            uint64_t size = filesystem::file_size(documents[d].path, error);
+            documents[d].size = error ? 0 : size;
+            size = documents[d].size;
+
+            if (size > splitSize)
+            {
+                size_t count = static_cast<size_t>((size + splitSize - 1) / splitSize);
+                partCounts[d] = count;
+                for (size_t k = 0; k < count; ++k)
+                {
+                    CorpusBatch batch;
+                    uint64_t end = (k + 1 == count) ? UINT64_MAX : (k + 1) * splitSize;
+                    batch.parts.push_back({ d, k, k * splitSize, end });
+                    batch.bytes = min(size, (k + 1) * splitSize) - k * splitSize;
+                    batches.push_back(move(batch));
+                }
+                continue;
+            }
+
+            partCounts[d] = 1;
+            if (!small.parts.empty() && small.bytes + size > options.batchSize)
+            {
+                batches.push_back(move(small));
+                small = CorpusBatch();
+            }
+            small.parts.push_back({ d, 0, 0, UINT64_MAX });
+            small.bytes += size;
+        }
+        if (!small.parts.empty())
+            batches.push_back(move(small));
+
+        stable_sort(batches.begin(), batches.end(), [](const CorpusBatch& a, const CorpusBatch& b) { return a.bytes > b.bytes; });
+        return batches;
+    }
+
+    /**
+    * [intern]
+    * Der Zustand eines analyseCorpus Aufrufs. Jeder Worker hat eine Warteschlange mit geladenen Paketen. Er nimmt
+    * zuerst aus seiner eigenen (die zuletzt geladenen, deren Text noch im Cache liegt), dann stiehlt er das älteste
+    * Paket eines anderen Workers und erst wenn es nichts zu analysieren gibt lädt er das nächste Paket.
+    * Das Laden wartet solange die geladenen Byte das Budget überschreiten würden.
+    */
+    class CorpusRun
+    {
+    public:
+        CorpusRun(constStringList& paths, const CorpusOptions& options, size_t workerCount)
+            : options(options), table(makeCharTable(options.analysis.wordEnd, options.analysis.sentenceEnd)),
+            queues(workerCount), totals(workerCount)
+        {
+            partOptions = options.analysis;
+            // minOccurrences gilt erst für das ganze Dokument, nicht für die einzelnen Teile
+            if (partOptions.minOccurrences > 1)
+                partOptions.minOccurrences = 1;
+
+            result.documents.resize(paths.size());
+            for (size_t d = 0; d < paths.size(); ++d)
+                result.documents[d].path = paths[d];
+
+            vector<size_t> partCounts(paths.size());
+            batches = planBatches(result.documents, partCounts, options);
+            documents = vector<DocumentState>(paths.size());
+            for (size_t d = 0; d < paths.size(); ++d)
+            {
+                documents[d].parts.resize(partCounts[d]);
+                documents[d].remaining = partCounts[d];
+            }
+        }
+
+        /**
+        * Die Schleife eines Workers, endet wenn es nichts mehr zu laden und zu analysieren gibt
+        */
+        void work(size_t worker)
+        {
+            try
+            {
+                for (;;)
+                {
+                    LoadedBatch loaded;
+                    if (take(worker, loaded))
+                    {
+                        analyse(worker, loaded);
+                        release(loaded.bytes);
+                        continue;
+                    }
+
+                    size_t index = 0;
+                    loadState state = reserveLoad(index);
+                    if (state == loadState::finished)
+                        return;
+                    if (state == loadState::load)
+                        push(worker, load(batches[index]));
+                }
+            }
+            catch (...)
+            {
+                {
+                    lock_guard<mutex> lock(budgetMutex);
+                    aborted = true;
+                }
+                budgetChanged.notify_all();
+                throw;
+            }
+        }
+
+        /**
+        * Führt die Summen der Worker zusammen und wendet minOccurrences an
+        */
+        CorpusResult finish()
+        {
+            for (AnalysisResult& total : totals)
+                mergeAnalysisResult(result.total, move(total));
+            prunePairs(result.total.pairs, options.analysis.minOccurrences);
+
+            for (const DocumentResult& document : result.documents)
+            {
+                result.bytes += document.size;
+                if (!document.ok)
+                    result.failed++;
+            }
+            result.peakBytesInFlight = peakInFlight;
+            return move(result);
+        }
+
+    private:
+        enum class loadState
+        {
+            load,
+            /// es gibt geladene Pakete zum Stehlen
+            retry,
+            finished
+        };
+
+        struct WorkerQueue
+        {
+            mutex queueMutex;
+            deque<LoadedBatch> batches;
+        };
+
+        struct DocumentState
+        {
+            vector<AnalysisResult> parts;
+            atomic<size_t> remaining{ 0 };
+            atomic<bool> failed{ false };
+
+            DocumentState() = default;
+            DocumentState(DocumentState&& other) noexcept
+                : parts(move(other.parts)), remaining(other.remaining.load()), failed(other.failed.load())
+            {
+            }
+            DocumentState& operator=(DocumentState&& other) noexcept
+            {
+                parts = move(other.parts);
+                remaining = other.remaining.load();
+                failed = other.failed.load();
+                return *this;
+            }
+        };
+
+        /// Nimmt das neueste Paket aus der eigenen Warteschlange oder das älteste aus einer anderen
+        bool take(size_t worker, LoadedBatch& loaded)
+        {
+            for (size_t i = 0; i < queues.size(); ++i)
+            {
+                size_t victim = (worker + i) % queues.size();
+                WorkerQueue& queue = queues[victim];
+                {
+                    lock_guard<mutex> lock(queue.queueMutex);
+                    if (queue.batches.empty())
+                        continue;
+                    if (victim == worker)
+                    {
+                        loaded = move(queue.batches.back());
+                        queue.batches.pop_back();
+                    }
+                    else
+                    {
+                        loaded = move(queue.batches.front());
+                        queue.batches.pop_front();
+                    }
+                }
+                lock_guard<mutex> lock(budgetMutex);
+                queued--;
+                return true;
+            }
+            return false;
+        }
+
+        void push(size_t worker, LoadedBatch&& loaded)
+        {
+            // erst zählen, damit kein anderer Worker aufhört solange das Paket noch nicht in der Warteschlange liegt
+            {
+                lock_guard<mutex> lock(budgetMutex);
+                queued++;
+            }
+            {
+                lock_guard<mutex> lock(queues[worker].queueMutex);
+                queues[worker].batches.push_back(move(loaded));
+            }
+            budgetChanged.notify_all();
+        }
+
+        /// Reserviert das nächste Paket zum Laden und seine Byte im Budget
+        loadState reserveLoad(size_t& index)
+        {
+            unique_lock<mutex> lock(budgetMutex);
+            for (;;)
+            {
+                if (aborted)
+                    return loadState::finished;
+                if (nextBatch >= batches.size())
+                    return queued > 0 ? loadState::retry : loadState::finished;
+
+                uint64_t bytes = batches[nextBatch].bytes;
+                if (inFlight == 0 || inFlight + bytes <= options.maxBytesInFlight)
+                {
+                    index = nextBatch++;
+                    inFlight += bytes;
+                    peakInFlight = max(peakInFlight, inFlight);
+                    return loadState::load;
+                }
+                if (queued > 0)
+                    return loadState::retry;
+                budgetChanged.wait(lock);
+            }
+        }
+
+        void release(uint64_t bytes)
+        {
+            {
+                lock_guard<mutex> lock(budgetMutex);
+                inFlight -= bytes;
+            }
+            budgetChanged.notify_all();
+        }
+
+        /// Liest und räumt alle Teile eines Pakets auf
+        LoadedBatch load(const CorpusBatch& batch)
+        {
+            LoadedBatch loaded;
+            loaded.bytes = batch.bytes;
+            for (const CorpusPart& part : batch.parts)
+            {
+                LoadedPart& target = loaded.parts.emplace_back();
+                target.part = part;
+
+                MappedFile file(result.documents[part.document].path);
+                if (!file.isOpen())
+                    continue;
+                target.ok = true;
+
+                string_view content = file.view();
+                size_t begin = part.begin == 0 ? 0 : findPartBound(content, part.begin, table);
+                size_t end = part.end == UINT64_MAX ? content.size() : findPartBound(content, part.end, table);
+                if (begin >= end)
+                    continue;
+
+                target.lastVowel = letterBeforeIsVowel(content, begin, table);
+                target.text.reserve(end - begin);
+                appendWithUnixNewlines(target.text, content.substr(begin, end - begin));
+                cleanUpText(target.text, options.cleanup);
+            }
+            return loaded;
+        }
+
+        /// Analysiert alle Teile eines Pakets, ist ein Dokument vollständig wird es abgeschlossen
+        void analyse(size_t worker, LoadedBatch& loaded)
+        {
+            for (LoadedPart& part : loaded.parts)
+            {
+                DocumentState& document = documents[part.part.document];
+                if (!part.ok)
+                {
+                    document.failed = true;
+                }
+                else
+                {
+                    AnalysisResult& partResult = document.parts[part.part.part];
+                    partResult = analyseText(part.text, options.metrics, partOptions);
+                    // analyseText beginnt ohne Vokal davor, die erste Silbe wäre dann zu viel gezählt
+                    if ((options.metrics & metricStats) && part.lastVowel && firstLetterIsVowel(part.text, table))
+                        partResult.stats.syllable--;
+                }
+                part.text = string();
+
+                if (document.remaining.fetch_sub(1) == 1)
+                    finishDocument(worker, part.part.document);
+            }
+        }
+
+        /// Führt die Teile eines Dokuments zusammen und addiert es zur Summe des Workers
+        void finishDocument(size_t worker, size_t index)
+        {
+            DocumentState& document = documents[index];
+            DocumentResult& target = result.documents[index];
+            if (document.failed)
+            {
+                document.parts.clear();
+                return;
+            }
+
+            target.ok = true;
+            target.result = move(document.parts[0]);
+            for (size_t k = 1; k < document.parts.size(); ++k)
+                mergeAnalysisResult(target.result, move(document.parts[k]));
+            document.parts.clear();
+
+            // die Summe bekommt die ungefilterten Paare, minOccurrences gilt dort erst am Ende
+            if (options.keepDocumentResults)
+            {
+                mergeAnalysisResult(totals[worker], target.result);
+                prunePairs(target.result.pairs, options.analysis.minOccurrences);
+            }
+            else
+            {
+                Stats stats = target.result.stats;
+                mergeAnalysisResult(totals[worker], move(target.result));
+                target.result = AnalysisResult();
+                target.result.stats = stats;
+            }
+        }
+
+        const CorpusOptions& options;
+        AnalysisOptions partOptions;
+        CharTable table;
+        CorpusResult result;
+        vector<CorpusBatch> batches;
+        vector<DocumentState> documents;
+        vector<WorkerQueue> queues;
+        vector<AnalysisResult> totals;
+
+        /// schützt alles darunter
+        mutex budgetMutex;
+        condition_variable budgetChanged;
+        size_t nextBatch = 0;
+        /// Anzahl der geladenen Pakete in den Warteschlangen
+        size_t queued = 0;
+        uint64_t inFlight = 0;
+        uint64_t peakInFlight = 0;
+        bool aborted = false;
+    };
+
+    // Siehe Header
+    CorpusResult analyseCorpus(constStringList& paths, const CorpusOptions& options)
+    {
+        shared_ptr<ThreadPool> pool = getThreadPool();
+        size_t workerCount = max<size_t>(1, min<size_t>(pool->concurrency(), paths.size()));
+        CorpusRun run(paths, options, workerCount);
+        pool->parallelFor(workerCount, [&run](size_t worker) { run.work(worker); });
+        return run.finish();
+    }
+
+    // Siehe Header
+    CorpusResult analyseCorpusDirectory(const std::string& directory, const CorpusOptions& options, constStringList& extensions, bool recursive)
+    {
+        return analyseCorpus(listCorpusFiles(directory, extensions, recursive), options);
+    }
+
+    /// [intern] Prüft die Endung einer Datei
+    static bool hasExtension(const filesystem::path& path, constStringList& extensions)
+    {
+        if (extensions.empty())
+            return true;
+        string extension = path.extension().string();
+        return find(extensions.begin(), extensions.end(), extension) != extensions.end();
+    }
+
+    // Siehe Header
+    stringList listCorpusFiles(const std::string& directory, constStringList& extensions, bool recursive)
+    {
+        stringList files;
+        error_code error;
+        if (!filesystem::is_directory(directory, error))
+            return files;
+
+        auto add = [&](const filesystem::directory_entry& entry)
+            {
+                if (entry.is_regular_file(error) && hasExtension(entry.path(), extensions))
+                    files.push_back(entry.path().string());
+            };
+        if (recursive)
+        {
+            for (const auto& entry : filesystem::recursive_directory_iterator(directory, filesystem::directory_options::skip_permission_denied, error))
+                add(entry);
+        }
+        else
+        {
+            for (const auto& entry : filesystem::directory_iterator(directory, error))
+                add(entry);
+        }
+        sort(files.begin(), files.end());
+        return files;
+    }
+}
@@ -0,0 +1,106 @@
+/**
+* CorpusAnalyser.h
+*
+* Analysiert viele Dateien auf einmal. Die Dateien werden vorher nach Größe eingeteilt: große Dateien werden an
+* Satzenden in Teile zerlegt, kleine Dateien zu Paketen zusammengefasst. Jeder Thread hat eine eigene Warteschlange
+* mit geladenen Paketen, ist sie leer nimmt er sich Arbeit aus den Warteschlangen der anderen (work stealing).
+* Laden, Aufräumen und Analysieren laufen so in verschiedenen Threads gleichzeitig.
+*/
+#pragma once
+#ifndef TEXTANALYSER_CORPUSANALYSER
+#define TEXTANALYSER_CORPUSANALYSER
+
+#include "TextAnalyser.h"
+#include <cstdint>
+
+namespace AnalyserLib
+{
+	/**
+	* Einstellungen für analyseCorpus
+	*/
+	struct CorpusOptions
+	{
+		/// Kombination aus analysisMetric Werten, siehe analyseText
+		int metrics = metricAll;
+		/// Trennzeichen und Einstellungen für Wortverteilung und Wortpaare. minOccurrences gilt für das Ergebnis jedes
+		/// Dokuments und für die Summe, nicht für die einzelnen Teile einer Datei.
+		AnalysisOptions analysis;
+		/// wie bei readFile
+		cleanupType cleanup = cleanupType::plain;
+		/// Dateien die größer sind werden in Teile von etwa dieser Größe zerlegt
+		std::uint64_t splitSize = 8 << 20;
+		/// kleinere Dateien werden zu Paketen bis zu dieser Größe zusammengefasst
+		std::uint64_t batchSize = 1 << 20;
+		/// höchstens so viele Byte sind gleichzeitig geladen aber noch nicht fertig analysiert. Ein einzelnes Paket
+		/// wird auch geladen wenn es größer ist.
+		std::uint64_t maxBytesInFlight = 256 << 20;
+		/// false: von den Dokumenten werden nur die Stats behalten, das spart bei vielen Dateien viel Speicher
+		bool keepDocumentResults = true;
+	};
+
+	/**
+	* Das Ergebnis einer Datei
+	*/
+	struct DocumentResult
+	{
+		std::string path;
+		/// Größe der Datei in Byte
+		std::uint64_t size = 0;
+		/// false wenn die Datei nicht gelesen werden konnte
+		bool ok = false;
+		AnalysisResult result;
+	};
+
+	/**
+	* Das Ergebnis von analyseCorpus
+	*/
+	struct CorpusResult
+	{
+		/// in der Reihenfolge der übergebenen Pfade
+		std::vector<DocumentResult> documents;
+		/// alle Dokumente zusammen, als wäre es ein einziger Text in dem jedes Dokument mit einem Satzende beginnt
+		AnalysisResult total;
+		/// Summe der Dateigrößen
+		std::uint64_t bytes = 0;
+		/// Anzahl der Dateien die nicht gelesen werden konnten
+		size_t failed = 0;
+		/// die meisten Byte die gleichzeitig geladen waren
+		std::uint64_t peakBytesInFlight = 0;
+	};
+
+	/**
+	* Analysiert alle Dateien im Thread Pool der Async Funktionen (siehe setThreadCount).
+	* Ohne cleanup ist das Ergebnis jeder Datei identisch zu analyseText über den Inhalt der Datei, mit cleanup kann
+	* es bei zerlegten Dateien an den Grenzen der Teile minimal abweichen (z.B. bei einem Codeblock über die Grenze).
+	*
+	* @param	paths: Die Dateien
+	*			options: siehe CorpusOptions
+	* @return	Gibt die Ergebnisse jeder Datei und die Summe zurück
+	*/
+	CorpusResult analyseCorpus(constStringList& paths, const CorpusOptions& options = CorpusOptions());
+
+	/**
+	* Analysiert alle Dateien in einem Verzeichnis, siehe listCorpusFiles und analyseCorpus
+	*/
+	CorpusResult analyseCorpusDirectory(const std::string& directory, const CorpusOptions& options = CorpusOptions(),
+		constStringList& extensions = stringList(), bool recursive = true);
+
+	/**
+	* Sucht alle Dateien in einem Verzeichnis
+	*
+	* @param	directory: Das Verzeichnis
+	*			extensions: Erlaubte Endungen wie ".txt", leer für alle Dateien
+	*			recursive (default = true): auch in Unterverzeichnissen suchen
+	* @return	Gibt die Pfade sortiert zurück, leer wenn es das Verzeichnis nicht gibt
+	*/
+	stringList listCorpusFiles(const std::string& directory, constStringList& extensions = stringList(), bool recursive = true);
+
+	/**
+	* Addiert ein Ergebnis zu einem anderen. Stats, Wortlängen, Wortverteilung und Wortpaare werden summiert,
+	* minOccurrences wird nicht angewendet. Aus einem temporären Ergebnis werden die Einträge ohne Kopie übernommen.
+	*/
+	void mergeAnalysisResult(AnalysisResult& into, const AnalysisResult& from);
+	void mergeAnalysisResult(AnalysisResult& into, AnalysisResult&& from);
+}
+
+#endif // !TEXTANALYSER_CORPUSANALYSER
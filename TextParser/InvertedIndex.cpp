@@ -0,0 +1,373 @@
+#include "InvertedIndex.h"
+#include "BinaryCoding.h"
+#include "MappedFile.h"
+#include "Utf8.h"
+#include <algorithm>
+#include <fstream>
+#include <tuple>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /// [intern] Kennung und Version am Anfang einer Indexdatei
+    constexpr char indexMagic[4] = { 'T', 'A', 'I', 'X' };
+    constexpr uint8_t indexVersion = 1;
+
+    /**
+    * [intern]
+    * Läuft über eine PostingList: nextDocument springt zum nächsten Dokument, nextHit zum nächsten Vorkommen darin
+    */
+    struct PostingCursor
+    {
+        ByteReader reader;
+        bool started = false;
+        uint64_t remaining = 0;
+        uint32_t document = 0;
+        uint32_t token = 0;
+        uint64_t position = 0;
+
+        explicit PostingCursor(const vector<uint8_t>& data)
+            : reader{ data.data(), data.data() + data.size() }
+        {
+        }
+
+        bool nextDocument()
+        {
+            while (nextHit())
+                ;
+            if (reader.p >= reader.end)
+                return false;
+
+            uint64_t delta = reader.varint();
+            document = started ? static_cast<uint32_t>(document + delta) : static_cast<uint32_t>(delta);
+            started = true;
+            remaining = reader.varint();
+            token = 0;
+            position = 0;
+            return reader.ok;
+        }
+
+        bool nextHit()
+        {
+            if (remaining == 0 || !reader.ok)
+                return false;
+            remaining--;
+            token += static_cast<uint32_t>(reader.varint());
+            position += reader.varint();
+            return reader.ok;
+        }
+    };
+
+    /**
+    * [intern]
+    * Alle Vorkommen einer Liste
+    */
+    template<typename List>
+    vector<IndexHit> decodeHits(const List& list)
+    {
+        vector<IndexHit> hits;
+        hits.reserve(list.occurrences);
+        PostingCursor cursor(list.data);
+        while (cursor.nextDocument())
+        {
+            while (cursor.nextHit())
+                hits.push_back({ cursor.document, cursor.token, cursor.position });
+        }
+        return hits;
+    }
+
+    // Siehe Header
+    InvertedIndex::InvertedIndex(const AnalysisOptions& options)
+        : options(options), table(makeCharTable(options.wordEnd, options.sentenceEnd))
+    {
+    }
+
+    /**
+    * [intern]
+    * Wandelt ein Wort wie bei den Dokumenten um, mit useLowerCase über toLowerUtf8 wie bei createWordDistribution
+    */
+    std::string InvertedIndex::normalize(std::string_view word) const
+    {
+        if (!options.useLowerCase)
+            return string(word);
+        string key;
+        toLowerUtf8(word, key);
+        return key;
+    }
+
+    // Siehe Header
+    std::uint32_t InvertedIndex::addDocument(std::string_view text)
+    {
+        uint32_t document = documentCount();
+        sentenceStarts.emplace_back();
+        vector<uint32_t>& sentences = sentenceStarts.back();
+
+        // erst alle Worte sammeln, dann pro Wort einen Eintrag an die Liste hängen
+        vector<tuple<wordId, uint32_t, uint64_t>> entries;
+        uint32_t token = 0;
+        size_t lastEnd = 0;
+        for (const Token& t : tokenize(text, options.wordEnd))
+        {
+            // wie bei TokenTable und findConnectedWords beginnt ein neuer Satz wenn zwischen den Worten ein Satzende liegt
+            bool newSentence = token == 0;
+            for (size_t i = lastEnd; i < t.position && !newSentence; ++i)
+                newSentence = (table[text[i]] & charSentenceEnd) != 0;
+            if (newSentence)
+                sentences.push_back(token);
+            lastEnd = t.position + t.value.size();
+
+            entries.emplace_back(vocabulary.intern(normalize(t.value)), token++, t.position);
+        }
+
+        stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return get<0>(a) < get<0>(b); });
+        if (postings.size() < vocabulary.size())
+            postings.resize(vocabulary.size());
+
+        for (size_t i = 0; i < entries.size();)
+        {
+            size_t runEnd = i;
+            while (runEnd < entries.size() && get<0>(entries[runEnd]) == get<0>(entries[i]))
+                ++runEnd;
+
+            PostingList& list = postings[get<0>(entries[i])];
+            writeVarint(list.data, list.documents ? document - list.lastDocument : document);
+            writeVarint(list.data, runEnd - i);
+            uint32_t lastToken = 0;
+            uint64_t lastPosition = 0;
+            for (size_t e = i; e < runEnd; ++e)
+            {
+                writeVarint(list.data, get<1>(entries[e]) - lastToken);
+                writeVarint(list.data, get<2>(entries[e]) - lastPosition);
+                lastToken = get<1>(entries[e]);
+                lastPosition = get<2>(entries[e]);
+            }
+            list.documents++;
+            list.occurrences += runEnd - i;
+            list.lastDocument = document;
+            i = runEnd;
+        }
+        return document;
+    }
+
+    /**
+    * [intern]
+    * Die Liste eines Wortes oder nullptr wenn es nicht im Index ist
+    */
+    const InvertedIndex::PostingList* InvertedIndex::find(std::string_view word) const
+    {
+        wordId id = vocabulary.find(normalize(word));
+        return (id == invalidWordId || id >= postings.size()) ? nullptr : &postings[id];
+    }
+
+    // Siehe Header
+    std::vector<IndexHit> InvertedIndex::lookup(std::string_view word) const
+    {
+        const PostingList* list = find(word);
+        return list ? decodeHits(*list) : vector<IndexHit>();
+    }
+
+    // Siehe Header
+    std::vector<std::uint32_t> InvertedIndex::documents(std::string_view word) const
+    {
+        vector<uint32_t> ids;
+        if (const PostingList* list = find(word))
+        {
+            ids.reserve(list->documents);
+            PostingCursor cursor(list->data);
+            while (cursor.nextDocument())
+                ids.push_back(cursor.document);
+        }
+        return ids;
+    }
+
+    // Siehe Header
+    std::uint64_t InvertedIndex::frequency(std::string_view word) const
+    {
+        const PostingList* list = find(word);
+        return list ? list->occurrences : 0;
+    }
+
+    // Siehe Header
+    std::uint32_t InvertedIndex::documentFrequency(std::string_view word) const
+    {
+        const PostingList* list = find(word);
+        return list ? list->documents : 0;
+    }
+
+    // Siehe Header
+    std::vector<IndexHit> InvertedIndex::phrase(std::string_view phrase) const
+    {
+        vector<const PostingList*> lists;
+        for (const Token& t : tokenize(phrase, options.wordEnd))
+        {
+            lists.push_back(find(t.value));
+            if (!lists.back())
+                return {};
+        }
+        if (lists.empty())
+            return {};
+
+        // die Treffer des ersten Wortes werden mit jedem weiteren Wort gefiltert, alle Listen sind nach (Dokument, Wort) sortiert
+        vector<IndexHit> hits = decodeHits(*lists[0]);
+        for (uint32_t k = 1; k < lists.size() && !hits.empty(); ++k)
+        {
+            vector<IndexHit> next = decodeHits(*lists[k]);
+            size_t n = 0, kept = 0;
+            for (const IndexHit& hit : hits)
+            {
+                auto before = [&](const IndexHit& h) { return tie(h.document, h.token) < make_tuple(hit.document, hit.token + k); };
+                while (n < next.size() && before(next[n]))
+                    ++n;
+                if (n < next.size() && next[n].document == hit.document && next[n].token == hit.token + k)
+                    hits[kept++] = hit;
+            }
+            hits.resize(kept);
+        }
+        return hits;
+    }
+
+    /**
+    * [intern]
+    * Prüft ob zwei Worte eines Dokuments im selben Satz stehen, first muss vor second liegen
+    */
+    bool InvertedIndex::sameSentence(std::uint32_t document, std::uint32_t first, std::uint32_t second) const
+    {
+        const vector<uint32_t>& starts = sentenceStarts[document];
+        auto nextStart = upper_bound(starts.begin(), starts.end(), first);
+        return nextStart == starts.end() || second < *nextStart;
+    }
+
+    // Siehe Header
+    std::vector<ProximityHit> InvertedIndex::near(std::string_view first, std::string_view second, int range) const
+    {
+        vector<ProximityHit> hits;
+        const PostingList* firstList = find(first);
+        const PostingList* secondList = find(second);
+        if (range < 2 || !firstList || !secondList)
+            return hits;
+
+        vector<IndexHit> a = decodeHits(*firstList);
+        vector<IndexHit> b = decodeHits(*secondList);
+        size_t j = 0;
+        for (const IndexHit& hit : a)
+        {
+            // j ist das erste Vorkommen von second hinter hit
+            while (j < b.size() && tie(b[j].document, b[j].token) <= tie(hit.document, hit.token))
+                ++j;
+            for (size_t k = j; k < b.size() && b[k].document == hit.document && b[k].token < hit.token + static_cast<uint32_t>(range); ++k)
+            {
+                if (sameSentence(hit.document, hit.token, b[k].token))
+                    hits.push_back({ hit.document, hit.token, b[k].token });
+            }
+        }
+        return hits;
+    }
+
+    // Siehe Header
+    bool InvertedIndex::save(const std::string& path) const
+    {
+        vector<uint8_t> out(begin(indexMagic), end(indexMagic));
+        out.push_back(indexVersion);
+        out.push_back(options.useLowerCase ? 1 : 0);
+        for (const string* s : { &options.wordEnd, &options.sentenceEnd })
+        {
+            writeVarint(out, s->size());
+            out.insert(out.end(), s->begin(), s->end());
+        }
+
+        writeVarint(out, sentenceStarts.size());
+        for (const vector<uint32_t>& starts : sentenceStarts)
+        {
+            writeVarint(out, starts.size());
+            uint32_t last = 0;
+            for (uint32_t s : starts)
+            {
+                writeVarint(out, s - last);
+                last = s;
+            }
+        }
+
+        writeVarint(out, vocabulary.size());
+        for (wordId id = 0; id < vocabulary.size(); ++id)
+        {
+            string_view word = vocabulary.word(id);
+            writeVarint(out, word.size());
+            out.insert(out.end(), word.begin(), word.end());
+
+            const PostingList& list = postings[id];
+            writeVarint(out, list.documents);
+            writeVarint(out, list.occurrences);
+            writeVarint(out, list.lastDocument);
+            writeVarint(out, list.data.size());
+            out.insert(out.end(), list.data.begin(), list.data.end());
+        }
+
+        ofstream file(path, ios::binary | ios::trunc);
+        file.write(reinterpret_cast<const char*>(out.data()), out.size());
+        return static_cast<bool>(file);
+    }
+
+    // Siehe Header
+    bool InvertedIndex::load(const std::string& path)
+    {
+        *this = InvertedIndex();
+
+        MappedFile file(path);
+        string_view data = file.view();
+        if (!file.isOpen() || data.size() < sizeof(indexMagic) + 2 || data.substr(0, 4) != string_view(indexMagic, 4) || data[4] != indexVersion)
+            return false;
+
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+        ByteReader reader{ bytes + 6, bytes + data.size() };
+        AnalysisOptions loaded;
+        loaded.useLowerCase = (data[5] != 0);
+        loaded.wordEnd = string(reader.bytes(reader.varint()));
+        loaded.sentenceEnd = string(reader.bytes(reader.varint()));
+        InvertedIndex index(loaded);
+
+        uint64_t documentCount = reader.varint();
+        for (uint64_t d = 0; d < documentCount && reader.ok; ++d)
+        {
+            vector<uint32_t>& starts = index.sentenceStarts.emplace_back();
+            uint64_t count = reader.varint();
+            uint32_t last = 0;
+            for (uint64_t s = 0; s < count && reader.ok; ++s)
+                starts.push_back(last += static_cast<uint32_t>(reader.varint()));
+        }
+
+        uint64_t wordCount = reader.varint();
+        for (uint64_t id = 0; id < wordCount && reader.ok; ++id)
+        {
+            string_view word = reader.bytes(reader.varint());
+            if (!reader.ok || index.vocabulary.intern(word) != id)
+                return false;
+
+            PostingList& list = index.postings.emplace_back();
+            list.documents = static_cast<uint32_t>(reader.varint());
+            list.occurrences = reader.varint();
+            list.lastDocument = static_cast<uint32_t>(reader.varint());
+            string_view listData = reader.bytes(reader.varint());
+            list.data.assign(listData.begin(), listData.end());
+
+            // die Liste muss vollständig lesbar sein und zu den Zählern passen
+            PostingCursor cursor(list.data);
+            uint64_t documents = 0, occurrences = 0;
+            while (cursor.nextDocument())
+            {
+                documents++;
+                while (cursor.nextHit())
+                    occurrences++;
+                if (cursor.document >= documentCount)
+                    return false;
+            }
+            if (!cursor.reader.ok || documents != list.documents || occurrences != list.occurrences)
+                return false;
+        }
+
+        if (!reader.ok || reader.p != reader.end)
+            return false;
+        *this = move(index);
+        return true;
+    }
+}
@@ -0,0 +1,141 @@
+/**
+* InvertedIndex.h
+*
+* Ein Index über einen Korpus der für jedes Wort die Dokumente und Positionen speichert. Abfragen nach Worten,
+* Phrasen, Wortpaaren in einem Abstand und Häufigkeiten lesen nur die Positionslisten der gesuchten Worte
+* und nicht mehr den ganzen Text.
+*/
+#pragma once
+#ifndef TEXTANALYSER_INVERTEDINDEX
+#define TEXTANALYSER_INVERTEDINDEX
+
+#include "TextAnalyser.h"
+#include <cstdint>
+#include <string_view>
+
+namespace AnalyserLib
+{
+	/**
+	* Ein Vorkommen eines Wortes: das Dokument, die Nummer des Wortes im Dokument und die Position im Text
+	*/
+	struct IndexHit
+	{
+		std::uint32_t document;
+		std::uint32_t token;
+		std::uint64_t position;
+	};
+
+	/**
+	* Zwei Worte im selben Satz, second steht weniger als range Worte hinter first
+	*/
+	struct ProximityHit
+	{
+		std::uint32_t document;
+		std::uint32_t firstToken;
+		std::uint32_t secondToken;
+	};
+
+	/**
+	* Positionsindex mit komprimierten Listen. Pro Wort und Dokument werden der Abstand zum vorherigen Dokument,
+	* die Anzahl und die Abstände der Wort- und Textpositionen als varint gespeichert, meist ein bis zwei Byte pro Vorkommen.
+	* Die Worte liegen in einem Vocabulary, die Dokumente bekommen fortlaufende Ids ab 0.
+	*
+	* Von den AnalysisOptions werden wordEnd, sentenceEnd und useLowerCase genutzt. Die Suchbegriffe werden
+	* genauso zerlegt und umgewandelt wie die Dokumente. Abfragen sind threadsicher solange kein Dokument hinzukommt.
+	*/
+	class InvertedIndex
+	{
+	public:
+		explicit InvertedIndex(const AnalysisOptions& options = AnalysisOptions());
+
+		/**
+		* Fügt ein Dokument zum Index hinzu. Der Text wird danach nicht mehr gebraucht.
+		*
+		* @return	Gibt die Id des Dokuments zurück
+		*/
+		std::uint32_t addDocument(std::string_view text);
+
+		/// Anzahl der Dokumente
+		std::uint32_t documentCount() const { return static_cast<std::uint32_t>(sentenceStarts.size()); }
+
+		/// Anzahl der unterschiedlichen Worte
+		size_t wordCount() const { return vocabulary.size(); }
+
+		/**
+		* @return	Gibt alle Vorkommen des Wortes zurück, sortiert nach Dokument und Position
+		*/
+		std::vector<IndexHit> lookup(std::string_view word) const;
+
+		/**
+		* @return	Gibt die Ids der Dokumente zurück in denen das Wort vorkommt
+		*/
+		std::vector<std::uint32_t> documents(std::string_view word) const;
+
+		/**
+		* @return	Gibt zurück wie oft das Wort im ganzen Korpus vorkommt
+		*/
+		std::uint64_t frequency(std::string_view word) const;
+
+		/**
+		* @return	Gibt zurück in wie vielen Dokumenten das Wort vorkommt
+		*/
+		std::uint32_t documentFrequency(std::string_view word) const;
+
+		/**
+		* Sucht eine Folge von Worten direkt hintereinander. Satzzeichen zwischen den Worten werden ignoriert.
+		*
+		* @param	phrase: Die Worte, werden wie ein Dokument zerlegt
+		* @return	Gibt die Position des ersten Wortes jedes Treffers zurück
+		*/
+		std::vector<IndexHit> phrase(std::string_view phrase) const;
+
+		/**
+		* Sucht Wortpaare wie findConnectedWords: second steht im selben Satz weniger als range Worte hinter first.
+		*
+		* @param	first: Das erste Wort
+		*			second: Das zweite Wort
+		*			range (default = 2): Der Abstand muss kleiner sein, 2 heißt direkt hintereinander
+		* @return	Gibt alle Paare zurück, sortiert nach Dokument und Position
+		*/
+		std::vector<ProximityHit> near(std::string_view first, std::string_view second, int range = 2) const;
+
+		/**
+		* Speichert den Index in eine Binärdatei
+		*
+		* @return	Gibt false zurück wenn die Datei nicht geschrieben werden konnte
+		*/
+		bool save(const std::string& path) const;
+
+		/**
+		* Lädt einen mit save gespeicherten Index und ersetzt den aktuellen
+		*
+		* @return	Gibt false zurück wenn die Datei nicht gelesen werden konnte oder kein gültiger Index ist, der Index ist dann leer
+		*/
+		bool load(const std::string& path);
+
+	private:
+		/**
+		* Die komprimierte Liste eines Wortes
+		*/
+		struct PostingList
+		{
+			std::vector<std::uint8_t> data;
+			std::uint32_t documents = 0;
+			std::uint64_t occurrences = 0;
+			std::uint32_t lastDocument = 0;
+		};
+
+		const PostingList* find(std::string_view word) const;
+		std::string normalize(std::string_view word) const;
+		bool sameSentence(std::uint32_t document, std::uint32_t first, std::uint32_t second) const;
+
+		AnalysisOptions options;
+		CharTable table;
+		Vocabulary vocabulary;
+		std::vector<PostingList> postings;
+		/// für jedes Dokument die Nummer des ersten Wortes jedes Satzes
+		std::vector<std::vector<std::uint32_t>> sentenceStarts;
+	};
+}
+
+#endif // !TEXTANALYSER_INVERTEDINDEX
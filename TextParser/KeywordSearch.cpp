@@ -0,0 +1,297 @@
+#include "KeywordSearch.h"
+#include "Metrics.h"
+#include "ThreadPool.h"
+#include "Utf8.h"
+#include <algorithm>
+#include <queue>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /// [intern] Markiert beim Aufbau des Tries einen fehlenden Übergang
+    constexpr uint32_t noState = UINT32_MAX;
+
+    /**
+    * [intern]
+    * Kleinbuchstabe für A-Z. Alle anderen Zeichen werden vor dem Automaten nach Code Points umgewandelt.
+    */
+    static inline unsigned char foldAscii(unsigned char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + 0x20) : c;
+    }
+
+    /**
+    * [intern]
+    * Buchstaben und Ziffern für wholeWords. Außerhalb von ASCII wird das Zeichen ab pos dekodiert und mit isLetter
+    * geprüft, so zählen ü oder é als Buchstaben, » oder ein Gedankenstrich aber nicht.
+    */
+    static bool isWordCharAt(string_view text, size_t pos)
+    {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+        if (c < 0x80)
+            return (defaultCharTable[static_cast<char>(c)] & charLetter) || (c >= '0' && c <= '9');
+        return isLetter(decodeUtf8(text, pos));
+    }
+
+    /**
+    * [intern]
+    * Wie isWordCharAt für das Zeichen das bei end endet. Ist davor keine gültige UTF-8 Folge, zählt das Byte als Latin-1.
+    */
+    static bool isWordCharBefore(string_view text, size_t end)
+    {
+        size_t begin = end - 1;
+        while (begin > 0 && end - begin < 4 && (static_cast<unsigned char>(text[begin]) & 0xC0) == 0x80)
+            --begin;
+        size_t pos = begin;
+        decodeUtf8(text, pos);
+        return isWordCharAt(text, (pos == end) ? begin : end - 1);
+    }
+
+    // Siehe Header
+    KeywordSearch::KeywordSearch(const std::vector<std::string>& keywords, const KeywordOptions& options)
+        : keywords(keywords), options(options)
+    {
+        auto fold = [&](unsigned char c) { return options.ignoreCase ? foldAscii(c) : c; };
+
+        // bei ignoreCase enthält der Automat die Begriffe in Kleinbuchstaben
+        vector<string> patterns;
+        patterns.reserve(keywords.size());
+        size_t longest = 1;
+        for (const string& k : keywords)
+        {
+            string pattern;
+            if (options.ignoreCase)
+                forEachFoldedByte(k, [&pattern](char c) { pattern += c; });
+            else
+                pattern = k;
+            patternLength.push_back(pattern.size());
+            longest = max(longest, pattern.size());
+            patterns.push_back(move(pattern));
+        }
+        while (startMask + 1 < longest)
+            startMask = startMask * 2 + 1;
+
+        // nur Zeichen aus den Begriffen bekommen eine eigene Spalte
+        uint32_t foldedClass[256] = {};
+        for (const string& k : patterns)
+        {
+            for (char c : k)
+            {
+                unsigned char b = fold(static_cast<unsigned char>(c));
+                if (foldedClass[b] == 0)
+                    foldedClass[b] = classCount++;
+            }
+        }
+        for (int c = 0; c < 256; ++c)
+            byteClass[c] = foldedClass[fold(static_cast<unsigned char>(c))];
+
+        // Trie aus allen Begriffen
+        transitions.assign(classCount, noState);
+        vector<vector<uint32_t>> ends(1);
+        for (uint32_t id = 0; id < keywords.size(); ++id)
+        {
+            if (patterns[id].empty())
+                continue;
+
+            uint32_t state = 0;
+            for (char c : patterns[id])
+            {
+                uint32_t& next = transitions[state * classCount + byteClass[static_cast<unsigned char>(c)]];
+                if (next == noState)
+                {
+                    next = static_cast<uint32_t>(ends.size());
+                    ends.emplace_back();
+                    transitions.resize(transitions.size() + classCount, noState);
+                }
+                state = transitions[state * classCount + byteClass[static_cast<unsigned char>(c)]];
+            }
+            ends[state].push_back(id);
+        }
+
+        // Fehlerübergänge in Breitensuche, danach ist jeder Übergang direkt in der Tabelle
+        size_t stateCount = ends.size();
+        vector<uint32_t> fail(stateCount, 0);
+        outputLink.assign(stateCount, 0);
+        queue<uint32_t> open;
+        for (uint32_t a = 0; a < classCount; ++a)
+        {
+            uint32_t& next = transitions[a];
+            if (next == noState)
+                next = 0;
+            else
+                open.push(next);
+        }
+        while (!open.empty())
+        {
+            uint32_t state = open.front();
+            open.pop();
+            for (uint32_t a = 0; a < classCount; ++a)
+            {
+                uint32_t& next = transitions[state * classCount + a];
+                uint32_t fallback = transitions[fail[state] * classCount + a];
+                if (next == noState)
+                    next = fallback;
+                else
+                {
+                    fail[next] = fallback;
+                    outputLink[next] = ends[fallback].empty() ? outputLink[fallback] : fallback;
+                    open.push(next);
+                }
+            }
+        }
+
+        // Zustände ohne Treffer kommen nach vorne, dann reicht beim Durchlauf ein Vergleich mit firstOutputRow.
+        // Die Tabelle enthält danach direkt den Anfang der Zeile des nächsten Zustands.
+        vector<uint32_t> order, newId(stateCount);
+        for (int withOutput = 0; withOutput < 2; ++withOutput)
+        {
+            for (uint32_t s = 0; s < stateCount; ++s)
+            {
+                if ((!ends[s].empty() || outputLink[s] != 0) == (withOutput == 1))
+                {
+                    newId[s] = static_cast<uint32_t>(order.size());
+                    order.push_back(s);
+                }
+            }
+        }
+
+        vector<uint32_t> table(transitions.size());
+        vector<uint32_t> links(stateCount);
+        outputBegin.assign(stateCount + 1, 0);
+        firstOutputRow = static_cast<uint32_t>(stateCount * classCount);
+        for (uint32_t n = 0; n < stateCount; ++n)
+        {
+            uint32_t s = order[n];
+            for (uint32_t a = 0; a < classCount; ++a)
+                table[n * classCount + a] = newId[transitions[s * classCount + a]] * classCount;
+            links[n] = outputLink[s] ? newId[outputLink[s]] : 0;
+            outputBegin[n + 1] = outputBegin[n] + static_cast<uint32_t>(ends[s].size());
+            outputIds.insert(outputIds.end(), ends[s].begin(), ends[s].end());
+            if (!ends[s].empty() || outputLink[s] != 0)
+                firstOutputRow = min<uint32_t>(firstOutputRow, n * classCount);
+        }
+        transitions = move(table);
+        outputLink = move(links);
+    }
+
+    /**
+    * [intern]
+    * Der Durchlauf über den Text, onHit bekommt die Id, den Anfang und die Länge jedes Treffers
+    */
+    template<typename F>
+    void KeywordSearch::scan(std::string_view text, F&& onHit) const
+    {
+        const uint32_t* table = transitions.data();
+        uint32_t row = 0;
+        if (!options.ignoreCase || isAscii(text))
+        {
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                row = table[row + byteClass[static_cast<unsigned char>(text[i])]];
+                if (row >= firstOutputRow)
+                    reportHits(text, row, i + 1, [i](size_t length) { return i + 1 - length; }, onHit);
+            }
+            return;
+        }
+
+        // ignoreCase mit UTF-8 oder Latin-1: jedes Zeichen läuft in Kleinbuchstaben durch den Automaten. Für die letzten
+        // Bytes wird gemerkt wo ihr Zeichen im Text beginnt, daraus ergibt sich der Anfang eines Treffers im Text.
+        vector<size_t> starts(startMask + 1);
+        uint64_t fed = 0;
+        string lower;
+        for (size_t i = 0; i < text.size();)
+        {
+            size_t begin = i;
+            lower.clear();
+            if (static_cast<unsigned char>(text[i]) < 0x80)
+                lower += text[i++];
+            else
+                appendUtf8(lower, toLower(decodeUtf8(text, i)));
+
+            for (char c : lower)
+            {
+                starts[fed++ & startMask] = begin;
+                row = table[row + byteClass[static_cast<unsigned char>(c)]];
+                if (row >= firstOutputRow)
+                    reportHits(text, row, i, [&](size_t length) { return starts[(fed - length) & startMask]; }, onHit);
+            }
+        }
+    }
+
+    /**
+    * [intern]
+    * Meldet alle Begriffe die im Zustand row enden. end ist das Ende des Treffers im Text, startOf gibt zur Länge
+    * eines Begriffs im Automaten den Anfang im Text zurück.
+    */
+    template<typename S, typename F>
+    void KeywordSearch::reportHits(std::string_view text, std::uint32_t row, size_t end, S&& startOf, F&& onHit) const
+    {
+        for (uint32_t s = row / classCount; s != 0; s = outputLink[s])
+        {
+            for (uint32_t o = outputBegin[s]; o < outputBegin[s + 1]; ++o)
+            {
+                uint32_t id = outputIds[o];
+                size_t start = startOf(patternLength[id]);
+                if (options.wholeWords && ((start > 0 && isWordCharBefore(text, start)) || (end < text.size() && isWordCharAt(text, end))))
+                    continue;
+                onHit(id, start, end - start);
+            }
+        }
+    }
+
+    // Siehe Header
+    void KeywordSearch::forEachHit(std::string_view text, const keywordCallback& callback) const
+    {
+        scan(text, [&](uint32_t id, size_t start, size_t length) { callback({ id, start, length }); });
+    }
+
+    // Siehe Header
+    std::vector<KeywordHit> KeywordSearch::findAll(std::string_view text) const
+    {
+        vector<KeywordHit> hits;
+        scan(text, [&hits](uint32_t id, size_t start, size_t length) { hits.push_back({ id, start, length }); });
+        return hits;
+    }
+
+    // Siehe Header
+    keywordCounts KeywordSearch::count(std::string_view text) const
+    {
+        keywordCounts counts(keywords.size(), 0);
+        count(text, counts);
+        return counts;
+    }
+
+    // Siehe Header
+    void KeywordSearch::count(std::string_view text, keywordCounts& counts) const
+    {
+        ANALYSER_STAGE_TIMER(stageSearch);
+        ANALYSER_STAGE_ADD(stageSearch, fieldBytesIn, text.size());
+        if (counts.size() < keywords.size())
+            counts.resize(keywords.size(), 0);
+        scan(text, [&counts](uint32_t id, size_t, size_t) { counts[id]++; });
+    }
+
+    // Siehe Header
+    keywordCounts KeywordSearch::countAsync(constStringList& documents) const
+    {
+        shared_ptr<ThreadPool> pool = getThreadPool();
+        size_t chunkCount = max<size_t>(1, min<size_t>(pool->concurrency(), documents.size()));
+
+        vector<keywordCounts> parts(chunkCount, keywordCounts(keywords.size(), 0));
+        pool->parallelFor(chunkCount, [&](size_t i)
+            {
+                size_t begin = documents.size() * i / chunkCount, end = documents.size() * (i + 1) / chunkCount;
+                for (size_t d = begin; d < end; ++d)
+                    count(documents[d], parts[i]);
+            });
+
+        keywordCounts counts = move(parts[0]);
+        for (size_t i = 1; i < parts.size(); ++i)
+        {
+            for (size_t k = 0; k < counts.size(); ++k)
+                counts[k] += parts[i][k];
+        }
+        return counts;
+    }
+}
@@ -0,0 +1,118 @@
+/**
+* KeywordSearch.h
+*
+* Sucht viele Begriffe gleichzeitig in einem einzigen Durchlauf über den Text. Die Begriffe werden einmal in einen
+* Aho-Corasick Automaten übersetzt, danach kostet jedes Zeichen einen Tabellenzugriff, unabhängig von der Anzahl der Begriffe.
+*/
+#pragma once
+#ifndef TEXTANALYSER_KEYWORDSEARCH
+#define TEXTANALYSER_KEYWORDSEARCH
+
+#include "TextAnalyser.h"
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace AnalyserLib
+{
+	/**
+	* Einstellungen für die KeywordSearch
+	*/
+	struct KeywordOptions
+	{
+		/// Großbuchstaben werden nach Code Points wie Kleinbuchstaben behandelt (siehe forEachFoldedByte), in UTF-8 und Latin-1
+		bool ignoreCase = false;
+		/// ein Treffer zählt nur wenn vor und nach ihm kein Buchstabe (nach Code Points, siehe isLetter) und keine Ziffer steht
+		bool wholeWords = false;
+	};
+
+	/**
+	* Ein Treffer mit der Id des Begriffs, der Position im Text und der Länge
+	*/
+	struct KeywordHit
+	{
+		std::uint32_t keyword;
+		std::uint64_t position;
+		size_t length;
+	};
+
+	using keywordCallback = std::function<void(const KeywordHit&)>;
+	/// Häufigkeit je Begriff, der Index ist die Id des Begriffs
+	using keywordCounts = std::vector<std::uint64_t>;
+
+	/**
+	* Ein Aho-Corasick Automat über eine feste Liste von Begriffen. Die Id eines Begriffs ist sein Index in der Liste.
+	* Es werden alle Vorkommen gefunden, auch überlappende und ineinander enthaltene (z.B. "Haus" in "Hausboot").
+	* Die Übergänge liegen als volle Tabelle über die Zeichen vor die in den Begriffen vorkommen,
+	* alle anderen Zeichen teilen sich eine Spalte. Nach dem Erstellen kann die Suche von mehreren Threads genutzt werden.
+	*/
+	class KeywordSearch
+	{
+	public:
+		/**
+		* @param	keywords: Die Begriffe, leere Begriffe werden nie gefunden
+		*			options: siehe KeywordOptions
+		*/
+		explicit KeywordSearch(const std::vector<std::string>& keywords, const KeywordOptions& options = KeywordOptions());
+
+		/// Anzahl der Begriffe
+		size_t size() const { return keywords.size(); }
+
+		const std::string& keyword(std::uint32_t id) const { return keywords[id]; }
+
+		/**
+		* Ruft callback für jeden Treffer auf, sortiert nach dem Ende des Treffers
+		*/
+		void forEachHit(std::string_view text, const keywordCallback& callback) const;
+
+		/**
+		* @return	Gibt alle Treffer im Text zurück, sortiert nach dem Ende des Treffers
+		*/
+		std::vector<KeywordHit> findAll(std::string_view text) const;
+
+		/**
+		* Zählt nur die Treffer je Begriff, ohne sie zu speichern
+		*
+		* @return	Gibt die Häufigkeit jedes Begriffs zurück
+		*/
+		keywordCounts count(std::string_view text) const;
+
+		/**
+		* Addiert die Treffer im Text auf counts, z.B. um einen ganzen Korpus Dokument für Dokument zu zählen.
+		* counts wird bei Bedarf auf size() vergrößert.
+		*/
+		void count(std::string_view text, keywordCounts& counts) const;
+
+		/**
+		* Zählt die Treffer in allen Dokumenten parallel im Thread Pool
+		*
+		* @return	Gibt die Häufigkeit jedes Begriffs über alle Dokumente zurück
+		*/
+		keywordCounts countAsync(constStringList& documents) const;
+
+	private:
+		template<typename F> void scan(std::string_view text, F&& onHit) const;
+		template<typename S, typename F> void reportHits(std::string_view text, std::uint32_t row, size_t end, S&& startOf, F&& onHit) const;
+
+		std::vector<std::string> keywords;
+		KeywordOptions options;
+		/// Länge der Begriffe im Automaten, bei ignoreCase nach dem Umwandeln in Kleinbuchstaben
+		std::vector<size_t> patternLength;
+		/// Maske für den Ringpuffer in dem sich scan bei ignoreCase den Anfang des Zeichens jedes Bytes merkt
+		size_t startMask = 0;
+		/// Spalte der Übergangstabelle für jedes Byte, bei ignoreCase mit A-Z als Kleinbuchstaben
+		std::uint32_t byteClass[256] = {};
+		std::uint32_t classCount = 1;
+		/// Übergangstabelle, jeder Eintrag ist der Anfang der Zeile des nächsten Zustands (state * classCount)
+		std::vector<std::uint32_t> transitions;
+		/// ab dieser Zeile endet in jedem Zustand ein Begriff, direkt oder über outputLink
+		std::uint32_t firstOutputRow = 0;
+		/// Begriffe die in einem Zustand enden: outputIds[outputBegin[s]] bis outputIds[outputBegin[s + 1]]
+		std::vector<std::uint32_t> outputBegin;
+		std::vector<std::uint32_t> outputIds;
+		/// der nächste kürzere Zustand mit Begriffen (Suffix Link), 0 wenn es keinen gibt
+		std::vector<std::uint32_t> outputLink;
+	};
+}
+
+#endif // !TEXTANALYSER_KEYWORDSEARCH
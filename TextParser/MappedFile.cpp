@@ -0,0 +1,164 @@
+#include "MappedFile.h"
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    // Siehe Header
+    MappedFile::MappedFile(const std::string& path)
+    {
+        open(path);
+    }
+
+    // Siehe Header
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    // Siehe Header
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = move(other);
+    }
+
+    // Siehe Header
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            buffer = move(other.buffer);
+            mapping = exchange(other.mapping, nullptr);
+            length = exchange(other.length, 0);
+            opened = exchange(other.opened, false);
+            data = mapping ? static_cast<const char*>(mapping) : buffer.data();
+            other.data = nullptr;
+        }
+        return *this;
+    }
+
+    // Siehe Header
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (map)
+            {
+                mapping = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(map);
+                if (mapping)
+                    length = static_cast<uint64_t>(fileSize.QuadPart);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            void* addr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                madvise(addr, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                mapping = addr;
+                length = static_cast<uint64_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+#endif
+
+        if (mapping)
+        {
+            data = static_cast<const char*>(mapping);
+            opened = true;
+            return true;
+        }
+        return readBuffered(path);
+    }
+
+    /**
+    * [intern]
+    * Liest die ganze Datei in den Puffer, für Dateien die nicht gemappt werden können oder leer sind
+    */
+    bool MappedFile::readBuffered(const std::string& path)
+    {
+        ifstream file(path, ios::binary);
+        if (!file.is_open())
+            return false;
+
+        // die Größe ist nicht immer bekannt (Pipes, /proc), deshalb wird in Blöcken gelesen
+        const size_t blockSize = 1 << 20;
+        size_t used = 0;
+        while (file)
+        {
+            buffer.resize(used + blockSize);
+            file.read(&buffer[used], blockSize);
+            used += static_cast<size_t>(file.gcount());
+        }
+        buffer.resize(used);
+        buffer.shrink_to_fit();
+
+        data = buffer.data();
+        length = used;
+        opened = true;
+        return true;
+    }
+
+    // Siehe Header
+    void MappedFile::close()
+    {
+        if (mapping)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(mapping);
+#else
+            munmap(mapping, static_cast<size_t>(length));
+#endif
+            mapping = nullptr;
+        }
+        buffer.clear();
+        buffer.shrink_to_fit();
+        data = nullptr;
+        length = 0;
+        opened = false;
+    }
+
+    // Siehe Header
+    void appendWithUnixNewlines(std::string& out, std::string_view text)
+    {
+        size_t pos = 0;
+        for (size_t cr = text.find("\r\n"); cr != string_view::npos; cr = text.find("\r\n", pos))
+        {
+            out.append(text.data() + pos, cr - pos);
+            pos = cr + 1;
+        }
+        out.append(text.data() + pos, text.size() - pos);
+    }
+}
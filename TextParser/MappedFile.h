@@ -0,0 +1,77 @@
+/**
+* MappedFile.h
+*
+* Öffnet eine Datei nur zum lesen ohne sie in einen string zu kopieren. Unter Linux mit mmap, unter Windows mit MapViewOfFile.
+* Wenn eine Datei nicht gemappt werden kann (z.B. eine Pipe) wird sie einmal komplett in einen Puffer gelesen.
+*/
+#pragma once
+#ifndef TEXTANALYSER_MAPPEDFILE
+#define TEXTANALYSER_MAPPEDFILE
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace AnalyserLib
+{
+	/**
+	* Eine geöffnete Datei als read-only view. Der view ist gültig bis die Datei geschlossen oder das Objekt zerstört wird.
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+
+		/**
+		* Öffnet die Datei direkt, siehe open()
+		*/
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/**
+		* Öffnet eine Datei. Eine vorher geöffnete Datei wird geschlossen.
+		*
+		* @param	path: Der Pfad zur Datei
+		* @return	false wenn die Datei nicht gelesen werden kann
+		*/
+		bool open(const std::string& path);
+
+		/**
+		* Schließt die Datei und gibt den Speicher frei
+		*/
+		void close();
+
+		bool isOpen() const { return opened; }
+
+		/// true wenn der Inhalt gemappt ist, false wenn er in den Puffer gelesen wurde
+		bool isMapped() const { return mapping != nullptr; }
+
+		std::uint64_t size() const { return length; }
+
+		/// Der Inhalt der Datei ohne Kopie
+		std::string_view view() const { return std::string_view(data, static_cast<size_t>(length)); }
+
+	private:
+		bool readBuffered(const std::string& path);
+
+		const char* data = nullptr;
+		std::uint64_t length = 0;
+		bool opened = false;
+		/// Adresse des Mappings, nullptr wenn der Puffer genutzt wird
+		void* mapping = nullptr;
+		std::string buffer;
+	};
+
+	/**
+	* Hängt text an out an und macht dabei aus \r\n ein \n, wie beim lesen im Textmodus unter Windows.
+	* readFile nutzt das für den Inhalt einer MappedFile.
+	*/
+	void appendWithUnixNewlines(std::string& out, std::string_view text);
+}
+
+#endif // !TEXTANALYSER_MAPPEDFILE
@@ -0,0 +1,294 @@
+#include "Metrics.h"
+#include "TextAnalyser.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /**
+    * [intern]
+    * Die Werte eines Threads. Nur der Thread selbst schreibt, deshalb reicht load und store statt fetch_add.
+    */
+    struct ThreadMetrics
+    {
+        atomic<uint64_t> stages[stageCount][fieldCount] = {};
+        atomic<uint64_t> counters[counterCount] = {};
+    };
+
+    /**
+    * [intern]
+    * Alle Blöcke der laufenden Threads. Endet ein Thread werden seine Werte in retired übernommen.
+    * resetMetrics merkt sich die aktuellen Summen in baseline, ein Snapshot zieht sie wieder ab.
+    */
+    class MetricsRegistry
+    {
+    public:
+        ThreadMetrics* add()
+        {
+            lock_guard<mutex> lock(mutex_);
+            threads.push_back(make_unique<ThreadMetrics>());
+            return threads.back().get();
+        }
+
+        void remove(ThreadMetrics* metrics)
+        {
+            lock_guard<mutex> lock(mutex_);
+            for (size_t s = 0; s < stageCount; ++s)
+            {
+                for (size_t f = 0; f < fieldCount; ++f)
+                    retired.stages[s][f] += metrics->stages[s][f].load(memory_order_relaxed);
+            }
+            for (size_t c = 0; c < counterCount; ++c)
+                retired.counters[c] += metrics->counters[c].load(memory_order_relaxed);
+
+            for (auto it = threads.begin(); it != threads.end(); ++it)
+            {
+                if (it->get() == metrics)
+                {
+                    threads.erase(it);
+                    break;
+                }
+            }
+        }
+
+        void snapshot(MetricsSnapshot& result)
+        {
+            lock_guard<mutex> lock(mutex_);
+            Totals totals = sum();
+            for (size_t s = 0; s < stageCount; ++s)
+            {
+                const uint64_t* v = totals.stages[s];
+                const uint64_t* b = baseline.stages[s];
+                result.stages[s] = { v[fieldCalls] - b[fieldCalls], v[fieldNanoseconds] - b[fieldNanoseconds],
+                    v[fieldBytesIn] - b[fieldBytesIn], v[fieldBytesOut] - b[fieldBytesOut],
+                    v[fieldTokens] - b[fieldTokens], v[fieldSentences] - b[fieldSentences] };
+            }
+            for (size_t c = 0; c < counterCount; ++c)
+                result.counters[c] = totals.counters[c] - baseline.counters[c];
+            for (size_t p = 0; p < peakCount; ++p)
+                result.peaks[p] = peaks[p].load(memory_order_relaxed);
+        }
+
+        void reset()
+        {
+            lock_guard<mutex> lock(mutex_);
+            baseline = sum();
+            for (atomic<uint64_t>& peak : peaks)
+                peak.store(0, memory_order_relaxed);
+        }
+
+        atomic<uint64_t> peaks[peakCount] = {};
+
+    private:
+        struct Totals
+        {
+            uint64_t stages[stageCount][fieldCount] = {};
+            uint64_t counters[counterCount] = {};
+        };
+
+        Totals sum() const
+        {
+            Totals totals = retired;
+            for (const auto& metrics : threads)
+            {
+                for (size_t s = 0; s < stageCount; ++s)
+                {
+                    for (size_t f = 0; f < fieldCount; ++f)
+                        totals.stages[s][f] += metrics->stages[s][f].load(memory_order_relaxed);
+                }
+                for (size_t c = 0; c < counterCount; ++c)
+                    totals.counters[c] += metrics->counters[c].load(memory_order_relaxed);
+            }
+            return totals;
+        }
+
+        mutex mutex_;
+        vector<unique_ptr<ThreadMetrics>> threads;
+        Totals retired;
+        Totals baseline;
+    };
+
+    /// [intern] Wird nie zerstört, damit Threads auch beim Beenden des Programms noch austragen können
+    static MetricsRegistry& registry()
+    {
+        static MetricsRegistry* instance = new MetricsRegistry();
+        return *instance;
+    }
+
+    /**
+    * [intern]
+    * Trägt den Block des Threads beim ersten Messpunkt ein und beim Ende des Threads wieder aus
+    */
+    struct ThreadRegistration
+    {
+        ThreadMetrics* metrics = registry().add();
+
+        ~ThreadRegistration()
+        {
+            registry().remove(metrics);
+        }
+    };
+
+    /// [intern] Der Block des aktuellen Threads
+    static ThreadMetrics& localMetrics()
+    {
+        // ein einfacher Zeiger braucht beim Zugriff keine Prüfung ob er schon initialisiert ist
+        static thread_local ThreadMetrics* current = nullptr;
+        if (!current)
+        {
+            static thread_local ThreadRegistration registration;
+            current = registration.metrics;
+        }
+        return *current;
+    }
+
+    /// [intern] Addiert ohne atomare Operation, es gibt nur einen schreibenden Thread
+    static inline void addRelaxed(atomic<uint64_t>& value, uint64_t add)
+    {
+        value.store(value.load(memory_order_relaxed) + add, memory_order_relaxed);
+    }
+
+    // Siehe Header
+    void addStageMetric(metricStage stage, stageField field, std::uint64_t value)
+    {
+        addRelaxed(localMetrics().stages[stage][field], value);
+    }
+
+    // Siehe Header
+    void addCounter(metricCounter counter, std::uint64_t value)
+    {
+        addRelaxed(localMetrics().counters[counter], value);
+    }
+
+    // Siehe Header
+    void updatePeak(metricPeak peak, std::uint64_t value)
+    {
+        atomic<uint64_t>& current = registry().peaks[peak];
+        uint64_t old = current.load(memory_order_relaxed);
+        while (value > old && !current.compare_exchange_weak(old, value, memory_order_relaxed))
+        {
+        }
+    }
+
+    // Siehe Header
+    MetricsSnapshot getMetricsSnapshot()
+    {
+        MetricsSnapshot result;
+#ifdef ANALYSER_METRICS
+        result.enabled = true;
+#endif
+        registry().snapshot(result);
+
+        CacheCounters cache = getCacheCounters();
+        result.cacheHits = cache.hits;
+        result.cacheMisses = cache.misses;
+        result.cacheEvictions = cache.evictions;
+        result.cacheSize = cache.size;
+        return result;
+    }
+
+    // Siehe Header
+    void resetMetrics()
+    {
+        registry().reset();
+    }
+
+    // Siehe Header
+    const char* stageName(metricStage stage)
+    {
+        static const char* const names[stageCount] = { "readFile", "cleanup", "tokenize", "analyse", "statsHash", "pairs", "search" };
+        return stage < stageCount ? names[stage] : "unknown";
+    }
+
+    /// [intern] Namen der Werte für JSON und Prometheus
+    static const char* const fieldNames[fieldCount] = { "calls", "seconds", "bytesIn", "bytesOut", "tokens", "sentences" };
+    static const char* const fieldMetricNames[fieldCount] = { "calls", "seconds", "bytes_in", "bytes_out", "tokens", "sentences" };
+    static const char* const counterNames[counterCount] = { "hashProbes", "hashResizes" };
+    static const char* const counterMetricNames[counterCount] = { "hash_probes", "hash_resizes" };
+    static const char* const peakNames[peakCount] = { "distributionBytes", "pairTableBytes" };
+    static const char* const peakMetricNames[peakCount] = { "peak_distribution_bytes", "peak_pair_table_bytes" };
+
+    /**
+    * [intern]
+    * Schreibt den Wert eines Feldes, die Zeit in Sekunden
+    */
+    static void writeField(ostringstream& out, const StageMetrics& stage, size_t field)
+    {
+        const uint64_t values[fieldCount] = { stage.calls, stage.nanoseconds, stage.bytesIn, stage.bytesOut, stage.tokens, stage.sentences };
+        if (field == fieldNanoseconds)
+            out << static_cast<double>(values[field]) / 1e9;
+        else
+            out << values[field];
+    }
+
+    // Siehe Header
+    std::string MetricsSnapshot::toJson() const
+    {
+        ostringstream out;
+        out.precision(9);
+        out << "{\"enabled\":" << (enabled ? "true" : "false") << ",\"stages\":{";
+        for (size_t s = 0; s < stageCount; ++s)
+        {
+            out << (s ? ",\"" : "\"") << stageName(static_cast<metricStage>(s)) << "\":{";
+            for (size_t f = 0; f < fieldCount; ++f)
+            {
+                out << (f ? ",\"" : "\"") << fieldNames[f] << "\":";
+                writeField(out, stages[s], f);
+            }
+            out << "}";
+        }
+        out << "},\"counters\":{";
+        for (size_t c = 0; c < counterCount; ++c)
+            out << (c ? ",\"" : "\"") << counterNames[c] << "\":" << counters[c];
+        out << "},\"peaks\":{";
+        for (size_t p = 0; p < peakCount; ++p)
+            out << (p ? ",\"" : "\"") << peakNames[p] << "\":" << peaks[p];
+        out << "},\"statsCache\":{\"hits\":" << cacheHits << ",\"misses\":" << cacheMisses
+            << ",\"evictions\":" << cacheEvictions << ",\"size\":" << cacheSize << "}}";
+        return out.str();
+    }
+
+    // Siehe Header
+    std::string MetricsSnapshot::toPrometheus() const
+    {
+        ostringstream out;
+        out.precision(9);
+        for (size_t f = 0; f < fieldCount; ++f)
+        {
+            string name = string("textanalyser_stage_") + fieldMetricNames[f] + "_total";
+            out << "# TYPE " << name << " counter\n";
+            for (size_t s = 0; s < stageCount; ++s)
+            {
+                out << name << "{stage=\"" << stageName(static_cast<metricStage>(s)) << "\"} ";
+                writeField(out, stages[s], f);
+                out << "\n";
+            }
+        }
+        for (size_t c = 0; c < counterCount; ++c)
+        {
+            out << "# TYPE textanalyser_" << counterMetricNames[c] << "_total counter\n";
+            out << "textanalyser_" << counterMetricNames[c] << "_total " << counters[c] << "\n";
+        }
+        for (size_t p = 0; p < peakCount; ++p)
+        {
+            out << "# TYPE textanalyser_" << peakMetricNames[p] << " gauge\n";
+            out << "textanalyser_" << peakMetricNames[p] << " " << peaks[p] << "\n";
+        }
+
+        const char* cacheNames[] = { "hits", "misses", "evictions" };
+        const uint64_t cacheValues[] = { cacheHits, cacheMisses, cacheEvictions };
+        for (size_t i = 0; i < 3; ++i)
+        {
+            out << "# TYPE textanalyser_stats_cache_" << cacheNames[i] << "_total counter\n";
+            out << "textanalyser_stats_cache_" << cacheNames[i] << "_total " << cacheValues[i] << "\n";
+        }
+        out << "# TYPE textanalyser_stats_cache_entries gauge\n";
+        out << "textanalyser_stats_cache_entries " << cacheSize << "\n";
+        return out.str();
+    }
+}
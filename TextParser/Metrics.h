@@ -0,0 +1,188 @@
+/**
+* Metrics.h
+*
+* Optionale Messpunkte in den wichtigen Abschnitten der Bibliothek: Aufrufe, Zeit, Byte, Worte und Sätze pro Stufe,
+* dazu Sondierungen und Vergrößerungen der Hashtabellen und der größte Speicherbedarf der Verteilungen.
+*
+* Die Messpunkte werden nur mit ANALYSER_METRICS übersetzt (z.B. -DANALYSER_METRICS), sonst bleibt von ihnen kein
+* Code übrig. Jeder Thread zählt in seinem eigenen Block, ein Snapshot addiert alle Blöcke und kann jederzeit aus
+* einem anderen Thread gelesen werden, auch während eine Analyse läuft.
+*/
+#pragma once
+#ifndef TEXTANALYSER_METRICS
+#define TEXTANALYSER_METRICS
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace AnalyserLib
+{
+	/**
+	* Die gemessenen Abschnitte. Sie können verschachtelt sein, createStatistics ruft z.B. analyseText auf.
+	*/
+	enum metricStage
+	{
+		/// Datei lesen und Zeilenenden umwandeln, ohne cleanUpText
+		stageReadFile,
+		/// cleanUpText
+		stageCleanup,
+		/// splitTextIntoStringList und TokenTable::build
+		stageTokenize,
+		/// ein Durchlauf von analyseText, bei analyseTextAsync einer pro Teil und bei StreamAnalyser einer pro feed
+		stageAnalyse,
+		/// Hash des Textes für den StatsCache in createStatistics
+		stageStatsHash,
+		/// Wortpaare filtern, zusammenführen und in wordPairs umwandeln
+		stagePairs,
+		/// findPatterns und KeywordSearch::count
+		stageSearch,
+		stageCount
+	};
+
+	/**
+	* Die Werte einer Stufe
+	*/
+	enum stageField
+	{
+		fieldCalls,
+		/// Summe über alle Threads, kann bei parallelen Aufrufen größer als die vergangene Zeit sein
+		fieldNanoseconds,
+		fieldBytesIn,
+		fieldBytesOut,
+		fieldTokens,
+		fieldSentences,
+		fieldCount
+	};
+
+	enum metricCounter
+	{
+		/// belegte Plätze die beim Einfügen in einen PairCounter übersprungen wurden
+		counterHashProbes,
+		/// Vergrößerungen von PairCounter und Vocabulary
+		counterHashResizes,
+		counterCount
+	};
+
+	enum metricPeak
+	{
+		/// geschätzter Speicher der größten wordDistribution bzw. wordPairs, ohne die Zeichen langer Worte
+		peakDistributionBytes,
+		/// größte Tabelle eines PairCounter
+		peakPairTableBytes,
+		peakCount
+	};
+
+	/**
+	* Die Werte einer Stufe seit dem Start oder dem letzten resetMetrics
+	*/
+	struct StageMetrics
+	{
+		std::uint64_t calls = 0;
+		std::uint64_t nanoseconds = 0;
+		std::uint64_t bytesIn = 0;
+		std::uint64_t bytesOut = 0;
+		std::uint64_t tokens = 0;
+		std::uint64_t sentences = 0;
+	};
+
+	/**
+	* Alle Werte zu einem Zeitpunkt. Die Zähler des StatsCache werden immer geliefert, auch ohne ANALYSER_METRICS.
+	*/
+	struct MetricsSnapshot
+	{
+		/// true wenn die Bibliothek mit ANALYSER_METRICS übersetzt wurde
+		bool enabled = false;
+		StageMetrics stages[stageCount];
+		std::uint64_t counters[counterCount] = {};
+		std::uint64_t peaks[peakCount] = {};
+		std::uint64_t cacheHits = 0;
+		std::uint64_t cacheMisses = 0;
+		std::uint64_t cacheEvictions = 0;
+		std::uint64_t cacheSize = 0;
+
+		/**
+		* @return	Gibt alle Werte als JSON Objekt zurück, Zeiten in Sekunden
+		*/
+		std::string toJson() const;
+
+		/**
+		* @return	Gibt alle Werte im Textformat von Prometheus zurück, mit dem Präfix textanalyser_
+		*/
+		std::string toPrometheus() const;
+	};
+
+	/**
+	* Addiert die Werte aller Threads. Kann jederzeit aus jedem Thread aufgerufen werden, Werte von gerade laufenden
+	* Aufrufen sind eventuell erst teilweise enthalten.
+	*/
+	MetricsSnapshot getMetricsSnapshot();
+
+	/**
+	* Setzt alle Werte auf 0, die Zähler des StatsCache ausgenommen
+	*/
+	void resetMetrics();
+
+	/**
+	* @return	Gibt den Namen der Stufe zurück, z.B. "readFile"
+	*/
+	const char* stageName(metricStage stage);
+
+	/**
+	* [intern] Die Funktionen hinter den Makros unten, nur im Thread der gerade misst aufrufen
+	*/
+	void addStageMetric(metricStage stage, stageField field, std::uint64_t value);
+	void addCounter(metricCounter counter, std::uint64_t value);
+	void updatePeak(metricPeak peak, std::uint64_t value);
+
+	/**
+	* [intern]
+	* Misst die Zeit bis zum Ende des Blocks und zählt einen Aufruf
+	*/
+	class StageTimer
+	{
+	public:
+		explicit StageTimer(metricStage stage)
+			: stage(stage), start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~StageTimer()
+		{
+			auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+			addStageMetric(stage, fieldCalls, 1);
+			addStageMetric(stage, fieldNanoseconds, static_cast<std::uint64_t>(elapsed.count()));
+		}
+
+		StageTimer(const StageTimer&) = delete;
+		StageTimer& operator=(const StageTimer&) = delete;
+
+	private:
+		metricStage stage;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/**
+	* [intern]
+	* Geschätzter Speicher einer unordered_map: Buckets und Knoten, ohne Speicher den die Schlüssel selbst anlegen
+	*/
+	template<class Map>
+	std::uint64_t estimateMapBytes(const Map& map)
+	{
+		return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*));
+	}
+}
+
+#ifdef ANALYSER_METRICS
+#define ANALYSER_STAGE_TIMER(stage) AnalyserLib::StageTimer analyserStageTimer(stage)
+#define ANALYSER_STAGE_ADD(stage, field, value) AnalyserLib::addStageMetric(stage, field, static_cast<std::uint64_t>(value))
+#define ANALYSER_COUNTER_ADD(counter, value) AnalyserLib::addCounter(counter, static_cast<std::uint64_t>(value))
+#define ANALYSER_PEAK(peak, value) AnalyserLib::updatePeak(peak, static_cast<std::uint64_t>(value))
+#else
+#define ANALYSER_STAGE_TIMER(stage)
+#define ANALYSER_STAGE_ADD(stage, field, value) ((void)0)
+#define ANALYSER_COUNTER_ADD(counter, value) ((void)0)
+#define ANALYSER_PEAK(peak, value) ((void)0)
+#endif
+
+#endif // !TEXTANALYSER_METRICS
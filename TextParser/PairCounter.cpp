@@ -0,0 +1,166 @@
+#include "PairCounter.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /**
+    * [intern]
+    * Durchmischt den Schlüssel (Finalizer von MurmurHash3), damit auch kleine fortlaufende Ids gut verteilt werden
+    */
+    static inline size_t hashKey(uint64_t key)
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+
+    /// [intern] Schlüssel aus zwei Ids
+    static inline uint64_t makeKey(wordId first, wordId second)
+    {
+        return (static_cast<uint64_t>(first) << 32) | second;
+    }
+
+    // Siehe Header
+    void PairCounter::add(wordId first, wordId second, int count)
+    {
+        insert(makeKey(first, second), count);
+        if (maxEntries > 0 && used > maxEntries)
+            shrinkToLimit();
+    }
+
+    // Siehe Header
+    int PairCounter::count(wordId first, wordId second) const
+    {
+        if (slots.empty())
+            return 0;
+
+        uint64_t key = makeKey(first, second);
+        size_t mask = slots.size() - 1;
+        for (size_t i = hashKey(key) & mask; slots[i].count > 0; i = (i + 1) & mask)
+        {
+            if (slots[i].key == key)
+                return slots[i].count;
+        }
+        return 0;
+    }
+
+    // Siehe Header
+    void PairCounter::prune(int minCount)
+    {
+        vector<Slot> old(slots.size(), Slot{ 0, 0 });
+        old.swap(slots);
+        used = 0;
+        for (const Slot& slot : old)
+        {
+            if (slot.count >= minCount && slot.count > 0)
+                insert(slot.key, slot.count);
+        }
+    }
+
+    // Siehe Header
+    void PairCounter::setMaxEntries(size_t limit)
+    {
+        maxEntries = limit;
+        if (maxEntries > 0 && used > maxEntries)
+            shrinkToLimit();
+    }
+
+    // Siehe Header
+    void PairCounter::merge(const PairCounter& other)
+    {
+        for (const Slot& slot : other.slots)
+        {
+            if (slot.count > 0)
+                insert(slot.key, slot.count);
+        }
+        if (maxEntries > 0 && used > maxEntries)
+            shrinkToLimit();
+    }
+
+    // Siehe Header
+    void PairCounter::clear()
+    {
+        slots.clear();
+        used = 0;
+    }
+
+    /**
+    * [intern]
+    * Fügt den Schlüssel ein oder erhöht seine Häufigkeit. Die Tabelle ist höchstens zur Hälfte gefüllt.
+    */
+    void PairCounter::insert(uint64_t key, int count)
+    {
+        if ((used + 1) * 2 > slots.size())
+            rehash(max<size_t>(64, slots.size() * 2));
+
+        size_t mask = slots.size() - 1;
+        size_t i = hashKey(key) & mask;
+#ifdef ANALYSER_METRICS
+        size_t start = i;
+#endif
+        while (slots[i].count > 0)
+        {
+            if (slots[i].key == key)
+            {
+                slots[i].count += count;
+                ANALYSER_COUNTER_ADD(counterHashProbes, (i - start) & mask);
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+        ANALYSER_COUNTER_ADD(counterHashProbes, (i - start) & mask);
+        slots[i] = { key, count };
+        used++;
+    }
+
+    /**
+    * [intern]
+    * Legt die Tabelle mit neuer Größe (Zweierpotenz) an und fügt alle Einträge neu ein
+    */
+    void PairCounter::rehash(size_t capacity)
+    {
+        ANALYSER_COUNTER_ADD(counterHashResizes, 1);
+        ANALYSER_PEAK(peakPairTableBytes, capacity * sizeof(Slot));
+        vector<Slot> old(capacity, Slot{ 0, 0 });
+        old.swap(slots);
+        used = 0;
+        for (const Slot& slot : old)
+        {
+            if (slot.count > 0)
+                insert(slot.key, slot.count);
+        }
+    }
+
+    /**
+    * [intern]
+    * Entfernt die seltensten Paare bis höchstens maxEntries / 2 übrig sind. Die Grenze wird einmal mit nth_element
+    * bestimmt: alle Paare die nicht häufiger sind als das (maxEntries / 2 + 1)-häufigste werden mit einem prune entfernt.
+    */
+    void PairCounter::shrinkToLimit()
+    {
+        size_t keep = maxEntries / 2;
+        if (used <= keep)
+            return;
+
+        vector<int> counts;
+        counts.reserve(used);
+        for (const Slot& slot : slots)
+        {
+            if (slot.count > 0)
+                counts.push_back(slot.count);
+        }
+        nth_element(counts.begin(), counts.begin() + keep, counts.end(), greater<int>());
+        if (counts[keep] == INT_MAX)
+            clear();
+        else
+            prune(counts[keep] + 1);
+    }
+}
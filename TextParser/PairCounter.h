@@ -0,0 +1,95 @@
+/**
+* PairCounter.h
+*
+* Zählt Wortpaare in einer flachen Hashtabelle mit offener Adressierung. Die beiden wordIds eines Paares werden zu
+* einem 64 bit Schlüssel zusammengesetzt, jeder Eintrag liegt direkt im Array und es gibt keine einzelnen Knoten.
+*/
+#pragma once
+#ifndef TEXTANALYSER_PAIRCOUNTER
+#define TEXTANALYSER_PAIRCOUNTER
+
+#include "Vocabulary.h"
+#include <cstdint>
+#include <vector>
+
+namespace AnalyserLib
+{
+	/**
+	* Hashtabelle für die Häufigkeit von wordIdPair mit linearer Sondierung.
+	* Optional kann die Anzahl der Einträge begrenzt werden, dann werden seltene Paare schon beim Zählen entfernt.
+	*/
+	class PairCounter
+	{
+	public:
+		/**
+		* Erhöht die Häufigkeit eines Paares
+		*
+		* @param	first: Das erste Wort des Paares
+		*			second: Das zweite Wort des Paares
+		*			count (default = 1): Wird auf die Häufigkeit addiert, muss größer als 0 sein
+		*/
+		void add(wordId first, wordId second, int count = 1);
+
+		/**
+		* @return	Gibt die Häufigkeit des Paares zurück, 0 wenn es nicht vorkommt
+		*/
+		int count(wordId first, wordId second) const;
+
+		/**
+		* Entfernt alle Paare die seltener als minCount vorkommen
+		*/
+		void prune(int minCount);
+
+		/**
+		* Begrenzt die Anzahl der Einträge. Wird die Grenze überschritten werden die seltensten Paare entfernt, bis höchstens
+		* die Hälfte übrig ist. Die Häufigkeiten sind dann nur noch Näherungen (zu klein, nie zu groß), häufige Paare bleiben
+		* aber erhalten. Bei 0 wird exakt gezählt.
+		*/
+		void setMaxEntries(size_t maxEntries);
+
+		/**
+		* Addiert alle Paare aus other
+		*/
+		void merge(const PairCounter& other);
+
+		/// Anzahl der unterschiedlichen Paare
+		size_t size() const { return used; }
+		bool empty() const { return used == 0; }
+
+		void clear();
+
+		/**
+		* Ruft f(wordIdPair, int) für jedes Paar auf. Die Reihenfolge ist nicht festgelegt.
+		*/
+		template<class F>
+		void forEach(F&& f) const
+		{
+			for (const Slot& slot : slots)
+			{
+				if (slot.count > 0)
+					f(wordIdPair(static_cast<wordId>(slot.key >> 32), static_cast<wordId>(slot.key)), slot.count);
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			std::uint64_t key;
+			/// 0 bedeutet der Platz ist frei
+			int count;
+		};
+
+		void insert(std::uint64_t key, int count);
+		void rehash(size_t capacity);
+		void shrinkToLimit();
+
+		std::vector<Slot> slots;
+		size_t used = 0;
+		size_t maxEntries = 0;
+	};
+
+	/// Häufigkeit jedes Wortpaares
+	using wordIdPairs = PairCounter;
+}
+
+#endif // !TEXTANALYSER_PAIRCOUNTER
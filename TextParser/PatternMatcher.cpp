@@ -0,0 +1,409 @@
+#include "PatternMatcher.h"
+#include <bitset>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /// [intern] Die Bytes die eine Zeichenposition des Musters akzeptiert
+    using charSet = bitset<256>;
+
+    /**
+    * [intern]
+    * Eine Zeichenklasse mit ihrer Wiederholung, max = -1 steht für beliebig oft
+    */
+    struct PatternAtom
+    {
+        charSet chars;
+        int min = 1;
+        int max = 1;
+    };
+
+    /// [intern] Die Obergrenze für {n,m}, größere Wiederholungen passen ohnehin nicht in 63 Positionen
+    constexpr int maxRepeat = 64;
+
+    /**
+    * [intern]
+    * Fügt eine Klasse wie \w oder \d über die regex_traits hinzu, damit sie genauso wie bei std::regex aussieht
+    */
+    void addCharClass(charSet& set, char name, bool negate)
+    {
+        regex_traits<char> traits;
+        auto cls = traits.lookup_classname(&name, &name + 1);
+        for (int c = 0; c < 256; ++c)
+        {
+            if (traits.isctype(static_cast<char>(c), cls) != negate)
+                set.set(c);
+        }
+    }
+
+    inline bool isAsciiPunctuation(char c)
+    {
+        return (c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+    }
+
+    /**
+    * [intern]
+    * Liest ein maskiertes Zeichen nach '\'. Gibt false zurück wenn es nicht unterstützt wird, z.B. \b innerhalb des Musters.
+    */
+    bool parseEscape(char e, charSet& set)
+    {
+        switch (e)
+        {
+        case 'w': case 'd': case 's':
+            addCharClass(set, e, false);
+            return true;
+        case 'W': case 'D': case 'S':
+            addCharClass(set, static_cast<char>(e - 'A' + 'a'), true);
+            return true;
+        case 'n': set.set('\n'); return true;
+        case 'r': set.set('\r'); return true;
+        case 't': set.set('\t'); return true;
+        default:
+            if (!isAsciiPunctuation(e))
+                return false;
+            set.set(static_cast<unsigned char>(e));
+            return true;
+        }
+    }
+
+    /**
+    * [intern]
+    * Liest eine Zeichenmenge ab dem Zeichen nach '['. Bereiche sind nur zwischen druckbaren ASCII Zeichen erlaubt.
+    */
+    bool parseBracket(string_view p, size_t& i, charSet& set)
+    {
+        bool negate = (i < p.size() && p[i] == '^');
+        if (negate)
+            ++i;
+        // "[]" und "[^]" haben in ECMAScript eine eigene Bedeutung
+        if (i < p.size() && p[i] == ']')
+            return false;
+
+        while (i < p.size() && p[i] != ']')
+        {
+            char c = p[i];
+            if (c == '[')
+                return false;
+            if (c == '\\')
+            {
+                if (i + 1 >= p.size() || !parseEscape(p[i + 1], set))
+                    return false;
+                i += 2;
+                continue;
+            }
+
+            if (i + 2 < p.size() && p[i + 1] == '-' && p[i + 2] != ']')
+            {
+                char last = p[i + 2];
+                if (c < ' ' || c > '~' || last < ' ' || last > '~' || last == '\\' || last == '[' || last < c)
+                    return false;
+                for (int x = c; x <= last; ++x)
+                    set.set(x);
+                i += 3;
+            }
+            else
+            {
+                set.set(static_cast<unsigned char>(c));
+                ++i;
+            }
+        }
+        if (i >= p.size())
+            return false;
+        ++i;
+
+        if (negate)
+            set.flip();
+        return true;
+    }
+
+    /**
+    * [intern]
+    * Liest eine Zahl für {n,m}
+    */
+    bool parseNumber(string_view p, size_t& i, int& value)
+    {
+        size_t begin = i;
+        value = 0;
+        while (i < p.size() && p[i] >= '0' && p[i] <= '9')
+        {
+            value = value * 10 + (p[i] - '0');
+            if (value > maxRepeat)
+                return false;
+            ++i;
+        }
+        return i > begin;
+    }
+
+    /**
+    * [intern]
+    * Liest eine Wiederholung nach einer Zeichenklasse, ohne Wiederholung bleibt es bei genau einmal
+    */
+    bool parseQuantifier(string_view p, size_t& i, PatternAtom& atom)
+    {
+        if (i >= p.size())
+            return true;
+
+        switch (p[i])
+        {
+        case '?': atom.min = 0; atom.max = 1; ++i; break;
+        case '*': atom.min = 0; atom.max = -1; ++i; break;
+        case '+': atom.min = 1; atom.max = -1; ++i; break;
+        case '{':
+            ++i;
+            if (!parseNumber(p, i, atom.min))
+                return false;
+            atom.max = atom.min;
+            if (i < p.size() && p[i] == ',')
+            {
+                ++i;
+                atom.max = -1;
+                if (i < p.size() && p[i] != '}' && (!parseNumber(p, i, atom.max) || atom.max < atom.min))
+                    return false;
+            }
+            if (i >= p.size() || p[i] != '}')
+                return false;
+            ++i;
+            break;
+        default:
+            return true;
+        }
+
+        // faule Wiederholungen wie *? werden nicht unterstützt
+        return i >= p.size() || (p[i] != '?' && p[i] != '*' && p[i] != '+' && p[i] != '{');
+    }
+
+    /**
+    * [intern]
+    * Übersetzt das Muster in die Masken des Automaten. Gibt false zurück wenn es nicht unterstützt wird.
+    */
+    bool PatternMatcher::compile(std::string_view p)
+    {
+        charSet words;
+        addCharClass(words, 'w', false);
+        for (int c = 0; c < 256; ++c)
+            wordChar[c] = words[c];
+
+        size_t i = 0;
+        if (p.substr(0, 1) == "^")
+        {
+            leading = Anchor::textBorder;
+            i = 1;
+        }
+        else if (p.substr(0, 2) == "\\b")
+        {
+            leading = Anchor::wordBoundary;
+            i = 2;
+        }
+
+        vector<PatternAtom> atoms;
+        while (i < p.size())
+        {
+            if (p.substr(i) == "$")
+            {
+                trailing = Anchor::textBorder;
+                break;
+            }
+            if (p.substr(i) == "\\b")
+            {
+                trailing = Anchor::wordBoundary;
+                break;
+            }
+
+            PatternAtom atom;
+            char c = p[i];
+            if (c == '.')
+            {
+                atom.chars.set();
+                atom.chars.reset('\n');
+                atom.chars.reset('\r');
+                ++i;
+            }
+            else if (c == '\\')
+            {
+                if (i + 1 >= p.size() || !parseEscape(p[i + 1], atom.chars))
+                    return false;
+                i += 2;
+            }
+            else if (c == '[')
+            {
+                ++i;
+                if (!parseBracket(p, i, atom.chars))
+                    return false;
+            }
+            else if (string_view("()|*+?{}]^$").find(c) != string_view::npos)
+                return false;
+            else
+            {
+                atom.chars.set(static_cast<unsigned char>(c));
+                ++i;
+            }
+
+            if (!parseQuantifier(p, i, atom))
+                return false;
+            atoms.push_back(atom);
+        }
+
+        // jede Wiederholung wird zu einzelnen Positionen, Bit 0 bleibt für den Start
+        int position = 0;
+        auto addPosition = [&](const charSet& chars, bool optional, bool repeat) {
+            if (++position > 63)
+                return false;
+            uint64_t bit = uint64_t(1) << position;
+            for (int c = 0; c < 256; ++c)
+            {
+                if (chars[c])
+                    charMask[c] |= bit;
+            }
+            if (optional)
+                optionalMask |= bit;
+            if (repeat)
+                repeatMask |= bit;
+            return true;
+        };
+
+        for (const PatternAtom& atom : atoms)
+        {
+            for (int n = 0; n < atom.min; ++n)
+            {
+                if (!addPosition(atom.chars, false, atom.max < 0 && n + 1 == atom.min))
+                    return false;
+            }
+            if (atom.max < 0 && atom.min == 0)
+            {
+                if (!addPosition(atom.chars, true, true))
+                    return false;
+            }
+            for (int n = atom.min; n < atom.max; ++n)
+            {
+                if (!addPosition(atom.chars, true, false))
+                    return false;
+            }
+        }
+
+        // ein Muster das leer passen kann wird mit std::regex gesucht, dort gelten eigene Regeln für leere Treffer
+        uint64_t allPositions = (position == 63) ? ~uint64_t(1) : ((uint64_t(1) << (position + 1)) - 2);
+        if (position == 0 || (optionalMask & allPositions) == allPositions)
+            return false;
+        finalMask = uint64_t(1) << position;
+
+        int run = 0;
+        for (int n = 1; n <= position; ++n)
+        {
+            run = (optionalMask >> n & 1) ? run + 1 : 0;
+            optionalRun = max(optionalRun, run);
+        }
+
+        // ein Treffer beginnt mit der ersten Position oder einer danach, wenn alle davor optional sind
+        for (int n = 1; n <= position; ++n)
+        {
+            for (int c = 0; c < 256; ++c)
+                startChar[c] = startChar[c] || (charMask[c] >> n & 1);
+            if (!(optionalMask >> n & 1))
+                break;
+        }
+        return true;
+    }
+
+    // Siehe Header
+    PatternMatcher::PatternMatcher(std::string_view pattern)
+    {
+        compiled = compile(pattern);
+        if (!compiled)
+            fallback.emplace(pattern.begin(), pattern.end());
+    }
+
+    /**
+    * [intern]
+    * Überspringt alle optionalen Positionen die hinter einer erreichten Position liegen
+    */
+    uint64_t PatternMatcher::closure(uint64_t states) const
+    {
+        for (int n = 0; n < optionalRun; ++n)
+            states |= (states << 1) & optionalMask;
+        return states;
+    }
+
+    /**
+    * [intern]
+    * Prüft ob an pos eine Wortgrenze wie bei \b ist
+    */
+    bool PatternMatcher::anchorHolds(Anchor anchor, std::string_view text, size_t pos) const
+    {
+        if (anchor != Anchor::wordBoundary)
+            return true;
+        bool before = pos > 0 && wordChar[static_cast<unsigned char>(text[pos - 1])];
+        bool after = pos < text.size() && wordChar[static_cast<unsigned char>(text[pos])];
+        return before != after;
+    }
+
+    /**
+    * [intern]
+    * Lässt den Automaten ab start laufen bis keine Position mehr erreicht ist.
+    * Gibt das Ende des längsten Treffers zurück oder npos.
+    */
+    size_t PatternMatcher::matchAt(std::string_view text, size_t start) const
+    {
+        uint64_t states = closure(1);
+        size_t end = string_view::npos;
+        for (size_t i = start; i < text.size(); ++i)
+        {
+            uint64_t mask = charMask[static_cast<unsigned char>(text[i])];
+            states = ((states << 1) | (states & repeatMask)) & mask;
+            if (!states)
+                break;
+
+            states = closure(states);
+            if ((states & finalMask) && anchorHolds(trailing, text, i + 1) && (trailing != Anchor::textBorder || i + 1 == text.size()))
+                end = i + 1;
+        }
+        return end;
+    }
+
+    // Siehe Header
+    void PatternMatcher::forEachMatch(std::string_view text, const matchCallback& callback) const
+    {
+        if (!compiled)
+        {
+            for (cregex_iterator it(text.data(), text.data() + text.size(), *fallback), last; it != last; ++it)
+                callback({ static_cast<uint64_t>(it->position(0)), static_cast<size_t>(it->length(0)) });
+            return;
+        }
+
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            while (pos < text.size() && !startChar[static_cast<unsigned char>(text[pos])])
+                ++pos;
+            if (pos >= text.size() || (leading == Anchor::textBorder && pos != 0))
+                break;
+
+            size_t end = anchorHolds(leading, text, pos) ? matchAt(text, pos) : string_view::npos;
+            if (end != string_view::npos)
+            {
+                callback({ pos, end - pos });
+                pos = end;
+            }
+            else
+                ++pos;
+        }
+    }
+
+    // Siehe Header
+    searchList PatternMatcher::findAll(std::string_view text) const
+    {
+        searchList matches;
+        forEachMatch(text, [&](const PatternMatch& m) {
+            matches.push_back({ string(text.substr(m.position, m.length)), m.position });
+        });
+        return matches;
+    }
+
+    // Siehe Header
+    size_t PatternMatcher::count(std::string_view text) const
+    {
+        size_t matches = 0;
+        forEachMatch(text, [&matches](const PatternMatch&) { matches++; });
+        return matches;
+    }
+}
@@ -0,0 +1,99 @@
+/**
+* PatternMatcher.h
+*
+* Schnelle Suche nach einfachen regulären Ausdrücken. Ein Muster aus Zeichenklassen mit Wiederholungen wird in einen
+* bit-parallelen Automaten (Shift-And) übersetzt, der pro Zeichen nur einen Tabellenzugriff und ein paar Bitoperationen
+* braucht. Alle anderen Muster werden wie bisher mit std::regex gesucht.
+*/
+#pragma once
+#ifndef TEXTANALYSER_PATTERNMATCHER
+#define TEXTANALYSER_PATTERNMATCHER
+
+#include "TextAnalyser.h"
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <regex>
+#include <string_view>
+
+namespace AnalyserLib
+{
+	/**
+	* Ein Treffer ohne Kopie des gefundenen Textes
+	*/
+	struct PatternMatch
+	{
+		std::uint64_t position;
+		size_t length;
+	};
+
+	using matchCallback = std::function<void(const PatternMatch&)>;
+
+	/**
+	* Sucht ein Muster im Text und liefert dieselben Treffer wie std::regex (ECMAScript) mit sregex_iterator.
+	*
+	* Unterstützt werden Muster aus einer Folge von:
+	*	- Zeichen, auch mit \ maskiert, sowie \n \r \t
+	*	- . \w \W \d \D \s \S und Zeichenmengen wie [a-z_\d] oder [^,.]
+	*	- mit den Wiederholungen ? * + {n} {n,} {n,m}
+	*	- \b und ^ am Anfang, \b und $ am Ende des Musters
+	* Insgesamt höchstens 63 Zeichenpositionen, {n,m} zählt m Positionen. Muster mit Gruppen, Alternativen, faulen
+	* Wiederholungen, einem möglichen leeren Treffer oder sonstigen Ausdrücken werden mit std::regex gesucht.
+	* Die Zeichenklassen werden beim Erstellen über std::regex_traits mit der globalen locale bestimmt.
+	*/
+	class PatternMatcher
+	{
+	public:
+		/**
+		* @param	pattern: Das Muster in ECMAScript Syntax. Ein ungültiges Muster wirft wie std::regex eine std::regex_error Exception.
+		*/
+		explicit PatternMatcher(std::string_view pattern);
+
+		/**
+		* @return	Gibt zurück ob das Muster mit dem Automaten gesucht wird und nicht mit std::regex
+		*/
+		bool isCompiled() const { return compiled; }
+
+		/**
+		* Ruft callback für jeden Treffer in der Reihenfolge im Text auf. Treffer überlappen sich nicht.
+		*/
+		void forEachMatch(std::string_view text, const matchCallback& callback) const;
+
+		/**
+		* @return	Gibt alle Treffer mit einer Kopie des gefundenen Textes zurück, wie findPatterns
+		*/
+		searchList findAll(std::string_view text) const;
+
+		/**
+		* @return	Gibt die Anzahl der Treffer zurück
+		*/
+		size_t count(std::string_view text) const;
+
+	private:
+		enum class Anchor { none, wordBoundary, textBorder };
+
+		bool compile(std::string_view pattern);
+		size_t matchAt(std::string_view text, size_t start) const;
+		bool anchorHolds(Anchor anchor, std::string_view text, size_t pos) const;
+		std::uint64_t closure(std::uint64_t states) const;
+
+		bool compiled = false;
+		/// Bit i ist gesetzt wenn Position i das Zeichen akzeptiert, Bit 0 ist der Startzustand
+		std::uint64_t charMask[256] = {};
+		/// Positionen die sich wiederholen dürfen bzw. übersprungen werden können
+		std::uint64_t repeatMask = 0;
+		std::uint64_t optionalMask = 0;
+		std::uint64_t finalMask = 0;
+		/// die längste Folge von optionalen Positionen, so oft wird closure wiederholt
+		int optionalRun = 0;
+		Anchor leading = Anchor::none;
+		Anchor trailing = Anchor::none;
+		/// Zeichen mit denen ein Treffer beginnen kann
+		bool startChar[256] = {};
+		/// Zeichen die für \b als Wortzeichen gelten
+		bool wordChar[256] = {};
+		std::optional<std::regex> fallback;
+	};
+}
+
+#endif // !TEXTANALYSER_PATTERNMATCHER
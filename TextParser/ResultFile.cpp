@@ -0,0 +1,617 @@
+#include "ResultFile.h"
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /// [intern] Kennung und Version am Anfang einer Ergebnisdatei
+    constexpr char resultMagic[4] = { 'T', 'A', 'R', 'F' };
+    constexpr uint8_t resultVersion = 1;
+    /// [intern] Kennung, Version, 3 Byte Reserve und 12 Werte mit 8 Byte
+    constexpr uint64_t resultHeaderSize = 8 + 12 * 8;
+    /// [intern] Worte pro Block mit front coding und Paare pro Block
+    constexpr uint64_t wordBlockSize = 16;
+    constexpr uint64_t pairBlockSize = 64;
+
+    /**
+    * [intern]
+    * Begrenzt eine Häufigkeit aus der Datei auf den Wertebereich der Maps in AnalysisResult
+    */
+    static int clampCount(uint64_t count)
+    {
+        return count > static_cast<uint64_t>(INT_MAX) ? INT_MAX : static_cast<int>(count);
+    }
+
+    /**
+    * [intern]
+    * Liest den nächsten Eintrag eines Wortblocks. word enthält vorher das vorherige Wort des Blocks.
+    */
+    static bool readWordEntry(ByteReader& reader, string& word, uint64_t& count, bool blockStart)
+    {
+        uint64_t shared = reader.varint();
+        uint64_t suffixSize = reader.varint();
+        if (!reader.ok || shared > word.size() || (blockStart && shared != 0))
+        {
+            reader.ok = false;
+            return false;
+        }
+        string_view suffix = reader.bytes(static_cast<size_t>(suffixSize));
+        count = reader.varint();
+        if (!reader.ok)
+            return false;
+        word.resize(static_cast<size_t>(shared));
+        word.append(suffix);
+        return true;
+    }
+
+    /**
+    * [intern]
+    * Liest den nächsten Eintrag eines Paarblocks. first und second enthalten vorher das vorherige Paar des Blocks.
+    */
+    static bool readPairEntry(ByteReader& reader, uint64_t wordCount, wordId& first, wordId& second, uint64_t& count, bool blockStart)
+    {
+        uint64_t previousFirst = blockStart ? 0 : first;
+        uint64_t previousSecond = blockStart ? 0 : second;
+        uint64_t deltaFirst = reader.varint();
+        uint64_t value = reader.varint();
+        count = reader.varint();
+        uint64_t newFirst = previousFirst + deltaFirst;
+        uint64_t newSecond = (deltaFirst == 0) ? previousSecond + value : value;
+        if (!reader.ok || deltaFirst >= wordCount || newFirst >= wordCount || value >= wordCount || newSecond >= wordCount)
+        {
+            reader.ok = false;
+            return false;
+        }
+        first = static_cast<wordId>(newFirst);
+        second = static_cast<wordId>(newSecond);
+        return true;
+    }
+
+    /// [intern] Schlüssel eines Paares, sortiert wie die Paare in der Datei
+    static uint64_t pairKey(wordId first, wordId second)
+    {
+        return (static_cast<uint64_t>(first) << 32) | second;
+    }
+
+    /**
+    * [intern]
+    * Baut die Abschnitte einer Ergebnisdatei auf. Worte müssen sortiert und einmalig übergeben werden, Paare sortiert
+    * nach ihren Ids.
+    */
+    struct ResultWriter
+    {
+        vector<uint8_t> words;
+        vector<uint64_t> wordBlocks;
+        vector<uint8_t> pairs;
+        vector<uint64_t> pairBlocks;
+        uint64_t wordCount = 0;
+        uint64_t pairCount = 0;
+        string previousWord;
+        wordId previousFirst = 0;
+        wordId previousSecond = 0;
+
+        void addWord(string_view word, uint64_t count)
+        {
+            size_t shared = 0;
+            if (wordCount % wordBlockSize == 0)
+                wordBlocks.push_back(words.size());
+            else
+            {
+                size_t limit = min(previousWord.size(), word.size());
+                while (shared < limit && previousWord[shared] == word[shared])
+                    ++shared;
+            }
+            writeVarint(words, shared);
+            writeVarint(words, word.size() - shared);
+            words.insert(words.end(), word.begin() + shared, word.end());
+            writeVarint(words, count);
+            previousWord.assign(word);
+            ++wordCount;
+        }
+
+        void addPair(wordId first, wordId second, uint64_t count)
+        {
+            if (pairCount % pairBlockSize == 0)
+            {
+                pairBlocks.push_back(pairs.size());
+                previousFirst = 0;
+                previousSecond = 0;
+            }
+            writeVarint(pairs, first - previousFirst);
+            writeVarint(pairs, (first == previousFirst) ? second - previousSecond : second);
+            writeVarint(pairs, count);
+            previousFirst = first;
+            previousSecond = second;
+            ++pairCount;
+        }
+
+        bool save(const Stats& stats, const map<uint64_t, uint64_t>& lengths, const string& path) const
+        {
+            vector<uint8_t> lengthBytes;
+            writeVarint(lengthBytes, lengths.size());
+            for (const auto& [length, count] : lengths)
+            {
+                writeVarint(lengthBytes, length);
+                writeVarint(lengthBytes, count);
+            }
+
+            uint64_t wordsOffset = resultHeaderSize + lengthBytes.size();
+            uint64_t wordIndexOffset = wordsOffset + words.size();
+            uint64_t pairsOffset = wordIndexOffset + 8 * wordBlocks.size();
+            uint64_t pairIndexOffset = pairsOffset + pairs.size();
+            uint64_t fileSize = pairIndexOffset + 8 * pairBlocks.size();
+
+            vector<uint8_t> out(begin(resultMagic), end(resultMagic));
+            out.reserve(static_cast<size_t>(fileSize));
+            out.push_back(resultVersion);
+            out.insert(out.end(), 3, 0);
+            for (int64_t value : { stats.letters, stats.words, stats.sentense, stats.syllable })
+                writeFixed64(out, static_cast<uint64_t>(value));
+            for (uint64_t value : { wordCount, pairCount, resultHeaderSize, wordsOffset, wordIndexOffset, pairsOffset, pairIndexOffset, fileSize })
+                writeFixed64(out, value);
+
+            out.insert(out.end(), lengthBytes.begin(), lengthBytes.end());
+            out.insert(out.end(), words.begin(), words.end());
+            for (uint64_t block : wordBlocks)
+                writeFixed64(out, wordsOffset + block);
+            out.insert(out.end(), pairs.begin(), pairs.end());
+            for (uint64_t block : pairBlocks)
+                writeFixed64(out, pairsOffset + block);
+
+            ofstream file(path, ios::binary | ios::trunc);
+            file.write(reinterpret_cast<const char*>(out.data()), out.size());
+            return static_cast<bool>(file);
+        }
+    };
+
+    // Siehe Header
+    bool saveAnalysisResult(const AnalysisResult& result, const std::string& path)
+    {
+        unordered_map<string_view, uint64_t> counts;
+        counts.reserve(result.words.size());
+        for (const auto& [word, count] : result.words)
+            counts[word] = static_cast<uint64_t>(max(count, 0));
+        for (const auto& entry : result.pairs)
+        {
+            counts.try_emplace(entry.first.first, 0);
+            counts.try_emplace(entry.first.second, 0);
+        }
+        if (counts.size() >= invalidWordId)
+            return false;
+
+        vector<pair<string_view, uint64_t>> sorted(counts.begin(), counts.end());
+        sort(sorted.begin(), sorted.end());
+
+        ResultWriter writer;
+        unordered_map<string_view, wordId> ids;
+        ids.reserve(sorted.size());
+        for (const auto& [word, count] : sorted)
+        {
+            ids.emplace(word, static_cast<wordId>(writer.wordCount));
+            writer.addWord(word, count);
+        }
+
+        vector<tuple<wordId, wordId, uint64_t>> pairs;
+        pairs.reserve(result.pairs.size());
+        for (const auto& [words, count] : result.pairs)
+            pairs.emplace_back(ids[words.first], ids[words.second], static_cast<uint64_t>(max(count, 0)));
+        sort(pairs.begin(), pairs.end());
+        for (const auto& [first, second, count] : pairs)
+            writer.addPair(first, second, count);
+
+        map<uint64_t, uint64_t> lengths;
+        for (const auto& [length, count] : result.wordLengths)
+            lengths[static_cast<uint64_t>(max(length, 0))] += static_cast<uint64_t>(max(count, 0));
+
+        return writer.save(result.stats, lengths, path);
+    }
+
+    // Siehe Header
+    bool mergeResultFiles(constStringList& inputs, const std::string& output)
+    {
+        // die Cursor zeigen in die Dateien, deshalb darf sich der vector danach nicht mehr ändern
+        vector<ResultFile> files(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i)
+            if (!files[i].open(inputs[i]))
+                return false;
+
+        Stats stats{};
+        map<uint64_t, uint64_t> lengths;
+        for (const ResultFile& file : files)
+        {
+            Stats s = file.stats();
+            stats.letters += s.letters;
+            stats.words += s.words;
+            stats.sentense += s.sentense;
+            stats.syllable += s.syllable;
+            for (const auto& [length, count] : file.lengthCounts())
+                lengths[length] += count;
+        }
+
+        // Worte: k-way merge über die sortierten Worte, dabei wird für jede Datei alte Id -> neue Id gemerkt.
+        // Da beide Reihenfolgen sortiert sind, bleibt auch die Reihenfolge der Paare einer Datei erhalten.
+        ResultWriter writer;
+        vector<ResultFile::WordCursor> words;
+        vector<vector<wordId>> remap(files.size());
+        words.reserve(files.size());
+        bool valid = true;
+        auto wordGreater = [&](size_t a, size_t b) { return words[a].word > words[b].word; };
+        priority_queue<size_t, vector<size_t>, decltype(wordGreater)> wordHeap(wordGreater);
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            words.emplace_back(files[i]);
+            remap[i].resize(static_cast<size_t>(files[i].wordCount()));
+            if (words[i].next())
+                wordHeap.push(i);
+        }
+
+        string word;
+        while (!wordHeap.empty() && valid)
+        {
+            word = words[wordHeap.top()].word;
+            wordId id = static_cast<wordId>(writer.wordCount);
+            uint64_t count = 0;
+            while (!wordHeap.empty() && words[wordHeap.top()].word == word)
+            {
+                size_t i = wordHeap.top();
+                wordHeap.pop();
+                count += words[i].count;
+                remap[i][static_cast<size_t>(words[i].index - 1)] = id;
+                if (words[i].next())
+                {
+                    valid = valid && words[i].word > word;
+                    wordHeap.push(i);
+                }
+            }
+            writer.addWord(word, count);
+            valid = valid && writer.wordCount < invalidWordId;
+        }
+        for (size_t i = 0; i < files.size(); ++i)
+            valid = valid && words[i].index == files[i].wordCount();
+        if (!valid)
+            return false;
+
+        // Paare: k-way merge über die Paare mit den neuen Ids
+        vector<ResultFile::PairCursor> pairs;
+        vector<uint64_t> keys(files.size());
+        pairs.reserve(files.size());
+        priority_queue<pair<uint64_t, size_t>, vector<pair<uint64_t, size_t>>, greater<>> pairHeap;
+        auto advance = [&](size_t i)
+        {
+            if (!pairs[i].next())
+                return;
+            uint64_t key = pairKey(remap[i][pairs[i].first], remap[i][pairs[i].second]);
+            valid = valid && (pairs[i].index == 1 || key > keys[i]);
+            keys[i] = key;
+            pairHeap.emplace(key, i);
+        };
+        for (size_t i = 0; i < files.size(); ++i)
+        {
+            pairs.emplace_back(files[i]);
+            advance(i);
+        }
+
+        while (!pairHeap.empty() && valid)
+        {
+            uint64_t key = pairHeap.top().first;
+            uint64_t count = 0;
+            while (!pairHeap.empty() && pairHeap.top().first == key)
+            {
+                size_t i = pairHeap.top().second;
+                pairHeap.pop();
+                count += pairs[i].count;
+                advance(i);
+            }
+            writer.addPair(static_cast<wordId>(key >> 32), static_cast<wordId>(key), count);
+        }
+        for (size_t i = 0; i < files.size(); ++i)
+            valid = valid && pairs[i].index == files[i].pairCount();
+        if (!valid)
+            return false;
+
+        // erst schließen, damit output auch eine der Eingaben sein darf
+        pairs.clear();
+        words.clear();
+        files.clear();
+        return writer.save(stats, lengths, output);
+    }
+
+    // Siehe Header
+    ResultFile::ResultFile(const std::string& path)
+    {
+        open(path);
+    }
+
+    // Siehe Header
+    bool ResultFile::open(const std::string& path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+
+        string_view data = file.view();
+        if (data.size() < resultHeaderSize || data.substr(0, 4) != string_view(resultMagic, 4) || static_cast<uint8_t>(data[4]) != resultVersion)
+        {
+            close();
+            return false;
+        }
+
+        const uint8_t* p = at(8);
+        Header h;
+        h.stats.letters = static_cast<int64_t>(readFixed64(p));
+        h.stats.words = static_cast<int64_t>(readFixed64(p + 8));
+        h.stats.sentense = static_cast<int64_t>(readFixed64(p + 16));
+        h.stats.syllable = static_cast<int64_t>(readFixed64(p + 24));
+        h.wordCount = readFixed64(p + 32);
+        h.pairCount = readFixed64(p + 40);
+        h.lengthsOffset = readFixed64(p + 48);
+        h.wordsOffset = readFixed64(p + 56);
+        h.wordIndexOffset = readFixed64(p + 64);
+        h.pairsOffset = readFixed64(p + 72);
+        h.pairIndexOffset = readFixed64(p + 80);
+        uint64_t fileSize = readFixed64(p + 88);
+
+        // jeder Eintrag braucht mindestens 3 Byte, damit kann die Größe der Blocktabellen nicht überlaufen
+        uint64_t size = file.size();
+        uint64_t wordBlocks = (h.wordCount + wordBlockSize - 1) / wordBlockSize;
+        uint64_t pairBlocks = (h.pairCount + pairBlockSize - 1) / pairBlockSize;
+        h.valid = fileSize == size && h.wordCount <= size && h.pairCount <= size
+            && h.wordCount < invalidWordId
+            && h.lengthsOffset == resultHeaderSize
+            && h.lengthsOffset <= h.wordsOffset && h.wordsOffset <= h.wordIndexOffset && h.wordIndexOffset <= size
+            && h.pairsOffset == h.wordIndexOffset + 8 * wordBlocks
+            && h.pairsOffset <= h.pairIndexOffset && h.pairIndexOffset <= size
+            && size == h.pairIndexOffset + 8 * pairBlocks;
+        if (!h.valid)
+        {
+            close();
+            return false;
+        }
+        header = h;
+        return true;
+    }
+
+    // Siehe Header
+    void ResultFile::close()
+    {
+        file.close();
+        header = Header();
+    }
+
+    // Siehe Header
+    ByteReader ResultFile::wordBlock(std::uint64_t block) const
+    {
+        uint64_t offset = readFixed64(at(header.wordIndexOffset + 8 * block));
+        // eine Position außerhalb des Abschnitts ergibt einen leeren Leser, der beim ersten Wert fehlschlägt
+        if (offset < header.wordsOffset || offset > header.wordIndexOffset)
+            offset = header.wordIndexOffset;
+        return section(offset, header.wordIndexOffset);
+    }
+
+    // Siehe Header
+    ByteReader ResultFile::pairBlock(std::uint64_t block) const
+    {
+        uint64_t offset = readFixed64(at(header.pairIndexOffset + 8 * block));
+        if (offset < header.pairsOffset || offset > header.pairIndexOffset)
+            offset = header.pairIndexOffset;
+        return section(offset, header.pairIndexOffset);
+    }
+
+    // Siehe Header
+    bool ResultFile::lookup(std::string_view word, wordId& id, std::uint64_t& count) const
+    {
+        if (!header.valid || header.wordCount == 0)
+            return false;
+
+        // binäre Suche nach dem letzten Block dessen erstes Wort nicht größer ist. Das erste Wort eines Blocks ist
+        // vollständig gespeichert und wird direkt aus der Datei verglichen.
+        uint64_t low = 0;
+        uint64_t high = (header.wordCount + wordBlockSize - 1) / wordBlockSize;
+        while (low < high)
+        {
+            uint64_t middle = low + (high - low) / 2;
+            ByteReader reader = wordBlock(middle);
+            uint64_t shared = reader.varint();
+            uint64_t size = reader.varint();
+            string_view head = reader.bytes(static_cast<size_t>(size));
+            if (!reader.ok || shared != 0)
+                return false;
+            if (head <= word)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        if (low == 0)
+            return false;
+
+        uint64_t block = low - 1;
+        ByteReader reader = wordBlock(block);
+        string current;
+        uint64_t last = min(header.wordCount, (block + 1) * wordBlockSize);
+        for (uint64_t i = block * wordBlockSize; i < last; ++i)
+        {
+            if (!readWordEntry(reader, current, count, i % wordBlockSize == 0))
+                return false;
+            int order = string_view(current).compare(word);
+            if (order == 0)
+            {
+                id = static_cast<wordId>(i);
+                return true;
+            }
+            if (order > 0)
+                return false;
+        }
+        return false;
+    }
+
+    // Siehe Header
+    std::uint64_t ResultFile::count(std::string_view word) const
+    {
+        wordId id;
+        uint64_t count;
+        return lookup(word, id, count) ? count : 0;
+    }
+
+    // Siehe Header
+    wordId ResultFile::find(std::string_view word) const
+    {
+        wordId id;
+        uint64_t count;
+        return lookup(word, id, count) ? id : invalidWordId;
+    }
+
+    // Siehe Header
+    std::uint64_t ResultFile::pairCount(std::string_view first, std::string_view second) const
+    {
+        wordId firstId = find(first);
+        wordId secondId = find(second);
+        if (firstId == invalidWordId || secondId == invalidWordId || header.pairCount == 0)
+            return 0;
+
+        // wie bei lookup, das erste Paar eines Blocks ergibt sich direkt aus den ersten beiden Werten
+        uint64_t key = pairKey(firstId, secondId);
+        uint64_t low = 0;
+        uint64_t high = (header.pairCount + pairBlockSize - 1) / pairBlockSize;
+        wordId a = 0, b = 0;
+        uint64_t count = 0;
+        while (low < high)
+        {
+            uint64_t middle = low + (high - low) / 2;
+            ByteReader reader = pairBlock(middle);
+            if (!readPairEntry(reader, header.wordCount, a, b, count, true))
+                return 0;
+            if (pairKey(a, b) <= key)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        if (low == 0)
+            return 0;
+
+        uint64_t block = low - 1;
+        ByteReader reader = pairBlock(block);
+        uint64_t last = min(header.pairCount, (block + 1) * pairBlockSize);
+        for (uint64_t i = block * pairBlockSize; i < last; ++i)
+        {
+            if (!readPairEntry(reader, header.wordCount, a, b, count, i % pairBlockSize == 0))
+                return 0;
+            uint64_t current = pairKey(a, b);
+            if (current == key)
+                return count;
+            if (current > key)
+                return 0;
+        }
+        return 0;
+    }
+
+    // Siehe Header
+    std::string ResultFile::word(wordId id) const
+    {
+        if (!header.valid || id >= header.wordCount)
+            return string();
+
+        uint64_t block = id / wordBlockSize;
+        ByteReader reader = wordBlock(block);
+        string current;
+        uint64_t count;
+        for (uint64_t i = block * wordBlockSize; i <= id; ++i)
+            if (!readWordEntry(reader, current, count, i % wordBlockSize == 0))
+                return string();
+        return current;
+    }
+
+    // Siehe Header
+    std::map<std::uint64_t, std::uint64_t> ResultFile::lengthCounts() const
+    {
+        map<uint64_t, uint64_t> lengths;
+        if (!header.valid)
+            return lengths;
+
+        ByteReader reader = section(header.lengthsOffset, header.wordsOffset);
+        uint64_t entries = reader.varint();
+        for (uint64_t i = 0; i < entries && reader.ok; ++i)
+        {
+            uint64_t length = reader.varint();
+            uint64_t count = reader.varint();
+            if (reader.ok)
+                lengths[length] += count;
+        }
+        return lengths;
+    }
+
+    // Siehe Header
+    wordLengthDistibution ResultFile::wordLengths() const
+    {
+        wordLengthDistibution lengths;
+        for (const auto& [length, count] : lengthCounts())
+            lengths[clampCount(length)] = clampCount(count);
+        return lengths;
+    }
+
+    // Siehe Header
+    AnalysisResult ResultFile::toAnalysisResult() const
+    {
+        AnalysisResult result;
+        result.stats = header.stats;
+        result.wordLengths = wordLengths();
+
+        vector<string> words;
+        words.reserve(static_cast<size_t>(header.wordCount));
+        result.words.reserve(static_cast<size_t>(header.wordCount));
+        forEachWord([&](string_view word, uint64_t count)
+        {
+            words.emplace_back(word);
+            // Worte mit 0 kommen nur in den Paaren vor
+            if (count > 0)
+                result.words.emplace(word, clampCount(count));
+        });
+
+        result.pairs.reserve(static_cast<size_t>(header.pairCount));
+        forEachPair([&](wordId first, wordId second, uint64_t count)
+        {
+            if (first < words.size() && second < words.size())
+                result.pairs.emplace(strPair(words[first], words[second]), clampCount(count));
+        });
+        return result;
+    }
+
+    // Siehe Header
+    ResultFile::WordCursor::WordCursor(const ResultFile& file)
+        : file(file), reader(file.header.valid ? file.section(file.header.wordsOffset, file.header.wordIndexOffset) : ByteReader{ nullptr, nullptr })
+    {
+    }
+
+    // Siehe Header
+    bool ResultFile::WordCursor::next()
+    {
+        if (!reader.ok || index >= file.header.wordCount)
+            return false;
+        if (!readWordEntry(reader, word, count, index % wordBlockSize == 0))
+            return false;
+        ++index;
+        return true;
+    }
+
+    // Siehe Header
+    ResultFile::PairCursor::PairCursor(const ResultFile& file)
+        : file(file), reader(file.header.valid ? file.section(file.header.pairsOffset, file.header.pairIndexOffset) : ByteReader{ nullptr, nullptr })
+    {
+    }
+
+    // Siehe Header
+    bool ResultFile::PairCursor::next()
+    {
+        if (!reader.ok || index >= file.header.pairCount)
+            return false;
+        if (!readPairEntry(reader, file.header.wordCount, first, second, count, index % pairBlockSize == 0))
+            return false;
+        ++index;
+        return true;
+    }
+}
@@ -0,0 +1,196 @@
+/**
+* ResultFile.h
+*
+* Speichert ein AnalysisResult kompakt in einer Binärdatei und liest es direkt aus der gemappten Datei.
+*
+* Aufbau (Version 1): Ein Kopf mit fester Größe enthält die Stats, die Anzahl der Worte und Paare und die Positionen
+* der Abschnitte. Die Worte sind sortiert und in Blöcken von 16 mit front coding gespeichert (Länge des gemeinsamen
+* Anfangs mit dem vorherigen Wort, dann nur der Rest), hinter jedem Wort seine Häufigkeit als varint. Die Nummer eines
+* Wortes in dieser Reihenfolge ist seine Id. Die Wortpaare sind nach Ids sortiert und als Differenz zum vorherigen
+* Paar in Blöcken von 64 gespeichert. Für beide gibt es eine Tabelle mit der Position jedes Blocks, eine Suche
+* braucht so nur eine binäre Suche über die Blöcke und das Entpacken eines einzigen Blocks.
+*
+* Weil die Ids der sortierten Worte beim Zusammenführen ihre Reihenfolge behalten, können viele Dateien in einem
+* Durchlauf gemischt werden (k-way merge), ohne eine davon komplett zu entpacken.
+*/
+#pragma once
+#ifndef TEXTANALYSER_RESULTFILE
+#define TEXTANALYSER_RESULTFILE
+
+#include "BinaryCoding.h"
+#include "MappedFile.h"
+#include "TextAnalyser.h"
+#include <cstdint>
+
+namespace AnalyserLib
+{
+	/**
+	* Speichert ein Ergebnis. Worte die nur in den Wortpaaren vorkommen (z.B. lowercase Paare bei einer Wortverteilung
+	* mit Groß- und Kleinschreibung) bekommen die Häufigkeit 0.
+	*
+	* @return	Gibt false zurück wenn die Datei nicht geschrieben werden konnte
+	*/
+	bool saveAnalysisResult(const AnalysisResult& result, const std::string& path);
+
+	/**
+	* Führt mehrere mit saveAnalysisResult gespeicherte Dateien zu einer zusammen. Stats, Wortlängen, Worte und Paare
+	* werden addiert. Jede Eingabe wird nur einmal der Reihe nach gelesen.
+	*
+	* @param	inputs: Die Dateien, z.B. die Ergebnisse einzelner Tage
+	*			output: Die neue Datei. Sie wird erst geschrieben wenn alle Eingaben gelesen sind und darf eine davon sein.
+	* @return	Gibt false zurück wenn eine Eingabe ungültig ist oder die Ausgabe nicht geschrieben werden konnte
+	*/
+	bool mergeResultFiles(constStringList& inputs, const std::string& output);
+
+	/**
+	* Eine mit saveAnalysisResult gespeicherte Datei, nur zum lesen. Die Datei wird gemappt, Abfragen lesen direkt
+	* daraus ohne das Ergebnis vorher zu entpacken. Nach open kann die Datei von mehreren Threads gelesen werden.
+	*/
+	class ResultFile
+	{
+	public:
+		ResultFile() = default;
+
+		/**
+		* Öffnet die Datei direkt, siehe open()
+		*/
+		explicit ResultFile(const std::string& path);
+
+		/**
+		* Öffnet eine Datei und prüft Kennung, Version und die Grenzen der Abschnitte
+		*
+		* @return	false wenn die Datei nicht gelesen werden kann oder kein gültiges Ergebnis ist
+		*/
+		bool open(const std::string& path);
+
+		void close();
+
+		bool isOpen() const { return header.valid; }
+
+		Stats stats() const { return header.stats; }
+
+		/// Anzahl der unterschiedlichen Worte, inklusive denen die nur in Paaren vorkommen
+		std::uint64_t wordCount() const { return header.wordCount; }
+
+		/// Anzahl der unterschiedlichen Wortpaare
+		std::uint64_t pairCount() const { return header.pairCount; }
+
+		/**
+		* @return	Gibt die Häufigkeit des Wortes zurück, 0 wenn es nicht vorkommt
+		*/
+		std::uint64_t count(std::string_view word) const;
+
+		/**
+		* @return	Gibt die Häufigkeit des Wortpaares zurück, 0 wenn es nicht vorkommt
+		*/
+		std::uint64_t pairCount(std::string_view first, std::string_view second) const;
+
+		/**
+		* @return	Gibt die Id des Wortes zurück (seine Nummer in der sortierten Reihenfolge), invalidWordId wenn es fehlt
+		*/
+		wordId find(std::string_view word) const;
+
+		/**
+		* @return	Gibt das Wort mit der Id zurück, einen leeren string wenn es die Id nicht gibt
+		*/
+		std::string word(wordId id) const;
+
+		/**
+		* Häufigkeiten über INT_MAX werden abgeschnitten, siehe lengthCounts
+		*/
+		wordLengthDistibution wordLengths() const;
+
+		/**
+		* Die Wortlängen ohne Begrenzung, z.B. für die Summe vieler Dateien
+		*/
+		std::map<std::uint64_t, std::uint64_t> lengthCounts() const;
+
+		/**
+		* Ruft f(std::string_view word, std::uint64_t count) für jedes Wort in sortierter Reihenfolge auf.
+		* Der string_view ist nur während des Aufrufs gültig.
+		*/
+		template<class F>
+		void forEachWord(F&& f) const
+		{
+			WordCursor cursor(*this);
+			while (cursor.next())
+				f(std::string_view(cursor.word), cursor.count);
+		}
+
+		/**
+		* Ruft f(wordId first, wordId second, std::uint64_t count) für jedes Paar auf, sortiert nach den Ids
+		*/
+		template<class F>
+		void forEachPair(F&& f) const
+		{
+			PairCursor cursor(*this);
+			while (cursor.next())
+				f(cursor.first, cursor.second, cursor.count);
+		}
+
+		/**
+		* Entpackt die ganze Datei. Häufigkeiten über INT_MAX werden abgeschnitten.
+		*/
+		AnalysisResult toAnalysisResult() const;
+
+		/**
+		* [intern]
+		* Liest die Worte der Reihe nach, wird auch von mergeResultFiles genutzt
+		*/
+		struct WordCursor
+		{
+			explicit WordCursor(const ResultFile& file);
+			bool next();
+
+			const ResultFile& file;
+			std::uint64_t index = 0;
+			std::string word;
+			std::uint64_t count = 0;
+		private:
+			ByteReader reader;
+		};
+
+		/**
+		* [intern]
+		* Liest die Paare der Reihe nach
+		*/
+		struct PairCursor
+		{
+			explicit PairCursor(const ResultFile& file);
+			bool next();
+
+			const ResultFile& file;
+			std::uint64_t index = 0;
+			wordId first = 0;
+			wordId second = 0;
+			std::uint64_t count = 0;
+		private:
+			ByteReader reader;
+		};
+
+	private:
+		struct Header
+		{
+			bool valid = false;
+			Stats stats{};
+			std::uint64_t wordCount = 0;
+			std::uint64_t pairCount = 0;
+			std::uint64_t lengthsOffset = 0;
+			std::uint64_t wordsOffset = 0;
+			std::uint64_t wordIndexOffset = 0;
+			std::uint64_t pairsOffset = 0;
+			std::uint64_t pairIndexOffset = 0;
+		};
+
+		const std::uint8_t* at(std::uint64_t offset) const { return reinterpret_cast<const std::uint8_t*>(file.view().data()) + offset; }
+		ByteReader section(std::uint64_t begin, std::uint64_t end) const { return ByteReader{ at(begin), at(end) }; }
+		ByteReader wordBlock(std::uint64_t block) const;
+		ByteReader pairBlock(std::uint64_t block) const;
+		bool lookup(std::string_view word, wordId& id, std::uint64_t& count) const;
+
+		MappedFile file;
+		Header header;
+	};
+}
+
+#endif // !TEXTANALYSER_RESULTFILE
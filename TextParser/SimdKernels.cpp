@@ -0,0 +1,565 @@
+#include "SimdKernels.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define ANALYSER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /**
+    * [intern]
+    * Die Bitmasken für einen Block von 64 Zeichen. Bit i steht für das Zeichen i im Block.
+    */
+    struct BlockMasks
+    {
+        uint64_t letter;
+        uint64_t wordEnd;
+        uint64_t sentenceEnd;
+        uint64_t vowel;
+    };
+
+    /**
+    * [intern]
+    * Die Bytes einer Zeichenklasse aus der CharTable, mit denen in den Kernels verglichen wird
+    */
+    struct ByteSet
+    {
+        unsigned char bytes[16];
+        int count = 0;
+
+        bool add(int c)
+        {
+            if (count == 16)
+                return false;
+            bytes[count++] = static_cast<unsigned char>(c);
+            return true;
+        }
+    };
+
+    /**
+    * [intern]
+    * Die Zeichenklassen für die Kernels. Wortende und Satzende enthalten nur Zeichen die keine Buchstaben sind,
+    * Vokale nur Buchstaben. So muss in den Kernels nicht mehr nach Buchstaben gefiltert werden.
+    */
+    struct KernelSets
+    {
+        ByteSet wordEnd;
+        ByteSet sentenceEnd;
+        ByteSet vowel;
+    };
+
+    /// Deutsche Sonderzeichen in Latin-1, die in makeCharTable als Buchstaben eingetragen werden (Ä liegt in den UTF-8 Startbytes)
+    static const unsigned char latinLetters[] = { 0xE4, 0xD6, 0xF6, 0xDC, 0xFC, 0xDF };
+    /// Die UTF-8 Startbytes 0xC3 bis 0xC9 aus makeCharTable
+    constexpr unsigned char utf8LeadFirst = 0xC3;
+    constexpr unsigned char utf8LeadCount = 7;
+
+    /**
+    * [intern]
+    * Liest die Zeichenklassen aus der Tabelle. Gibt false zurück wenn die Tabelle andere Buchstaben hat
+    * oder eine Klasse mehr als 16 Zeichen enthält.
+    */
+    bool makeKernelSets(const CharTable& table, KernelSets& sets)
+    {
+        for (int c = 0; c < 256; ++c)
+        {
+            unsigned char flags = table.flags[c];
+            if ((flags & charLetter) != (defaultCharTable.flags[c] & charLetter))
+                return false;
+
+            if (flags & charLetter)
+            {
+                if ((flags & charVowel) && !sets.vowel.add(c))
+                    return false;
+            }
+            else
+            {
+                if ((flags & charWordEnd) && !sets.wordEnd.add(c))
+                    return false;
+                if ((flags & charSentenceEnd) && !sets.sentenceEnd.add(c))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+    * [intern]
+    * popcount für 64 Bit
+    */
+    inline int bitCount(uint64_t v)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll(v);
+#else
+        v = v - ((v >> 1) & 0x5555555555555555ULL);
+        v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+        v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<int>((v * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    /**
+    * [intern]
+    * Index des niedrigsten gesetzten Bits, v darf nicht 0 sein
+    */
+    inline int lowestBit(uint32_t v)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctz(v);
+#else
+        unsigned long idx;
+        _BitScanForward(&idx, v);
+        return static_cast<int>(idx);
+#endif
+    }
+
+    /**
+    * [intern]
+    * a + b + carry mit dem Übertrag aus Bit 63 in carry
+    */
+    inline uint64_t addWithCarry(uint64_t a, uint64_t b, bool& carry)
+    {
+        uint64_t sum = a + b;
+        bool c1 = sum < a;
+        uint64_t res = sum + (carry ? 1 : 0);
+        bool c2 = res < sum;
+        carry = c1 || c2;
+        return res;
+    }
+
+    /**
+    * [intern]
+    * Der Zähler für die Kernels. Die Werte werden am Ende in Stats übertragen.
+    */
+    struct KernelCounts
+    {
+        int64_t letters = 0;
+        int64_t words = 0;
+        int64_t sentences = 0;
+        int64_t syllableEnds = 0;
+    };
+
+    /**
+    * [intern]
+    * Wertet die Bitmasken eines Blocks aus.
+    *
+    * Worte: Alle Zeichen die kein Wortende sind bilden Läufe zwischen den Wortenden. Wenn auf einen Lauf die Buchstaben
+    * addiert werden, läuft der Übertrag genau bis zum Wortende hinter dem Lauf, aber nur wenn im Lauf ein Buchstabe war.
+    * Die gesetzten Bits an den Wortenden sind also die beendeten Worte. Ein offenes Wort läuft über Bit 63 hinaus und
+    * kommt als carry in den nächsten Block.
+    *
+    * Silben: Genauso mit Konsonanten als Grenze und Vokalen als Addition. Gezählt wird das Ende einer Vokalfolge,
+    * die Anzahl der Anfänge ergibt sich daraus mit dem Zustand am Anfang und am Ende.
+    */
+    inline void accumulateBlock(const BlockMasks& m, ScanState& state, KernelCounts& counts)
+    {
+        bool inWord = state.inWord;
+        uint64_t ended = addWithCarry(~m.wordEnd, m.letter, inWord) & m.wordEnd;
+        counts.words += bitCount(ended);
+        counts.sentences += bitCount(ended & m.sentenceEnd);
+        counts.letters += bitCount(m.letter);
+        state.inWord = inWord;
+
+        uint64_t consonant = m.letter & ~m.vowel;
+        bool lastVowel = state.lastVowel;
+        uint64_t vowelEnds = addWithCarry(~consonant, m.vowel, lastVowel) & consonant;
+        counts.syllableEnds += bitCount(vowelEnds) + (lastVowel ? 1 : 0) - (state.lastVowel ? 1 : 0);
+        state.lastVowel = lastVowel;
+    }
+
+#ifdef ANALYSER_X86
+    // ---------------------------------------------------
+    // SSE2
+
+    /**
+    * [intern]
+    * Die Vergleichswerte der KernelSets für SSE2
+    */
+    struct SseSets
+    {
+        __m128i wordEnd[16];
+        __m128i sentenceEnd[16];
+        __m128i vowel[16];
+        int wordEndCount, sentenceEndCount, vowelCount;
+    };
+
+    TARGET_SSE2 void makeSseSets(const KernelSets& sets, SseSets& sse)
+    {
+        for (int i = 0; i < sets.wordEnd.count; ++i)
+            sse.wordEnd[i] = _mm_set1_epi8(static_cast<char>(sets.wordEnd.bytes[i]));
+        for (int i = 0; i < sets.sentenceEnd.count; ++i)
+            sse.sentenceEnd[i] = _mm_set1_epi8(static_cast<char>(sets.sentenceEnd.bytes[i]));
+        for (int i = 0; i < sets.vowel.count; ++i)
+            sse.vowel[i] = _mm_set1_epi8(static_cast<char>(sets.vowel.bytes[i]));
+        sse.wordEndCount = sets.wordEnd.count;
+        sse.sentenceEndCount = sets.sentenceEnd.count;
+        sse.vowelCount = sets.vowel.count;
+    }
+
+    /**
+    * [intern]
+    * Buchstaben in 16 Zeichen: a-z, A-Z und die UTF-8 Startbytes über vorzeichenlose Bereichsvergleiche, dazu die Latin-1 Sonderzeichen
+    */
+    TARGET_SSE2 inline __m128i lettersSse(__m128i x)
+    {
+        __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        __m128i res = _mm_cmplt_epi8(_mm_add_epi8(lower, _mm_set1_epi8(128 - 'a')), _mm_set1_epi8(-128 + 26));
+        res = _mm_or_si128(res, _mm_cmplt_epi8(_mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(128 - utf8LeadFirst))), _mm_set1_epi8(-128 + utf8LeadCount)));
+        for (unsigned char c : latinLetters)
+            res = _mm_or_si128(res, _mm_cmpeq_epi8(x, _mm_set1_epi8(static_cast<char>(c))));
+        return res;
+    }
+
+    TARGET_SSE2 inline uint32_t matchSse(__m128i x, const __m128i* set, int count)
+    {
+        __m128i res = _mm_setzero_si128();
+        for (int i = 0; i < count; ++i)
+            res = _mm_or_si128(res, _mm_cmpeq_epi8(x, set[i]));
+        return static_cast<uint32_t>(_mm_movemask_epi8(res));
+    }
+
+    TARGET_SSE2 inline BlockMasks classifySse(const char* p, const SseSets& sets)
+    {
+        BlockMasks m = { 0, 0, 0, 0 };
+        for (int k = 0; k < 4; ++k)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+            int shift = 16 * k;
+            m.letter |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(lettersSse(x)))) << shift;
+            m.wordEnd |= static_cast<uint64_t>(matchSse(x, sets.wordEnd, sets.wordEndCount)) << shift;
+            m.sentenceEnd |= static_cast<uint64_t>(matchSse(x, sets.sentenceEnd, sets.sentenceEndCount)) << shift;
+            m.vowel |= static_cast<uint64_t>(matchSse(x, sets.vowel, sets.vowelCount)) << shift;
+        }
+        return m;
+    }
+
+    TARGET_SSE2 void countSse2(const char* p, size_t n, const KernelSets& kernelSets, ScanState& state, KernelCounts& counts)
+    {
+        SseSets sets;
+        makeSseSets(kernelSets, sets);
+
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64)
+            accumulateBlock(classifySse(p + i, sets), state, counts);
+
+        if (i < n)
+        {
+            // der Rest wird mit 0 aufgefüllt, die Bits dahinter werden ausgeblendet
+            alignas(16) char tail[64] = {};
+            memcpy(tail, p + i, n - i);
+            uint64_t valid = (~0ULL) >> (64 - (n - i));
+            BlockMasks m = classifySse(tail, sets);
+            m = { m.letter & valid, m.wordEnd & valid, m.sentenceEnd & valid, m.vowel & valid };
+            accumulateBlock(m, state, counts);
+        }
+    }
+
+    TARGET_SSE2 size_t findLetterSse2(const char* p, size_t pos, size_t n)
+    {
+        for (; pos + 16 <= n; pos += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + pos));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(lettersSse(x)));
+            if (mask)
+                return pos + lowestBit(mask);
+        }
+        for (; pos < n; ++pos)
+        {
+            if (defaultCharTable[p[pos]] & charLetter)
+                return pos;
+        }
+        return n;
+    }
+
+    TARGET_SSE2 inline uint32_t defaultWordEndSse(__m128i x)
+    {
+        __m128i res = _mm_setzero_si128();
+        for (char c : string_view(defaultWordEnd))
+            res = _mm_or_si128(res, _mm_cmpeq_epi8(x, _mm_set1_epi8(c)));
+        return static_cast<uint32_t>(_mm_movemask_epi8(res));
+    }
+
+    TARGET_SSE2 size_t findWordEndSse2(const char* p, size_t pos, size_t n)
+    {
+        for (; pos + 16 <= n; pos += 16)
+        {
+            uint32_t mask = defaultWordEndSse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + pos)));
+            if (mask)
+                return pos + lowestBit(mask);
+        }
+        for (; pos < n; ++pos)
+        {
+            if (defaultCharTable[p[pos]] & charWordEnd)
+                return pos;
+        }
+        return n;
+    }
+
+    // ---------------------------------------------------
+    // AVX2
+
+    struct AvxSets
+    {
+        __m256i wordEnd[16];
+        __m256i sentenceEnd[16];
+        __m256i vowel[16];
+        int wordEndCount, sentenceEndCount, vowelCount;
+    };
+
+    TARGET_AVX2 void makeAvxSets(const KernelSets& sets, AvxSets& avx)
+    {
+        for (int i = 0; i < sets.wordEnd.count; ++i)
+            avx.wordEnd[i] = _mm256_set1_epi8(static_cast<char>(sets.wordEnd.bytes[i]));
+        for (int i = 0; i < sets.sentenceEnd.count; ++i)
+            avx.sentenceEnd[i] = _mm256_set1_epi8(static_cast<char>(sets.sentenceEnd.bytes[i]));
+        for (int i = 0; i < sets.vowel.count; ++i)
+            avx.vowel[i] = _mm256_set1_epi8(static_cast<char>(sets.vowel.bytes[i]));
+        avx.wordEndCount = sets.wordEnd.count;
+        avx.sentenceEndCount = sets.sentenceEnd.count;
+        avx.vowelCount = sets.vowel.count;
+    }
+
+    TARGET_AVX2 inline __m256i lettersAvx(__m256i x)
+    {
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i res = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), _mm256_add_epi8(lower, _mm256_set1_epi8(128 - 'a')));
+        res = _mm256_or_si256(res, _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + utf8LeadCount), _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(128 - utf8LeadFirst)))));
+        for (unsigned char c : latinLetters)
+            res = _mm256_or_si256(res, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(static_cast<char>(c))));
+        return res;
+    }
+
+    TARGET_AVX2 inline uint32_t matchAvx(__m256i x, const __m256i* set, int count)
+    {
+        __m256i res = _mm256_setzero_si256();
+        for (int i = 0; i < count; ++i)
+            res = _mm256_or_si256(res, _mm256_cmpeq_epi8(x, set[i]));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(res));
+    }
+
+    TARGET_AVX2 inline BlockMasks classifyAvx(const char* p, const AvxSets& sets)
+    {
+        BlockMasks m = { 0, 0, 0, 0 };
+        for (int k = 0; k < 2; ++k)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * k));
+            int shift = 32 * k;
+            m.letter |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(lettersAvx(x)))) << shift;
+            m.wordEnd |= static_cast<uint64_t>(matchAvx(x, sets.wordEnd, sets.wordEndCount)) << shift;
+            m.sentenceEnd |= static_cast<uint64_t>(matchAvx(x, sets.sentenceEnd, sets.sentenceEndCount)) << shift;
+            m.vowel |= static_cast<uint64_t>(matchAvx(x, sets.vowel, sets.vowelCount)) << shift;
+        }
+        return m;
+    }
+
+    TARGET_AVX2 void countAvx2(const char* p, size_t n, const KernelSets& kernelSets, ScanState& state, KernelCounts& counts)
+    {
+        AvxSets sets;
+        makeAvxSets(kernelSets, sets);
+
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64)
+            accumulateBlock(classifyAvx(p + i, sets), state, counts);
+
+        if (i < n)
+        {
+            alignas(32) char tail[64] = {};
+            memcpy(tail, p + i, n - i);
+            uint64_t valid = (~0ULL) >> (64 - (n - i));
+            BlockMasks m = classifyAvx(tail, sets);
+            m = { m.letter & valid, m.wordEnd & valid, m.sentenceEnd & valid, m.vowel & valid };
+            accumulateBlock(m, state, counts);
+        }
+    }
+
+    TARGET_AVX2 size_t findLetterAvx2(const char* p, size_t pos, size_t n)
+    {
+        for (; pos + 32 <= n; pos += 32)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + pos));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(lettersAvx(x)));
+            if (mask)
+                return pos + lowestBit(mask);
+        }
+        return findLetterSse2(p, pos, n);
+    }
+
+    TARGET_AVX2 size_t findWordEndAvx2(const char* p, size_t pos, size_t n)
+    {
+        for (; pos + 32 <= n; pos += 32)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + pos));
+            __m256i res = _mm256_setzero_si256();
+            for (char c : string_view(defaultWordEnd))
+                res = _mm256_or_si256(res, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(c)));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(res));
+            if (mask)
+                return pos + lowestBit(mask);
+        }
+        return findWordEndSse2(p, pos, n);
+    }
+#endif // ANALYSER_X86
+
+    // ---------------------------------------------------
+    // Dispatch
+
+    /**
+    * [intern]
+    * cpuid abfragen, für AVX2 muss auch das Betriebssystem die YMM Register sichern (OSXSAVE + XCR0)
+    */
+    simdLevel detectSimdLevel()
+    {
+#ifdef ANALYSER_X86
+        unsigned int regs1[4] = {}, regs7[4] = {};
+        unsigned int maxLeaf = 0;
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        maxLeaf = static_cast<unsigned int>(info[0]);
+        __cpuid(info, 1);
+        for (int i = 0; i < 4; ++i)
+            regs1[i] = static_cast<unsigned int>(info[i]);
+        if (maxLeaf >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            for (int i = 0; i < 4; ++i)
+                regs7[i] = static_cast<unsigned int>(info[i]);
+        }
+#else
+        maxLeaf = __get_cpuid_max(0, nullptr);
+        __get_cpuid(1, &regs1[0], &regs1[1], &regs1[2], &regs1[3]);
+        if (maxLeaf >= 7)
+            __cpuid_count(7, 0, regs7[0], regs7[1], regs7[2], regs7[3]);
+#endif
+        bool sse2 = (regs1[3] & (1u << 26)) != 0;
+        bool osxsave = (regs1[2] & (1u << 27)) != 0;
+        bool avx = (regs1[2] & (1u << 28)) != 0;
+        bool popcnt = (regs1[2] & (1u << 23)) != 0;
+        bool avx2 = (regs7[1] & (1u << 5)) != 0;
+
+        if (osxsave && avx && avx2 && popcnt)
+        {
+#ifdef _MSC_VER
+            unsigned long long xcr0 = _xgetbv(0);
+#else
+            unsigned int eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+            if ((xcr0 & 6) == 6)
+                return simdAVX2;
+        }
+        if (sse2)
+            return simdSSE2;
+#endif
+        return simdNone;
+    }
+
+    /// der aktuell genutzte simdLevel, wird beim ersten Aufruf über cpuid ermittelt
+    static atomic<int> usedSimdLevel{ -1 };
+
+    // Siehe Header
+    simdLevel getSimdLevel()
+    {
+        int level = usedSimdLevel.load(memory_order_relaxed);
+        if (level < 0)
+        {
+            level = detectSimdLevel();
+            usedSimdLevel.store(level, memory_order_relaxed);
+        }
+        return static_cast<simdLevel>(level);
+    }
+
+    // Siehe Header
+    void setSimdLevel(simdLevel level)
+    {
+        simdLevel detected = detectSimdLevel();
+        usedSimdLevel.store(level < detected ? level : detected, memory_order_relaxed);
+    }
+
+    // Siehe Header
+    bool countStatsSimd(std::string_view text, const CharTable& table, Stats& stat, ScanState& state)
+    {
+#ifdef ANALYSER_X86
+        simdLevel level = getSimdLevel();
+        if (level == simdNone)
+            return false;
+
+        static const KernelSets defaultSets = [] { KernelSets s; makeKernelSets(defaultCharTable, s); return s; }();
+        KernelSets customSets;
+        const KernelSets* sets = &defaultSets;
+        if (memcmp(table.flags, defaultCharTable.flags, sizeof(table.flags)) != 0)
+        {
+            if (!makeKernelSets(table, customSets))
+                return false;
+            sets = &customSets;
+        }
+
+        KernelCounts counts;
+        if (level == simdAVX2)
+            countAvx2(text.data(), text.size(), *sets, state, counts);
+        else
+            countSse2(text.data(), text.size(), *sets, state, counts);
+
+        stat.letters += static_cast<int64_t>(counts.letters);
+        stat.words += static_cast<int64_t>(counts.words);
+        stat.sentense += static_cast<int64_t>(counts.sentences);
+        stat.syllable += static_cast<int64_t>(counts.syllableEnds);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Siehe Header
+    size_t findLetterSimd(std::string_view text, size_t pos)
+    {
+#ifdef ANALYSER_X86
+        switch (getSimdLevel())
+        {
+        case simdAVX2: return findLetterAvx2(text.data(), pos, text.size());
+        case simdSSE2: return findLetterSse2(text.data(), pos, text.size());
+        default: break;
+        }
+#endif
+        while (pos < text.size() && !(defaultCharTable[text[pos]] & charLetter))
+            ++pos;
+        return pos;
+    }
+
+    // Siehe Header
+    size_t findWordEndSimd(std::string_view text, size_t pos)
+    {
+#ifdef ANALYSER_X86
+        switch (getSimdLevel())
+        {
+        case simdAVX2: return findWordEndAvx2(text.data(), pos, text.size());
+        case simdSSE2: return findWordEndSse2(text.data(), pos, text.size());
+        default: break;
+        }
+#endif
+        while (pos < text.size() && !(defaultCharTable[text[pos]] & charWordEnd))
+            ++pos;
+        return pos;
+    }
+}
@@ -0,0 +1,84 @@
+/**
+* SimdKernels.h
+*
+* SSE2 und AVX2 Kernels für das Zählen von Buchstaben, Worten, Sätzen und Silben und für die Suche nach Wortgrenzen.
+* Es werden immer 16 bzw. 32 Zeichen auf einmal eingeteilt. Aus den Bitmasken werden die Werte mit popcount berechnet.
+* Welche Version genutzt wird entscheidet cpuid zur Laufzeit, ohne SIMD wird eine normale Schleife genutzt.
+*/
+#pragma once
+#ifndef TEXTANALYSER_SIMD
+#define TEXTANALYSER_SIMD
+
+#include "TextAnalyser.h"
+
+namespace AnalyserLib
+{
+	/**
+	* Die SIMD Befehlssätze die von den Kernels unterstützt werden
+	*/
+	enum simdLevel
+	{
+		simdNone = 0,
+		simdSSE2 = 1,
+		simdAVX2 = 2
+	};
+
+	/**
+	* Fragt per cpuid ab welcher Befehlssatz von CPU und Betriebssystem unterstützt wird
+	*
+	* @return	Gibt den höchsten nutzbaren simdLevel zurück
+	*/
+	simdLevel detectSimdLevel();
+
+	/**
+	* @return	Gibt den simdLevel zurück der aktuell von den Kernels genutzt wird
+	*/
+	simdLevel getSimdLevel();
+
+	/**
+	* Legt fest welcher Befehlssatz genutzt werden soll, z.B. zum testen der anderen Versionen.
+	* Der Wert wird auf detectSimdLevel() begrenzt.
+	*
+	* @param	level: Der gewünschte simdLevel
+	*/
+	void setSimdLevel(simdLevel level);
+
+	/**
+	* Der Zustand am Ende eines Textstücks. Damit kann ein Text in mehreren Teilen gezählt werden.
+	*/
+	struct ScanState
+	{
+		/// das letzte Zeichen gehört zu einem Wort das noch nicht beendet ist
+		bool inWord = false;
+		/// der letzte Buchstabe war ein Vokal
+		bool lastVowel = false;
+	};
+
+	/**
+	* Zählt Buchstaben, Worte, Sätze und Silben wie analyseText mit metricStats.
+	* Ein offenes Wort am Ende wird nicht gezählt sondern bleibt in state.inWord stehen.
+	*
+	* @param	text: Der Text oder ein Teil des Textes
+	*			table: Die Zeichentabelle. Die Buchstaben müssen denen von makeCharTable entsprechen.
+	*			stat: Die Werte werden auf stat addiert
+	*			state: Zustand vom vorherigen Teil, wird auf den Zustand am Ende gesetzt
+	* @return	false wenn die Tabelle oder die CPU nicht unterstützt wird, dann wurde nichts gezählt
+	*/
+	bool countStatsSimd(std::string_view text, const CharTable& table, Stats& stat, ScanState& state);
+
+	/**
+	* Sucht den nächsten Buchstaben ab pos
+	*
+	* @return	Gibt die Position zurück oder text.size() wenn es keinen gibt
+	*/
+	size_t findLetterSimd(std::string_view text, size_t pos);
+
+	/**
+	* Sucht das nächste Wortende aus defaultWordEnd ab pos
+	*
+	* @return	Gibt die Position zurück oder text.size() wenn es keines gibt
+	*/
+	size_t findWordEndSimd(std::string_view text, size_t pos);
+}
+
+#endif // !TEXTANALYSER_SIMD
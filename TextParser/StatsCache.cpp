@@ -0,0 +1,262 @@
+#include "StatsCache.h"
+#include <cstring>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /**
+    * [intern]
+    * Durchmischt einen 64 bit Wert (Finalizer von MurmurHash3)
+    */
+    static inline uint64_t mixStatsHash(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /// [intern] Rotation nach links
+    static inline uint64_t rotateLeft(uint64_t v, int bits)
+    {
+        return (v << bits) | (v >> (64 - bits));
+    }
+
+    /**
+    * [intern]
+    * Berechnet zwei unabhängige 64 bit Hashes in einem Durchlauf über den Text, jeweils 8 Zeichen auf einmal
+    */
+    static void hashText(string_view text, uint64_t& hash1, uint64_t& hash2)
+    {
+        uint64_t a = 0x9e3779b97f4a7c15ULL ^ text.size();
+        uint64_t b = 0xc2b2ae3d27d4eb4fULL + text.size();
+
+        size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8)
+        {
+            uint64_t v;
+            memcpy(&v, text.data() + i, 8);
+            a = rotateLeft(a ^ (v * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+            b = rotateLeft(b + (v * 0x52dce729ULL), 27) * 0x9e3779b97f4a7c15ULL + 0x38495ab5ULL;
+        }
+
+        uint64_t tail = 0;
+        if (i < text.size())
+            memcpy(&tail, text.data() + i, text.size() - i);
+        a = rotateLeft(a ^ (tail * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+        b = rotateLeft(b + (tail * 0x52dce729ULL), 27) * 0x9e3779b97f4a7c15ULL + 0x38495ab5ULL;
+
+        hash1 = mixStatsHash(a);
+        hash2 = mixStatsHash(b ^ hash1);
+    }
+
+    /// [intern] Trennzeichen für den Schlüssel
+    static string makeSeparators(string_view wordEnd, string_view sentenceEnd)
+    {
+        string separators(wordEnd);
+        separators += '\0';
+        separators += sentenceEnd;
+        return separators;
+    }
+
+    // Siehe Header
+    size_t StatsCache::KeyHash::operator()(const StatsKey& key) const
+    {
+        uint64_t h = key.hash1 ^ mixStatsHash(key.id + key.isDocument);
+        h ^= hash<string>{}(key.separators) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(mixStatsHash(h));
+    }
+
+    /**
+    * [intern]
+    * Anzahl der genutzten Shards: die größte Zweierpotenz die weder mehr Shards noch mehr als capacity ergibt, 0 für capacity 0
+    */
+    static size_t activeShardCount(size_t capacity, size_t shardCount)
+    {
+        if (capacity == 0)
+            return 0;
+        size_t n = 1;
+        while (n * 2 <= min(capacity, shardCount))
+            n <<= 1;
+        return n;
+    }
+
+    // Siehe Header
+    StatsCache::StatsCache(size_t capacity, size_t shardCount)
+        : shards([&] { size_t n = 1; while (n < shardCount) n <<= 1; return n; }()),
+        activeShards(activeShardCount(capacity, shards.size())),
+        shardCapacity(activeShards ? capacity / activeShards : 0)
+    {
+    }
+
+    // Siehe Header
+    StatsKey StatsCache::makeKey(std::string_view text, std::string_view wordEnd, std::string_view sentenceEnd)
+    {
+        StatsKey key;
+        key.id = text.size();
+        hashText(text, key.hash1, key.hash2);
+        key.separators = makeSeparators(wordEnd, sentenceEnd);
+        return key;
+    }
+
+    // Siehe Header
+    StatsKey StatsCache::makeKey(std::uint64_t documentId, std::string_view wordEnd, std::string_view sentenceEnd)
+    {
+        StatsKey key;
+        key.isDocument = true;
+        key.id = documentId;
+        key.separators = makeSeparators(wordEnd, sentenceEnd);
+        return key;
+    }
+
+    // Siehe Header
+    bool StatsCache::find(const StatsKey& key, Stats& stats)
+    {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end())
+        {
+            misses.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        stats = it->second->second;
+        hits.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    // Siehe Header
+    void StatsCache::insert(const StatsKey& key, const Stats& stats)
+    {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end())
+        {
+            it->second->second = stats;
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            return;
+        }
+
+        // ein Shard der nach setCapacity nicht mehr genutzt wird bekommt keine Einträge
+        size_t limit = (static_cast<size_t>(&shard - shards.data()) < activeShards.load(memory_order_relaxed))
+            ? shardCapacity.load(memory_order_relaxed) : 0;
+        if (limit == 0)
+            return;
+
+        shard.entries.emplace_front(key, stats);
+        shard.index.emplace(key, shard.entries.begin());
+        evict(shard, limit);
+    }
+
+    // Siehe Header
+    void StatsCache::erase(const StatsKey& key)
+    {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end())
+        {
+            shard.entries.erase(it->second);
+            shard.index.erase(it);
+        }
+    }
+
+    // Siehe Header
+    void StatsCache::setCapacity(size_t capacity)
+    {
+        size_t active = activeShardCount(capacity, shards.size());
+        size_t limit = active ? capacity / active : 0;
+        size_t previous = activeShards.exchange(active, memory_order_relaxed);
+        shardCapacity.store(limit, memory_order_relaxed);
+
+        // mit einer anderen Anzahl an Shards liegen die Schlüssel in anderen Shards, dann wird alles entfernt
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            lock_guard<mutex> lock(shards[i].mutex);
+            evict(shards[i], (active == previous && i < active) ? limit : 0);
+        }
+    }
+
+    // Siehe Header
+    void StatsCache::clear()
+    {
+        for (Shard& shard : shards)
+        {
+            lock_guard<mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.entries.clear();
+        }
+    }
+
+    // Siehe Header
+    CacheCounters StatsCache::counters() const
+    {
+        CacheCounters c;
+        c.hits = hits.load(memory_order_relaxed);
+        c.misses = misses.load(memory_order_relaxed);
+        c.evictions = evictions.load(memory_order_relaxed);
+        c.size = 0;
+        for (const Shard& shard : shards)
+        {
+            lock_guard<mutex> lock(shard.mutex);
+            c.size += shard.index.size();
+        }
+        return c;
+    }
+
+    /**
+    * [intern]
+    * Der Shard wird über die oberen Bits des Hashes gewählt, die unteren nutzt die unordered_map
+    */
+    StatsCache::Shard& StatsCache::shardFor(const StatsKey& key)
+    {
+        uint64_t h = KeyHash{}(key);
+        size_t active = max<size_t>(1, activeShards.load(memory_order_relaxed));
+        return shards[static_cast<size_t>(h >> 40) & (active - 1)];
+    }
+
+    /**
+    * [intern]
+    * Entfernt die ältesten Einträge bis höchstens limit übrig sind. Der mutex des Shards muss gesperrt sein.
+    */
+    void StatsCache::evict(Shard& shard, size_t limit)
+    {
+        while (shard.index.size() > limit)
+        {
+            shard.index.erase(shard.entries.back().first);
+            shard.entries.pop_back();
+            evictions.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    // Siehe Header
+    StatsCache& getStatsCache()
+    {
+        static StatsCache cache;
+        return cache;
+    }
+
+    // Siehe Header
+    void clearCache()
+    {
+        getStatsCache().clear();
+    }
+
+    // Siehe Header
+    void setCacheCapacity(size_t capacity)
+    {
+        getStatsCache().setCapacity(capacity);
+    }
+
+    // Siehe Header
+    CacheCounters getCacheCounters()
+    {
+        return getStatsCache().counters();
+    }
+}
@@ -0,0 +1,122 @@
+/**
+* StatsCache.h
+*
+* Cache für die Stats von createStatistics. Die Einträge sind auf mehrere Shards mit eigenem mutex verteilt,
+* damit viele Threads gleichzeitig zugreifen können. Jeder Shard entfernt bei voller Kapazität den am längsten
+* nicht genutzten Eintrag (LRU).
+*/
+#pragma once
+#ifndef TEXTANALYSER_STATSCACHE
+#define TEXTANALYSER_STATSCACHE
+
+#include "TextAnalyser.h"
+#include <atomic>
+#include <list>
+#include <mutex>
+
+namespace AnalyserLib
+{
+	/**
+	* Der Schlüssel für einen Eintrag. Ein Text wird über seine Länge und zwei unabhängige 64 bit Hashes erkannt,
+	* die Trennzeichen werden direkt verglichen. Bei einer Dokument Id wird der Text nicht gelesen.
+	*/
+	struct StatsKey
+	{
+		bool isDocument = false;
+		/// Länge des Textes oder die Dokument Id
+		std::uint64_t id = 0;
+		std::uint64_t hash1 = 0;
+		std::uint64_t hash2 = 0;
+		/// wordEnd und sentenceEnd durch ein \0 getrennt
+		std::string separators;
+
+		bool operator==(const StatsKey& o) const
+		{
+			return isDocument == o.isDocument && id == o.id && hash1 == o.hash1 && hash2 == o.hash2 && separators == o.separators;
+		}
+	};
+
+	/**
+	* Ein LRU Cache für Stats, aufgeteilt in Shards
+	*/
+	class StatsCache
+	{
+	public:
+		/**
+		* @param	capacity: maximale Anzahl an Einträgen über alle Shards, 0 schaltet den Cache ab. Bei weniger Einträgen
+		*			als Shards werden nur so viele Shards genutzt (abgerundet auf eine Zweierpotenz).
+		*			shardCount: Anzahl der Shards, wird auf eine Zweierpotenz aufgerundet
+		*/
+		explicit StatsCache(size_t capacity = 4096, size_t shardCount = 16);
+
+		/**
+		* Erstellt den Schlüssel für einen Text. Der Text wird dafür einmal gehasht.
+		*/
+		static StatsKey makeKey(std::string_view text, std::string_view wordEnd, std::string_view sentenceEnd);
+
+		/**
+		* Erstellt den Schlüssel für eine Dokument Id in O(1)
+		*/
+		static StatsKey makeKey(std::uint64_t documentId, std::string_view wordEnd, std::string_view sentenceEnd);
+
+		/**
+		* Sucht einen Eintrag und markiert ihn als zuletzt genutzt
+		*
+		* @return	false wenn es keinen Eintrag gibt
+		*/
+		bool find(const StatsKey& key, Stats& stats);
+
+		/**
+		* Speichert einen Eintrag. Ist der Shard voll wird der am längsten nicht genutzte entfernt.
+		*/
+		void insert(const StatsKey& key, const Stats& stats);
+
+		/**
+		* Entfernt einen Eintrag, z.B. wenn sich ein Dokument geändert hat
+		*/
+		void erase(const StatsKey& key);
+
+		/**
+		* Ändert die maximale Anzahl an Einträgen, überzählige Einträge werden sofort entfernt. Ändert sich dabei die Anzahl
+		* der genutzten Shards, wird der Cache geleert. 0 schaltet den Cache ab.
+		*/
+		void setCapacity(size_t capacity);
+
+		void clear();
+
+		/// Treffer, Fehlschläge, entfernte Einträge und aktuelle Größe
+		CacheCounters counters() const;
+
+	private:
+		struct KeyHash
+		{
+			size_t operator()(const StatsKey& key) const;
+		};
+
+		struct Shard
+		{
+			mutable std::mutex mutex;
+			/// vorne liegt der zuletzt genutzte Eintrag
+			std::list<std::pair<StatsKey, Stats>> entries;
+			std::unordered_map<StatsKey, std::list<std::pair<StatsKey, Stats>>::iterator, KeyHash> index;
+		};
+
+		Shard& shardFor(const StatsKey& key);
+		void evict(Shard& shard, size_t limit);
+
+		std::vector<Shard> shards;
+		/// nur die ersten activeShards Shards bekommen Einträge, so hält auch eine capacity unter der Anzahl der Shards
+		std::atomic<size_t> activeShards;
+		std::atomic<size_t> shardCapacity;
+		std::atomic<std::uint64_t> hits{ 0 };
+		std::atomic<std::uint64_t> misses{ 0 };
+		std::atomic<std::uint64_t> evictions{ 0 };
+	};
+
+	/**
+	* @return	Gibt den Cache zurück der von createStatistics genutzt wird
+	*/
+	StatsCache& getStatsCache();
+}
+
+#endif // !TEXTANALYSER_STATSCACHE
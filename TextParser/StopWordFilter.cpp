@@ -0,0 +1,132 @@
+#include "StopWordFilter.h"
+#include "Utf8.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    // Siehe Header
+    StopWordFilter::StopWordFilter(const std::vector<std::string>& stopWords, bool ignoreCase)
+        : ignoreCase(ignoreCase)
+    {
+        rehash(max<size_t>(16, stopWords.size() * 2));
+        for (const string& w : stopWords)
+            add(w);
+    }
+
+    // Siehe Header
+    void StopWordFilter::add(std::string_view word)
+    {
+        if (contains(word))
+            return;
+
+        if ((words.size() + 1) * 2 > slots.size())
+            rehash(max<size_t>(16, slots.size() * 2));
+
+        string stored;
+        if (ignoreCase)
+            forEachFoldedByte(word, [&stored](char c) { stored += c; });
+        else
+            stored = word;
+        words.push_back(move(stored));
+
+        size_t mask = slots.size() - 1;
+        size_t i = static_cast<size_t>(hash(words.back())) & mask;
+        while (slots[i] != 0)
+            i = (i + 1) & mask;
+        slots[i] = static_cast<uint32_t>(words.size());
+    }
+
+    // Siehe Header
+    bool StopWordFilter::contains(std::string_view word) const
+    {
+        if (words.empty())
+            return false;
+
+        size_t mask = slots.size() - 1;
+        for (size_t i = static_cast<size_t>(hash(word)) & mask; slots[i] != 0; i = (i + 1) & mask)
+        {
+            if (equals(words[slots[i] - 1], word))
+                return true;
+        }
+        return false;
+    }
+
+    // Siehe Header
+    const StopWordFilter& StopWordFilter::german()
+    {
+        static const StopWordFilter filter(germanStopWords);
+        return filter;
+    }
+
+    // Siehe Header
+    const StopWordFilter& StopWordFilter::english()
+    {
+        static const StopWordFilter filter(englishStopWords);
+        return filter;
+    }
+
+    /**
+    * [intern]
+    * FNV-1a über das Wort, bei ignoreCase über die Kleinbuchstaben
+    */
+    std::uint64_t StopWordFilter::hash(std::string_view word) const
+    {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        auto mix = [&h](char c)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3ULL;
+        };
+        if (ignoreCase)
+            forEachFoldedByte(word, mix);
+        else
+        {
+            for (char c : word)
+                mix(c);
+        }
+        return h ^ (h >> 29);
+    }
+
+    /**
+    * [intern]
+    * Vergleicht ein gespeichertes Wort mit word, bei ignoreCase wird word dabei in lowercase umgewandelt.
+    * Die Länge kann sich dabei ändern (z.B. Latin-1 Ü zu UTF-8 ü), deshalb wird sie erst am Ende verglichen.
+    */
+    bool StopWordFilter::equals(std::string_view stored, std::string_view word) const
+    {
+        if (!ignoreCase)
+            return stored == word;
+
+        size_t i = 0;
+        bool same = true;
+        forEachFoldedByte(word, [&](char c)
+        {
+            same = same && i < stored.size() && stored[i] == c;
+            ++i;
+        });
+        return same && i == stored.size();
+    }
+
+    /**
+    * [intern]
+    * Legt die Tabelle mit neuer Größe (Zweierpotenz) an und trägt alle Worte neu ein
+    */
+    void StopWordFilter::rehash(size_t capacity)
+    {
+        size_t size = 16;
+        while (size < capacity)
+            size <<= 1;
+        slots.assign(size, 0);
+
+        size_t mask = size - 1;
+        for (size_t w = 0; w < words.size(); ++w)
+        {
+            size_t i = static_cast<size_t>(hash(words[w])) & mask;
+            while (slots[i] != 0)
+                i = (i + 1) & mask;
+            slots[i] = static_cast<uint32_t>(w + 1);
+        }
+    }
+}
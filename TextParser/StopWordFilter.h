@@ -0,0 +1,116 @@
+/**
+* StopWordFilter.h
+*
+* Eine Menge von Stoppwörtern die einmal aufgebaut wird und danach jedes Wort in O(1) prüft.
+* Deutsche und englische Standardlisten sind als constexpr Listen enthalten.
+*/
+#pragma once
+#ifndef TEXTANALYSER_STOPWORDFILTER
+#define TEXTANALYSER_STOPWORDFILTER
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AnalyserLib
+{
+	/**
+	* Häufige deutsche Stoppwörter in lowercase, UTF-8 kodiert
+	*/
+	inline constexpr std::string_view germanStopWords[] = {
+		"aber", "alle", "allem", "allen", "aller", "alles", "als", "also", "am", "an", "ander", "andere", "anderem",
+		"anderen", "anderer", "anderes", "anderm", "andern", "anders", "auch", "auf", "aus", "bei", "bin", "bis", "bist",
+		"da", "damit", "dann", "das", "dass", "da\xC3\x9F", "dasselbe", "dazu", "dein", "deine", "deinem", "deinen", "deiner",
+		"deines", "dem", "demselben", "den", "denn", "denselben", "der", "derer", "derselbe", "derselben", "des",
+		"desselben", "dessen", "dich", "die", "dies", "diese", "dieselbe", "dieselben", "diesem", "diesen", "dieser",
+		"dieses", "dir", "doch", "dort", "du", "durch", "ein", "eine", "einem", "einen", "einer", "eines", "einig",
+		"einige", "einigem", "einigen", "einiger", "einiges", "einmal", "er", "es", "etwas", "euch", "euer", "eure",
+		"eurem", "euren", "eurer", "eures", "f\xC3\xBCr", "gegen", "gewesen", "hab", "habe", "haben", "hat", "hatte",
+		"hatten", "hier", "hin", "hinter", "ich", "ihm", "ihn", "ihnen", "ihr", "ihre", "ihrem", "ihren", "ihrer",
+		"ihres", "im", "in", "indem", "ins", "ist", "jede", "jedem", "jeden", "jeder", "jedes", "jene", "jenem", "jenen",
+		"jener", "jenes", "jetzt", "kann", "kein", "keine", "keinem", "keinen", "keiner", "keines", "k\xC3\xB6nnen",
+		"k\xC3\xB6nnte", "machen", "man", "manche", "manchem", "manchen", "mancher", "manches", "mein", "meine", "meinem",
+		"meinen", "meiner", "meines", "mich", "mir", "mit", "muss", "musste", "nach", "nicht", "nichts", "noch", "nun",
+		"nur", "ob", "oder", "ohne", "sehr", "sein", "seine", "seinem", "seinen", "seiner", "seines", "selbst", "sich",
+		"sie", "sind", "so", "solche", "solchem", "solchen", "solcher", "solches", "soll", "sollte", "sondern", "sonst",
+		"\xC3\xBC" "ber", "um", "und", "uns", "unser", "unsere", "unserem", "unseren", "unseres", "unter", "viel", "vom",
+		"von", "vor", "w\xC3\xA4hrend", "war", "waren", "warst", "was", "weg", "weil", "weiter", "welche", "welchem",
+		"welchen", "welcher", "welches", "wenn", "werde", "werden", "wie", "wieder", "will", "wir", "wird", "wirst",
+		"wo", "wollen", "wollte", "w\xC3\xBCrde", "w\xC3\xBCrden", "zu", "zum", "zur", "zwar", "zwischen"
+	};
+
+	/**
+	* Häufige englische Stoppwörter in lowercase
+	*/
+	inline constexpr std::string_view englishStopWords[] = {
+		"a", "about", "above", "after", "again", "against", "all", "am", "an", "and", "any", "are", "as", "at", "be",
+		"because", "been", "before", "being", "below", "between", "both", "but", "by", "can", "did", "do", "does",
+		"doing", "down", "during", "each", "few", "for", "from", "further", "had", "has", "have", "having", "he", "her",
+		"here", "hers", "herself", "him", "himself", "his", "how", "i", "if", "in", "into", "is", "it", "its", "itself",
+		"just", "me", "more", "most", "my", "myself", "no", "nor", "not", "now", "of", "off", "on", "once", "only", "or",
+		"other", "our", "ours", "ourselves", "out", "over", "own", "same", "she", "should", "so", "some", "such", "than",
+		"that", "the", "their", "theirs", "them", "themselves", "then", "there", "these", "they", "this", "those",
+		"through", "to", "too", "under", "until", "up", "very", "was", "we", "were", "what", "when", "where", "which",
+		"while", "who", "whom", "why", "will", "with", "you", "your", "yours", "yourself", "yourselves"
+	};
+
+	/**
+	* Flache Hashmenge für Stoppwörter mit offener Adressierung. Mit ignoreCase werden die Worte nach Code Points in
+	* Kleinbuchstaben verglichen (siehe forEachFoldedByte), z.B. auch Ä, Ö, Ü in UTF-8 und Latin-1, ohne das Wort zu kopieren.
+	*/
+	class StopWordFilter
+	{
+	public:
+		StopWordFilter() = default;
+
+		/**
+		* @param	words: Die Stoppwörter
+		*			ignoreCase (default = true): Groß- und Kleinschreibung beim Vergleich ignorieren
+		*/
+		explicit StopWordFilter(const std::vector<std::string>& words, bool ignoreCase = true);
+
+		/**
+		* Baut den Filter aus einer constexpr Liste wie germanStopWords
+		*/
+		template<size_t N>
+		explicit StopWordFilter(const std::string_view (&words)[N], bool ignoreCase = true)
+			: ignoreCase(ignoreCase)
+		{
+			for (std::string_view w : words)
+				add(w);
+		}
+
+		/**
+		* Fügt ein Stoppwort hinzu
+		*/
+		void add(std::string_view word);
+
+		/**
+		* @return	true wenn das Wort ein Stoppwort ist
+		*/
+		bool contains(std::string_view word) const;
+
+		size_t size() const { return words.size(); }
+		bool empty() const { return words.empty(); }
+		bool ignoresCase() const { return ignoreCase; }
+
+		/// Filter mit germanStopWords, ignoriert Groß- und Kleinschreibung
+		static const StopWordFilter& german();
+		/// Filter mit englishStopWords, ignoriert Groß- und Kleinschreibung
+		static const StopWordFilter& english();
+
+	private:
+		std::uint64_t hash(std::string_view word) const;
+		bool equals(std::string_view stored, std::string_view word) const;
+		void rehash(size_t capacity);
+
+		bool ignoreCase = true;
+		/// die Worte, bei ignoreCase bereits in lowercase
+		std::vector<std::string> words;
+		/// Index + 1 in words, 0 ist ein freier Platz
+		std::vector<std::uint32_t> slots;
+	};
+}
+
+#endif // !TEXTANALYSER_STOPWORDFILTER
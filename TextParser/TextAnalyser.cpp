@@ -1,176 +1,247 @@
 #include "TextAnalyser.h"
+#include "MappedFile.h"
+#include "Metrics.h"
+#include "PatternMatcher.h"
+#include "SimdKernels.h"
+#include "StatsCache.h"
+#include "ThreadPool.h"
+#include "Utf8.h"
 //#include <iostream>
-#include <locale>
-#include <cctype>
 #include <algorithm>
-#include <fstream>
-#include <future>
+#include <istream>
 #include <queue>
+#include <type_traits>
 using namespace std;
 
 namespace AnalyserLib
 {
-    /// wird bentigt damit man mit andere Zeichen als Ascii arbeiten kann
-    static locale usedLocal("de_DE.UTF8");
-    /// Deutsche sonderzeichen
-    static const string germanSpecials = "";
-
-    /**
-    * [intern]
-    * Eine Helper Funktion um ein Wort in LowerCase zu convertieren
-    */
-    void toLowerCase(string& word)
-    {
-        transform(word.begin(), word.end(), word.begin(),
-            [](const char& c) { return tolower(c, usedLocal); }
-        );
-    }
-
     /**
     * [intern]
-    * Generiert einen sub string aus dem Text mit der bergebenen lnge
+    * Sucht ab pos das nächste Wort. Ein Wort startet immer mit einem Buchstaben und endet erst bei einem Wortende.
+    * Gibt false zurück wenn kein Wort mehr im Text ist.
     */
-    inline string getTextPart(const std::string& text, const int& start, int& length, bool& useLowerCase)
+    template<class CharClass>
+    inline bool findNextToken(string_view text, size_t& pos, Token& token, const CharClass& charClass)
     {
-        string word = text.substr(start, length);
-        if (useLowerCase)
-            toLowerCase(word);
-
-        length = 0;
-        return word;
-    }
-
-    // Siehe Header
-    stringList splitTextIntoStringList(const std::string& text, bool useLowerCase, const string& endSignes)
-    {
-        stringList sList;
-        int length = 0, startIdx = 0;
-        for (int i = 0; i < text.size(); ++i)
+        size_t i = pos;
+        if constexpr (is_same_v<CharClass, DefaultCharClass>)
         {
-            if (isalpha(text[i], usedLocal) || germanSpecials.find(text[i]) != string::npos)
-            {
-                if (length == 0)
-                    startIdx = i;
-                length++;
-            }
-            else if (length > 0)
-            {
-                if (endSignes.find(text[i]) != string::npos)
-                    sList.push_back(getTextPart(text, startIdx, length, useLowerCase));
-                else
-                    length++;
-            }
+            // mit der Standardtabelle übernehmen die SIMD Kernels die Suche nach den Wortgrenzen
+            if (i < text.size() && !(charClass(text[i]) & charLetter))
+                i = findLetterSimd(text, i + 1);
+        }
+        else
+        {
+            while (i < text.size() && !(charClass(text[i]) & charLetter))
+                ++i;
+        }
 
+        if (i >= text.size())
+        {
+            pos = text.size();
+            return false;
         }
 
-        if (length > 0)
+        size_t startIdx = i;
+        if constexpr (is_same_v<CharClass, DefaultCharClass>)
+        {
+            i = findWordEndSimd(text, i + 1);
+        }
+        else
         {
-            sList.push_back(getTextPart(text, startIdx, length, useLowerCase));
+            while (i < text.size() && (charClass(text[i]) & (charLetter | charWordEnd)) != charWordEnd)
+                ++i;
         }
 
-        return sList;
+        token = { text.substr(startIdx, i - startIdx), startIdx };
+        pos = i;
+        return true;
     }
 
     // Siehe Header
-    stringList splitTextIntoStringListAsync(const std::string& text, bool useLowerCase, const std::string& endingPattern)
+    TokenRange::iterator& TokenRange::iterator::operator++()
     {
-        future<stringList> res = async(launch::async, splitTextIntoStringList, text, useLowerCase, endingPattern);
-        return res.get();
+        bool found = range->useDefaultTable
+            ? findNextToken(range->text, next, current, DefaultCharClass())
+            : findNextToken(range->text, next, current, RuntimeCharClass{ range->table });
+
+        if (!found)
+            current = { {}, string_view::npos };
+        return *this;
     }
 
+    /// [intern] Kleinere Teile lohnen sich nicht für einen eigenen Thread
+    static const size_t minChunkSize = 1 << 14;
+
     /**
     * [intern]
-    * Ein struct zum speichern von statistischen Daten ber einen Text
+    * Wie viele Teile für die Async Funktionen erstellt werden sollen
     */
-    struct Stats
+    size_t chunkCountFor(size_t size, const ThreadPool& pool)
     {
-        int letters;
-        int words;
-        int sentense;
-        int syllable;
-    };
+        return max<size_t>(1, min<size_t>(pool.concurrency(), size / minChunkSize));
+    }
 
-    /// Alle gespeicherten texte in einer unordered map of Hash Stats
-    static unordered_map<size_t, Stats> saveStatsManager;
     /**
     * [intern]
-    * gibt eine gespeicherte Statistic zurck wenn eine passende zum Hash gefunden wird
+    * Zerlegt den Text in höchstens chunkCount Teile. Ein Teil endet immer direkt nach einem Zeichen das alle splitFlags hat
+    * und kein Buchstabe ist, so beginnt jeder Teil außerhalb eines Wortes (bzw. Satzes).
+    * Gibt die Startpositionen der Teile und als letzten Wert text.size() zurück.
     */
-    Stats getStats(size_t hashValue)
+    vector<size_t> findChunkBounds(string_view text, size_t chunkCount, const CharTable& table, unsigned char splitFlags)
     {
-       // return { 0, 0, 0, 0 };
-        auto save = saveStatsManager.find(hashValue);
-        if (save == saveStatsManager.end())
-            return { 0, 0, 0, 0 };
-        return saveStatsManager[hashValue];
+        vector<size_t> bounds{ 0 };
+        for (size_t k = 1; k < chunkCount; ++k)
+        {
+            size_t pos = max(bounds.back(), text.size() / chunkCount * k);
+            while (pos < text.size() && (table[text[pos]] & (splitFlags | charLetter)) != splitFlags)
+                ++pos;
+
+            if (pos + 1 >= text.size())
+                break;
+            bounds.push_back(pos + 1);
+        }
+        bounds.push_back(text.size());
+        return bounds;
     }
 
     /**
     * [intern]
-    * Speichert die Statistiken mit dem Hashwert des textes ab
+    * Prüft ob der letzte Buchstabe vor end ein Vokal ist. Das ist der Silbenzustand für einen Teil der bei end beginnt.
     */
-    void saveStats(size_t hashValue, Stats s)
+    bool lastLetterIsVowel(string_view text, size_t end, const CharTable& table)
     {
-        saveStatsManager[hashValue] = s;
-    }
-
-    // Siehe Header
-    void clearCache()
-    {
-        saveStatsManager.clear();
+        for (size_t i = end; i > 0; --i)
+        {
+            unsigned char flags = table[text[i - 1]];
+            if (flags & charLetter)
+                return (flags & charVowel) != 0;
+        }
+        return false;
     }
 
     /**
     * [intern]
-    * Erzeugt eine Statsitische erhebung von einem Text.
+    * Addiert die Zählungen aus from in into. Neue Einträge werden ohne Kopie des Keys umgehängt.
     */
-    Stats createStatistics(const std::string& text, const string& wordEndSignes, const string& sentenceEndSignes)
+    template<class Map>
+    void mergeCounts(Map& into, Map& from)
     {
-        size_t h1 = std::hash<std::string>{}(text);
-        size_t h2 = std::hash<std::string>{}(wordEndSignes);
-        size_t h3 = std::hash<std::string>{}(sentenceEndSignes);
-        size_t hashValue = h1 ^ h2 ^ h3;
-        
-        Stats stat = getStats(hashValue);
-        if (stat.letters > 0)
-            return stat;
-
-        bool isWordStart = false;
-        bool isLastOneVowel = false;
-        static const string syllable(syllableDetection);
+        if (into.size() < from.size())
+            into.swap(from);
 
-        for (int i = 0; i < text.size(); ++i)
+        for (auto it = from.begin(); it != from.end();)
         {
-            if (isalpha(text[i], usedLocal) || germanSpecials.find(text[i]) != string::npos)
+            auto found = into.find(it->first);
+            if (found != into.end())
             {
-                stat.letters++;
-                bool isVowel = syllable.find(text[i]) != string::npos;
-                if (isVowel && !isLastOneVowel)
-                    stat.syllable++;
-                isLastOneVowel = isVowel;
-                isWordStart = true;
+                found->second += it->second;
+                ++it;
             }
-            else if (isWordStart && wordEndSignes.find(text[i]) != string::npos)
+            else
             {
-                stat.words++;
-                if (sentenceEndSignes.find(text[i]) != string::npos)
-                    stat.sentense++;
-                isWordStart = false;
+                auto next = std::next(it);
+                into.insert(from.extract(it));
+                it = next;
             }
         }
+    }
 
-        if (isWordStart)
+    /**
+    * [intern]
+    * splitTextIntoStringList für einen Teil des Textes
+    */
+    stringList splitRange(string_view text, bool useLowerCase, const string& endSignes)
+    {
+        ANALYSER_STAGE_TIMER(stageTokenize);
+        stringList sList;
+        for (const Token& t : tokenize(text, endSignes))
         {
-            stat.words++;
-            stat.sentense++;
+            if (useLowerCase)
+                toLowerUtf8(t.value, sList.emplace_back());
+            else
+                sList.emplace_back(t.value);
         }
+        ANALYSER_STAGE_ADD(stageTokenize, fieldBytesIn, text.size());
+        ANALYSER_STAGE_ADD(stageTokenize, fieldTokens, sList.size());
+        return sList;
+    }
+
+    // Siehe Header
+    stringList splitTextIntoStringList(const std::string& text, bool useLowerCase, const string& endSignes)
+    {
+        return splitRange(text, useLowerCase, endSignes);
+    }
 
-        saveStats(hashValue, stat);
+    // Siehe Header
+    stringList splitTextIntoStringListAsync(const std::string& text, bool useLowerCase, const std::string& endingPattern)
+    {
+        shared_ptr<ThreadPool> pool = getThreadPool();
+        vector<size_t> bounds = findChunkBounds(text, chunkCountFor(text.size(), *pool), makeCharTable(endingPattern), charWordEnd);
+
+        vector<stringList> parts(bounds.size() - 1);
+        pool->parallelFor(parts.size(), [&](size_t i)
+            {
+                parts[i] = splitRange(string_view(text).substr(bounds[i], bounds[i + 1] - bounds[i]), useLowerCase, endingPattern);
+            });
+
+        stringList sList = move(parts[0]);
+        for (size_t i = 1; i < parts.size(); ++i)
+            sList.insert(sList.end(), make_move_iterator(parts[i].begin()), make_move_iterator(parts[i].end()));
+        return sList;
+    }
+
+    /// Alle gespeicherten texte in einer unordered map of Hash Stats
+    /**
+    * [intern]
+    * Erzeugt eine Statsitische erhebung von einem Text. Das Ergebnis wird im StatsCache gespeichert.
+    */
+    Stats createStatistics(const std::string& text, const string& wordEndSignes, const string& sentenceEndSignes)
+    {
+        StatsCache& cache = getStatsCache();
+        StatsKey key;
+        {
+            ANALYSER_STAGE_TIMER(stageStatsHash);
+            ANALYSER_STAGE_ADD(stageStatsHash, fieldBytesIn, text.size());
+            key = StatsCache::makeKey(text, wordEndSignes, sentenceEndSignes);
+        }
+
+        Stats stat;
+        if (cache.find(key, stat))
+            return stat;
+
+        AnalysisOptions options;
+        options.wordEnd = wordEndSignes;
+        options.sentenceEnd = sentenceEndSignes;
+        stat = analyseText(text, metricStats, options).stats;
+
+        cache.insert(key, stat);
+        return stat;
+    }
+
+    // Siehe Header
+    Stats getDocumentStats(std::uint64_t documentId, const std::string& text)
+    {
+        StatsCache& cache = getStatsCache();
+        StatsKey key = StatsCache::makeKey(documentId, defaultWordEnd, defaultSentenceEnd);
+
+        Stats stat;
+        if (cache.find(key, stat))
+            return stat;
+
+        stat = analyseText(text, metricStats).stats;
+        cache.insert(key, stat);
         return stat;
     }
 
     // Siehe Header
-    int countTotalWords(const std::string& text)
+    void forgetDocument(std::uint64_t documentId)
+    {
+        getStatsCache().erase(StatsCache::makeKey(documentId, defaultWordEnd, defaultSentenceEnd));
+    }
+
+    // Siehe Header
+    std::int64_t countTotalWords(const std::string& text)
     {
         auto stat = createStatistics(text, defaultWordEnd, defaultSentenceEnd);
 
@@ -178,10 +249,9 @@ namespace AnalyserLib
     }
 
     // Siehe Header
-    int countTotalWordsAsync(const std::string& text)
+    std::int64_t countTotalWordsAsync(const std::string& text)
     {
-        future<int> res = async(launch::async, countTotalWords, text);
-        return res.get();
+        return analyseTextAsync(text, metricStats).stats.words;
     }
 
     // Siehe Header
@@ -193,254 +263,929 @@ namespace AnalyserLib
     // Siehe Header
     wordDistribution createWordDistribution(const std::string& text, constStringList& stopWords, bool caseSensitive)
     {
-        auto words = splitTextIntoStringList(text, caseSensitive);
-        return createWordDistribution(words, stopWords);
+        return createWordDistribution(text, StopWordFilter(stopWords, false), caseSensitive);
+    }
+
+    // Siehe Header
+    wordDistribution createWordDistribution(const std::string& text, const StopWordFilter& stopWords, bool useLowerCase)
+    {
+        AnalysisOptions options;
+        options.useLowerCase = useLowerCase;
+        wordDistribution wordDistibution = analyseText(text, metricWordDistribution, options).words;
+
+        // stop words werden einmal pro Eintrag entfernt und nicht für jedes Wort gesucht
+        if (!stopWords.empty())
+        {
+            for (auto it = wordDistibution.begin(); it != wordDistibution.end();)
+            {
+                if (stopWords.contains(it->first))
+                    it = wordDistibution.erase(it);
+                else
+                    ++it;
+            }
+        }
+        return wordDistibution;
     }
 
     // Siehe Header
     wordDistribution createWordDistribution(constStringList& wordList, constStringList& stopWords)
+    {
+        return createWordDistribution(wordList, StopWordFilter(stopWords, false));
+    }
+
+    // Siehe Header
+    wordDistribution createWordDistribution(constStringList& wordList, const StopWordFilter& stopWords)
     {
         unordered_map<string, int> wordDistibution;
         for (const string& w : wordList)
         {
-            // check for stop words
-            auto itStopwords = find(stopWords.begin(), stopWords.end(), w);
-            if (itStopwords == stopWords.end())
+            if (!stopWords.contains(w))
                 wordDistibution[w]++;
         }
+        ANALYSER_PEAK(peakDistributionBytes, estimateMapBytes(wordDistibution));
         return wordDistibution;
     }
 
-    /**
-    * [intern]
-    * helper function weil future und async kein berladenen functionen untersttzt
-    */
-    wordDistribution createWordDistributionAsyncHelper(constStringList& wordList, constStringList& stopWords)
+    // Siehe Header
+    wordDistribution createWordDistributionAsync(constStringList& wordList, constStringList& stopWords)
     {
-        return createWordDistribution(wordList, stopWords);
+        return createWordDistributionAsync(wordList, StopWordFilter(stopWords, false));
     }
+
     // Siehe Header
-    wordDistribution createWordDistributionAsync(constStringList& wordList, constStringList& stopWords)
+    wordDistribution createWordDistributionAsync(constStringList& wordList, const StopWordFilter& stopWords)
+    {
+        shared_ptr<ThreadPool> pool = getThreadPool();
+        size_t chunkCount = max<size_t>(1, min<size_t>(pool->concurrency(), wordList.size() / 4096));
+
+        vector<wordDistribution> parts(chunkCount);
+        pool->parallelFor(chunkCount, [&](size_t i)
+            {
+                size_t begin = wordList.size() * i / chunkCount, end = wordList.size() * (i + 1) / chunkCount;
+                for (size_t w = begin; w < end; ++w)
+                {
+                    if (!stopWords.contains(wordList[w]))
+                        parts[i][wordList[w]]++;
+                }
+            });
+
+        wordDistribution wordDistibution = move(parts[0]);
+        for (size_t i = 1; i < parts.size(); ++i)
+            mergeCounts(wordDistibution, parts[i]);
+        ANALYSER_PEAK(peakDistributionBytes, estimateMapBytes(wordDistibution));
+        return wordDistibution;
+    }
+
+    /// [intern] Größe der Blöcke in denen cleanUpText den Text durch die Pipeline gibt
+    constexpr size_t cleanupBlockSize = 64 * 1024;
+
+    // Siehe Header
+    void cleanUpText(std::string& text, cleanupType type)
+    {
+        if (type == None)
+            return;
+
+        ANALYSER_STAGE_TIMER(stageCleanup);
+        ANALYSER_STAGE_ADD(stageCleanup, fieldBytesIn, text.size());
+        string cleaned;
+        cleaned.reserve(text.size());
+        CleanupPipeline pipeline(type, [&cleaned](string_view part) { cleaned += part; });
+        for (size_t pos = 0; pos < text.size(); pos += cleanupBlockSize)
+            pipeline.feed(string_view(text).substr(pos, cleanupBlockSize));
+        pipeline.finish();
+        text = move(cleaned);
+        ANALYSER_STAGE_ADD(stageCleanup, fieldBytesOut, text.size());
+    }
+
+    // Siehe Header
+    std::string readFile(const std::string& path, cleanupType type)
+    {
+        string fileText;
+        {
+            ANALYSER_STAGE_TIMER(stageReadFile);
+            MappedFile file(path);
+            if (!file.isOpen())
+                return "";
+
+            fileText.reserve(static_cast<size_t>(file.size()));
+            appendWithUnixNewlines(fileText, file.view());
+            ANALYSER_STAGE_ADD(stageReadFile, fieldBytesIn, file.size());
+            ANALYSER_STAGE_ADD(stageReadFile, fieldBytesOut, fileText.size());
+        }
+
+        cleanUpText(fileText, type);
+        return fileText;
+    }
+
+    // Siehe Header
+    searchList findPatterns(const std::string& text, const std::regex& pattern)
+    {
+        ANALYSER_STAGE_TIMER(stageSearch);
+        ANALYSER_STAGE_ADD(stageSearch, fieldBytesIn, text.size());
+        searchList occurVec;
+        for (sregex_iterator i{ text.begin(), text.end(), pattern }, last; i != last; ++i)
+        {
+            uint64_t pos = static_cast<uint64_t>(i->position(0));
+            occurVec.push_back({ i->str(), pos });
+        }
+
+        return occurVec;
+    }
+
+    // Siehe Header
+    searchList findPatterns(const std::string& text, std::string_view pattern)
+    {
+        ANALYSER_STAGE_TIMER(stageSearch);
+        ANALYSER_STAGE_ADD(stageSearch, fieldBytesIn, text.size());
+        return PatternMatcher(pattern).findAll(text);
+    }
+
+    // Siehe Header
+    double calculateWordLength(const std::string& text)
+    {
+        return calculateWordLength(createStatistics(text, defaultWordEnd, defaultSentenceEnd));
+    }
+
+    // Siehe Header
+    double calculateWordLength(const Stats& stat)
+    {
+        return static_cast<double>(stat.letters) / stat.words;
+    }
+
+    // Siehe Header
+    double calculateSentenceLengthByWords(const std::string& text)
     {
-        future<wordDistribution> res = async(launch::async, createWordDistributionAsyncHelper, wordList, stopWords);
-        return res.get();
+        return calculateSentenceLengthByWords(createStatistics(text, defaultWordEnd, defaultSentenceEnd));
     }
 
+    // Siehe Header
+    double calculateSentenceLengthByWords(const Stats& stat)
+    {
+        return static_cast<double>(stat.words) / stat.sentense;
+    }
+
+    // Siehe Header
+    double calculateSentenceLengthByLetters(const std::string& text)
+    {
+        return calculateSentenceLengthByLetters(createStatistics(text, defaultWordEnd, defaultSentenceEnd));
+    }
+
+    // Siehe Header
+    double calculateSentenceLengthByLetters(const Stats& stat)
+    {
+        return static_cast<double>(stat.letters) / stat.sentense;
+    }
+
+    // Siehe Header
+    wordLengthDistibution calculateWordLengthDistibution(const std::string& text, const std::string& wordEndSignes)
+    {
+        AnalysisOptions options;
+        options.wordEnd = wordEndSignes;
+        return analyseText(text, metricWordLength, options).wordLengths;
+    }
+
+    // Siehe Header
+    wordLengthDistibution calculateWordLengthDistibutionAsync(const std::string& text, const std::string& wordEndSignes)
+    {
+        AnalysisOptions options;
+        options.wordEnd = wordEndSignes;
+        return analyseTextAsync(text, metricWordLength, options).wordLengths;
+    }
+
+    // Siehe Header
+    wordPairs findConnectedWords(const std::string& text, int minOccurrences, int range)
+    {
+        AnalysisOptions options;
+        options.minOccurrences = minOccurrences;
+        options.range = range;
+        return analyseText(text, metricWordPairs, options).pairs;
+    }
+
+    // Siehe Header
+    wordPairs findConnectedWordsAsync(const std::string& text, int minOccurrences, int range)
+    {
+        AnalysisOptions options;
+        options.minOccurrences = minOccurrences;
+        options.range = range;
+        return analyseTextAsync(text, metricWordPairs, options).pairs;
+    }
+
+    // Siehe Header
+    wordPairs findConnectedWords(const std::string& text, const StopWordFilter& stopWords, int minOccurrences, int range)
+    {
+        AnalysisOptions options;
+        options.minOccurrences = minOccurrences;
+        options.range = range;
+        options.stopWords = &stopWords;
+        return analyseText(text, metricWordPairs, options).pairs;
+    }
+
+    /**
+    * [intern]
+    * Zählt die Wortpaare eines Satzes. window ist ein Ringpuffer mit den Ids der letzten (range - 1) Worte,
+    * windowPos zählt alle Worte im Satz.
+    */
+    class PairWindow
+    {
+    public:
+        explicit PairWindow(int range)
+            : window(range > 1 ? range - 1 : 0)
+        {
+        }
+
+        void add(wordId id, wordIdPairs& pairs)
+        {
+            size_t windowSize = window.size();
+            size_t count = min(windowPos, windowSize);
+            for (size_t d = count; d > 0; --d)
+                pairs.add(window[(windowPos - d) % windowSize], id);
+            window[windowPos % windowSize] = id;
+            windowPos++;
+        }
+
+        /// Wortpaare werden nur innerhalb eines Satzes gebildet
+        void reset()
+        {
+            windowPos = 0;
+        }
+
+    private:
+        vector<wordId> window;
+        size_t windowPos = 0;
+    };
+
     /**
     * [intern]
-    * Entfernt nur basis HTML tags und ist nicht fr Komplexe HTML Dateien gedacht.
-    * An dieser Stelle ist es zu empfehlen einen Externen Parser einzufgen
+    * Das Ergebnis eines Durchlaufs. Die Wortpaare liegen noch als Ids im eigenen Vocabulary,
+    * erst finishPairs filtert sie nach minOccurrences und macht daraus strings.
     */
-    void cleanUpHtml(string& text)
+    struct RangeResult
     {
-        size_t startIdx = text.find('<'), endIdx = 0;
+        AnalysisResult result{};
+        Vocabulary pairWords;
+        PairCounter pairs;
+    };
 
-        while(startIdx != string::npos)
+    /**
+    * [intern]
+    * Sammelt die Worte im analyseText Durchlauf für Wortlängen, Wortverteilung und Wortpaare.
+    * Die Worte kommen als string_view aus dem Text. wordKey wird wiederverwendet, damit nur für neue Einträge
+    * in der map Speicher angelegt wird.
+    */
+    class WordCollector
+    {
+    public:
+        WordCollector(int metrics, const AnalysisOptions& options, RangeResult& range)
+            : metrics(metrics), options(options), range(range),
+            window((metrics & metricWordPairs) ? options.range : 0)
+        {
+            range.pairs.setMaxEntries(options.maxPairEntries);
+        }
+
+        void addWord(string_view word, int wordLetters)
         {
-            endIdx = text.find('>');
-            if (endIdx == string::npos)
+            if (metrics & metricWordLength)
+                range.result.wordLengths[wordLetters]++;
+
+            if (metrics & metricWordDistribution)
             {
-                throw (string)"Html Text hat nicht das richtige Format";
-                break;
+                if (options.useLowerCase)
+                    toLowerUtf8(word, wordKey);
+                else
+                    wordKey.assign(word);
+                if (!isStopWord(wordKey))
+                    range.result.words[wordKey]++;
             }
 
-            // create spaces between tags
-            text[endIdx] = ' ';
-            text.erase(startIdx, endIdx - startIdx);
-            
-            startIdx = text.find('<');
+            if (metrics & metricWordPairs)
+            {
+                toLowerUtf8(word, wordKey);
+                // Stoppwörter belegen keinen Platz im Fenster
+                if (!isStopWord(wordKey))
+                    window.add(range.pairWords.intern(wordKey), range.pairs);
+            }
         }
-    }
+
+        void endSentence()
+        {
+            window.reset();
+        }
+
+    private:
+        bool isStopWord(const string& word) const
+        {
+            return options.stopWords && options.stopWords->contains(word);
+        }
+
+        int metrics;
+        const AnalysisOptions& options;
+        RangeResult& range;
+        PairWindow window;
+        string wordKey;
+    };
 
     /**
     * [intern]
-    * ersetzt aus eine Liste von Zeichen jedes Zeichen durch ein Leerzeichen
+    * Entfernt alle Paare die seltener als minOccurrences vorkommen und überträgt den Rest als strings nach result.pairs
     */
-    void cleanUpSigns(std::string& text, const string& removeSigns)
+    void finishPairs(RangeResult& range, int minOccurrences)
     {
-        for (const char& c : removeSigns)
-            replace(text.begin(), text.end(), c, ' ');
+        ANALYSER_STAGE_TIMER(stagePairs);
+        if (minOccurrences > 1)
+            range.pairs.prune(minOccurrences);
+
+        range.result.pairs.reserve(range.pairs.size());
+        range.pairs.forEach([&](wordIdPair ids, int count)
+            {
+                range.result.pairs.emplace(strPair(range.pairWords.word(ids.first), range.pairWords.word(ids.second)), count);
+            });
+        range.pairs.clear();
+        ANALYSER_PEAK(peakDistributionBytes, estimateMapBytes(range.result.words));
+        ANALYSER_PEAK(peakDistributionBytes, estimateMapBytes(range.result.pairs));
     }
 
     /**
     * [intern]
-    * Entfernt nur ein Teil vom Markdown tags und man muss definitv hier einen Parser einbauen der alles handlen kann.
+    * Addiert die Wortpaare aus from, die Ids werden dabei auf das Vocabulary von into umgerechnet
     */
-    void cleanUpMarkdown(string& text)
+    void mergePairs(RangeResult& into, const RangeResult& from)
     {
-        cleanUpSigns(text, "*~_#");
-        searchList bolds = findPatterns(text, regex(R"(bold)"));
-        for(auto b : bolds)
-            text.erase(b.position, 4);
+        ANALYSER_STAGE_TIMER(stagePairs);
+        vector<wordId> ids(from.pairWords.size());
+        for (size_t id = 0; id < ids.size(); ++id)
+            ids[id] = into.pairWords.intern(from.pairWords.word(static_cast<wordId>(id)));
+
+        from.pairs.forEach([&](wordIdPair pair, int count)
+            {
+                into.pairs.add(ids[pair.first], ids[pair.second], count);
+            });
     }
 
     /**
     * [intern]
-    * Entfernt berflssige leerzeichen
+    * Sammelt die Worte für createWordIdDistribution und findConnectedWordIds
     */
-    void cleanUpSpaces(string& text)
+    class WordIdCollector
     {
-        auto newEnd =
-            unique(text.begin(), text.end(),
-                [=](char lhs, char rhs) { return (lhs == rhs) && (lhs == ' '); }
-            );
-        text.erase(newEnd, text.end());
+    public:
+        WordIdCollector(Vocabulary& vocabulary, bool useLowerCase, wordIdDistribution* words, wordIdPairs* pairs, int range)
+            : vocabulary(vocabulary), useLowerCase(useLowerCase), words(words), pairs(pairs), window(pairs ? range : 0)
+        {
+        }
 
-    }
-    
-    // Siehe Header
-    void cleanUpText(std::string& text, cleanupType type)
-    {
-        if (type == None)
-            return;
+        void addWord(string_view word, int)
+        {
+            if (useLowerCase)
+            {
+                toLowerUtf8(word, wordKey);
+                word = wordKey;
+            }
+
+            wordId id = vocabulary.intern(word);
+            if (words)
+            {
+                if (id >= words->size())
+                    words->resize(vocabulary.size());
+                (*words)[id]++;
+            }
+            if (pairs)
+                window.add(id, *pairs);
+        }
+
+        void endSentence()
+        {
+            window.reset();
+        }
+
+    private:
+        Vocabulary& vocabulary;
+        bool useLowerCase;
+        wordIdDistribution* words;
+        wordIdPairs* pairs;
+        PairWindow window;
+        string wordKey;
+    };
 
-        replace(text.begin(), text.end(), '\n', ' ');
-        switch (type)
+    /**
+    * [intern]
+    * Der analyseText Durchlauf wenn nur Wortverteilung oder Wortpaare gebraucht werden. Hier reicht der Tokenizer.
+    */
+    template<class CharClass, class Collector>
+    void scanTokens(string_view text, const CharClass& charClass, Collector& collector)
+    {
+        size_t pos = 0, lastEnd = 0;
+        Token t;
+        while (findNextToken(text, pos, t, charClass))
         {
-            case cleanupType::removeAllSigns: cleanUpSigns(text, ",.!?-"); break;
-            case cleanupType::HTML: cleanUpHtml(text); break;
-            case cleanupType::Markdown: cleanUpMarkdown(text); break;
+            // zwischen dem letzten und diesem Wort liegt ein Satzende
+            for (size_t i = lastEnd; i < t.position; ++i)
+            {
+                if (charClass(text[i]) & charSentenceEnd)
+                {
+                    collector.endSentence();
+                    break;
+                }
+            }
+
+            collector.addWord(t.value, 0);
+            lastEnd = pos;
         }
-        cleanUpSpaces(text);
     }
 
-    // Siehe Header
-    std::string readFile(const std::string& path, cleanupType type)
+    /**
+    * [intern]
+    * Der analyseText Durchlauf über jedes Zeichen für Stats und Wortlängen. Die Worte gehen zusätzlich an den collector.
+    * Gibt zurück ob der letzte Buchstabe ein Vokal war.
+    */
+    template<class CharClass>
+    bool scanText(string_view text, const CharClass& charClass, Stats& stat, WordCollector& collector, bool isLastOneVowel)
     {
-        ifstream file(path);
-        if (file.is_open())
+        bool isWordStart = false;
+        size_t wordStart = 0;
+        int wordLetters = 0;
+
+        for (size_t i = 0; i < text.size(); ++i)
         {
-            string fileText, line;
-            while(getline(file,line))
-                fileText += line;
+            unsigned char flags = charClass(text[i]);
+            if (flags & charLetter)
+            {
+                stat.letters++;
+                bool isVowel = (flags & charVowel) != 0;
+                if (isVowel && !isLastOneVowel)
+                    stat.syllable++;
+                isLastOneVowel = isVowel;
 
-            if (!file.eof())
-                fileText = "Err";
+                if (!isWordStart)
+                {
+                    wordStart = i;
+                    wordLetters = 0;
+                }
+                wordLetters++;
+                isWordStart = true;
+            }
+            else if (flags & (charWordEnd | charSentenceEnd))
+            {
+                if (isWordStart && (flags & charWordEnd))
+                {
+                    stat.words++;
+                    if (flags & charSentenceEnd)
+                        stat.sentense++;
+                    isWordStart = false;
+                    collector.addWord(text.substr(wordStart, i - wordStart), wordLetters);
+                }
 
-            file.close();
+                // ein Satzende mitten im Wort gehört wie bei scanTokens zum Wort und trennt keine Wortpaare
+                if ((flags & charSentenceEnd) && !isWordStart)
+                    collector.endSentence();
+            }
+        }
 
-            cleanUpText(fileText, type);
-            return fileText;
+        if (isWordStart)
+        {
+            stat.words++;
+            stat.sentense++;
+            collector.addWord(text.substr(wordStart), wordLetters);
         }
-        return "";
+        return isLastOneVowel;
     }
 
-    // Siehe Header
-    searchList findPatterns(const std::string& text, const std::regex& pattern)
+    /**
+    * [intern]
+    * Ruft den passenden Durchlauf auf. Für die Standard Trennzeichen wird die Version mit der festen Tabelle genutzt.
+    */
+    template<class CharClass>
+    void scanWithCharClass(string_view text, int metrics, const CharClass& charClass, Stats& stat, WordCollector& collector, bool lastVowel)
     {
-        searchList occurVec;
-        const vector<smatch> matches{
-            sregex_iterator{text.begin(), text.end(), pattern},
-            sregex_iterator{}
-        };
+        if (metrics & (metricStats | metricWordLength))
+            scanText(text, charClass, stat, collector, lastVowel);
+        else
+            scanTokens(text, charClass, collector);
+    }
 
-        for (auto i : matches)
+    /**
+    * [intern]
+    * Analysiert einen Text oder einen Teil davon. lastVowel ist der Zustand am Ende des vorherigen Teils.
+    * Die Wortpaare werden hier noch nicht nach minOccurrences gefiltert.
+    */
+    RangeResult analyseRange(string_view text, int metrics, const AnalysisOptions& options, const CharTable& table, bool useDefaultTable, bool lastVowel)
+    {
+        ANALYSER_STAGE_TIMER(stageAnalyse);
+        RangeResult range;
+        AnalysisResult& result = range.result;
+        WordCollector collector(metrics, options, range);
+
+        ScanState state;
+        state.lastVowel = lastVowel;
+        if (metrics == metricStats && countStatsSimd(text, table, result.stats, state))
+        {
+            // ein offenes Wort am Ende zählt auch als Satz
+            if (state.inWord)
+            {
+                result.stats.words++;
+                result.stats.sentense++;
+            }
+        }
+        else if (useDefaultTable)
+        {
+            scanWithCharClass(text, metrics, DefaultCharClass(), result.stats, collector, lastVowel);
+        }
+        else
         {
-            int pos = i[0].first - text.begin();
-            occurVec.push_back({ i.str(), pos });
+            scanWithCharClass(text, metrics, RuntimeCharClass{ table }, result.stats, collector, lastVowel);
         }
+        ANALYSER_STAGE_ADD(stageAnalyse, fieldBytesIn, text.size());
+        ANALYSER_STAGE_ADD(stageAnalyse, fieldTokens, result.stats.words);
+        ANALYSER_STAGE_ADD(stageAnalyse, fieldSentences, result.stats.sentense);
+        return range;
+    }
 
-        return occurVec;
+    /**
+    * [intern]
+    * Schaltet die Wortpaare ab wenn range oder minOccurrences keinen Sinn ergeben
+    */
+    int checkMetrics(int metrics, const AnalysisOptions& options)
+    {
+        if (options.range < 2 || options.minOccurrences < 1)
+            metrics &= ~metricWordPairs;
+        return metrics;
     }
 
     // Siehe Header
-    double calculateWordLength(const std::string& text)
+    AnalysisResult analyseText(std::string_view text, int metrics, const AnalysisOptions& options)
     {
-        auto stat = createStatistics(text, defaultWordEnd, defaultSentenceEnd);
-        return static_cast<double>(stat.letters) / stat.words;
+        metrics = checkMetrics(metrics, options);
+        const bool useDefaultTable = options.wordEnd == defaultWordEnd && options.sentenceEnd == defaultSentenceEnd;
+        CharTable table = useDefaultTable ? defaultCharTable : makeCharTable(options.wordEnd, options.sentenceEnd);
+
+        RangeResult range = analyseRange(text, metrics, options, table, useDefaultTable, false);
+        finishPairs(range, options.minOccurrences);
+        if (!(metrics & metricStats))
+            range.result.stats = { 0, 0, 0, 0 };
+        return move(range.result);
     }
 
     // Siehe Header
-    double calculateSentenceLengthByWords(const std::string& text)
+    AnalysisResult analyseTextAsync(std::string_view text, int metrics, const AnalysisOptions& options)
     {
-        auto stat = createStatistics(text, defaultWordEnd, defaultSentenceEnd);
-        return static_cast<double>(stat.words) / stat.sentense;
+        metrics = checkMetrics(metrics, options);
+        const bool useDefaultTable = options.wordEnd == defaultWordEnd && options.sentenceEnd == defaultSentenceEnd;
+        CharTable table = useDefaultTable ? defaultCharTable : makeCharTable(options.wordEnd, options.sentenceEnd);
+
+        // Wortpaare dürfen nicht über ein Satzende hinweg gezählt werden, deshalb wird dann nur an Satzenden getrennt
+        unsigned char splitFlags = (metrics & metricWordPairs) ? (charWordEnd | charSentenceEnd) : charWordEnd;
+        shared_ptr<ThreadPool> pool = getThreadPool();
+        vector<size_t> bounds = findChunkBounds(text, chunkCountFor(text.size(), *pool), table, splitFlags);
+
+        vector<RangeResult> parts(bounds.size() - 1);
+        pool->parallelFor(parts.size(), [&](size_t i)
+            {
+                string_view chunk(text.data() + bounds[i], bounds[i + 1] - bounds[i]);
+                bool lastVowel = lastLetterIsVowel(text, bounds[i], table);
+                parts[i] = analyseRange(chunk, metrics, options, table, useDefaultTable, lastVowel);
+            });
+
+        AnalysisResult& result = parts[0].result;
+        for (size_t i = 1; i < parts.size(); ++i)
+        {
+            const AnalysisResult& part = parts[i].result;
+            result.stats.letters += part.stats.letters;
+            result.stats.words += part.stats.words;
+            result.stats.sentense += part.stats.sentense;
+            result.stats.syllable += part.stats.syllable;
+            for (const auto& [length, count] : part.wordLengths)
+                result.wordLengths[length] += count;
+            mergeCounts(result.words, parts[i].result.words);
+            mergePairs(parts[0], parts[i]);
+        }
+
+        finishPairs(parts[0], options.minOccurrences);
+        if (!(metrics & metricStats))
+            result.stats = { 0, 0, 0, 0 };
+        return move(result);
     }
 
-    // Siehe Header
-    double calculateSentenceLengthByLetters(const std::string& text)
+    /**
+    * [intern]
+    * Zählt nur die Stats ohne SIMD. Wie countStatsSimd bleibt ein offenes Wort am Ende in state.inWord stehen.
+    */
+    void countStatsScalar(string_view text, const CharTable& table, Stats& stat, ScanState& state)
     {
-        auto stat = createStatistics(text, defaultWordEnd, defaultSentenceEnd);
-        return static_cast<double>(stat.letters) / stat.sentense;
+        for (char c : text)
+        {
+            unsigned char flags = table[c];
+            if (flags & charLetter)
+            {
+                stat.letters++;
+                bool isVowel = (flags & charVowel) != 0;
+                if (isVowel && !state.lastVowel)
+                    stat.syllable++;
+                state.lastVowel = isVowel;
+                state.inWord = true;
+            }
+            else if ((flags & charWordEnd) && state.inWord)
+            {
+                stat.words++;
+                if (flags & charSentenceEnd)
+                    stat.sentense++;
+                state.inWord = false;
+            }
+        }
     }
 
-    // Siehe Header
-    wordLengthDistibution calculateWordLengthDistibution(const std::string& text, const std::string& wordEndSignes)
+    /**
+    * [intern]
+    * Der Zustand des StreamAnalyser. Die Teile werden direkt nach dem letzten Wortende getrennt, der Rest bis zum Ende
+    * des Teils wartet in pending auf den nächsten Teil. Wenn nur die Stats gebraucht werden reicht der ScanState.
+    */
+    struct StreamAnalyser::State
     {
-        wordLengthDistibution stat;
-        int wordLength = 0;
+        State(int requestedMetrics, const AnalysisOptions& options)
+            : requestedMetrics(requestedMetrics), options(options), metrics(checkMetrics(requestedMetrics, options)),
+            useDefaultTable(options.wordEnd == defaultWordEnd && options.sentenceEnd == defaultSentenceEnd),
+            table(useDefaultTable ? defaultCharTable : makeCharTable(options.wordEnd, options.sentenceEnd)),
+            collector(metrics, this->options, range)
+        {
+        }
+
+        bool isSplit(char c) const
+        {
+            return (table[c] & (charLetter | charWordEnd)) == charWordEnd;
+        }
 
-        for (int i = 0; i < text.size(); ++i)
+        /// Analysiert ein Stück das außerhalb eines Wortes beginnt
+        void scanUnit(string_view unit)
         {
-            if (isalpha(text[i], usedLocal) || germanSpecials.find(text[i]) != string::npos)
+            if (useDefaultTable)
+                scan.lastVowel = scanText(unit, DefaultCharClass(), range.result.stats, collector, scan.lastVowel);
+            else
+                scan.lastVowel = scanText(unit, RuntimeCharClass{ table }, range.result.stats, collector, scan.lastVowel);
+        }
+
+        void feed(string_view chunk)
+        {
+            size += chunk.size();
+            if (metrics == metricStats)
             {
-                wordLength++;
+                if (!countStatsSimd(chunk, table, range.result.stats, scan))
+                    countStatsScalar(chunk, table, range.result.stats, scan);
+                return;
             }
-            else if (wordLength > 0 && wordEndSignes.find(text[i]) != string::npos)
+
+            size_t first = 0;
+            if (!pending.empty())
             {
-                stat[wordLength]++;
-                wordLength = 0;
+                // das angefangene Wort aus dem letzten Teil zuerst beenden
+                while (first < chunk.size() && !isSplit(chunk[first]))
+                    ++first;
+                if (first == chunk.size())
+                {
+                    pending.append(chunk.data(), chunk.size());
+                    return;
+                }
+                ++first;
+                pending.append(chunk.data(), first);
+                scanUnit(pending);
+                pending.clear();
             }
+
+            size_t last = chunk.size();
+            while (last > first && !isSplit(chunk[last - 1]))
+                --last;
+            if (last > first)
+                scanUnit(chunk.substr(first, last - first));
+            pending.assign(chunk.data() + last, chunk.size() - last);
         }
 
-        if (wordLength > 0)
+        AnalysisResult finish()
         {
-            stat[wordLength]++;
-            wordLength = 0;
+            AnalysisResult& result = range.result;
+            if (metrics == metricStats)
+            {
+                // ein offenes Wort am Ende zählt auch als Satz
+                if (scan.inWord)
+                {
+                    result.stats.words++;
+                    result.stats.sentense++;
+                }
+            }
+            else if (!pending.empty())
+            {
+                scanUnit(pending);
+            }
+            finishPairs(range, options.minOccurrences);
+
+            if (!(metrics & metricStats))
+                result.stats = { 0, 0, 0, 0 };
+            return move(result);
         }
-        return stat;
+
+        int requestedMetrics;
+        AnalysisOptions options;
+        int metrics;
+        bool useDefaultTable;
+        CharTable table;
+        RangeResult range;
+        WordCollector collector;
+        ScanState scan;
+        string pending;
+        uint64_t size = 0;
+    };
+
+    // Siehe Header
+    StreamAnalyser::StreamAnalyser(int metrics, const AnalysisOptions& options)
+        : state(make_unique<State>(metrics, options))
+    {
     }
 
     // Siehe Header
-    wordLengthDistibution calculateWordLengthDistibutionAsync(const std::string& text, const std::string& wordEndSignes)
+    StreamAnalyser::~StreamAnalyser() = default;
+
+    // Siehe Header
+    StreamAnalyser::StreamAnalyser(StreamAnalyser&& other) noexcept = default;
+
+    // Siehe Header
+    StreamAnalyser& StreamAnalyser::operator=(StreamAnalyser&& other) noexcept = default;
+
+    // Siehe Header
+    void StreamAnalyser::feed(std::string_view chunk)
     {
-        future<wordLengthDistibution> res = async(launch::async, calculateWordLengthDistibution, text, wordEndSignes);
-        return res.get();
+        ANALYSER_STAGE_TIMER(stageAnalyse);
+        ANALYSER_STAGE_ADD(stageAnalyse, fieldBytesIn, chunk.size());
+        state->feed(chunk);
     }
 
     // Siehe Header
-    wordPairs findConnectedWords(const std::string& text, int minOccurrences, int range)
+    AnalysisResult StreamAnalyser::finish()
+    {
+        AnalysisResult result = state->finish();
+        state = make_unique<State>(state->requestedMetrics, state->options);
+        return result;
+    }
+
+    // Siehe Header
+    std::uint64_t StreamAnalyser::size() const
     {
-        unordered_map<strPair, int, PairHash> collection;
+        return state->size;
+    }
 
+    // Siehe Header
+    AnalysisResult analyseStream(std::istream& input, int metrics, const AnalysisOptions& options)
+    {
+        StreamAnalyser analyser(metrics, options);
+        vector<char> block(1 << 20);
+        while (input)
+        {
+            input.read(block.data(), static_cast<streamsize>(block.size()));
+            size_t count = static_cast<size_t>(input.gcount());
+            if (count == 0)
+                break;
+            analyser.feed(string_view(block.data(), count));
+        }
+        return analyser.finish();
+    }
+
+    // Siehe Header
+    wordIdDistribution createWordIdDistribution(const std::string& text, Vocabulary& vocabulary, bool useLowerCase)
+    {
+        wordIdDistribution words;
+        WordIdCollector collector(vocabulary, useLowerCase, &words, nullptr, 0);
+        scanTokens(text, DefaultCharClass(), collector);
+        words.resize(vocabulary.size());
+        return words;
+    }
+
+    // Siehe Header
+    wordIdPairs findConnectedWordIds(const std::string& text, Vocabulary& vocabulary, int minOccurrences, int range)
+    {
+        wordIdPairs pairs;
         if (range < 2 || minOccurrences < 1)
-            return collection;
+            return pairs;
 
-        stringList sentenceList = splitTextIntoStringList(text, true, defaultSentenceEnd);
-        for (const string& sentence : sentenceList)
+        WordIdCollector collector(vocabulary, true, nullptr, &pairs, range);
+        scanTokens(text, DefaultCharClass(), collector);
+        if (minOccurrences > 1)
+            pairs.prune(minOccurrences);
+        return pairs;
+    }
+
+    /**
+    * [intern]
+    * Sammelt die Worte für die näherungsweise Zählung. Für die Paare werden wie früher die letzten (range - 1)
+    * Worte als strings in einem Ringpuffer gehalten, da es keine Ids gibt.
+    */
+    class ApproximateCollector
+    {
+    public:
+        ApproximateCollector(ApproximateCounter& counter, bool useLowerCase, int range)
+            : counter(counter), useLowerCase(useLowerCase), window(range > 1 ? range - 1 : 0)
+        {
+        }
+
+        void addWord(string_view word, int)
         {
-            stringList wordList = splitTextIntoStringList(sentence, true, defaultWordEnd);
-            for (int i = 1; i < min(range, static_cast<int>(wordList.size())); ++i)
+            if (useLowerCase)
+                toLowerUtf8(word, wordKey);
+            else
+                wordKey.assign(word);
+
+            if (window.empty())
+            {
+                counter.add(wordKey);
+                return;
+            }
+
+            size_t windowSize = window.size();
+            size_t count = min(windowPos, windowSize);
+            for (size_t d = count; d > 0; --d)
             {
-                for (auto it = wordList.begin(); it != wordList.end() - i; it++)
-                    collection[{*it, * (it + i)}]++;
+                const string& first = window[(windowPos - d) % windowSize];
+                pairKey.assign(first).append(1, ' ').append(wordKey);
+                counter.add(pairKey);
             }
+            window[windowPos % windowSize].swap(wordKey);
+            windowPos++;
         }
-        for (auto it = collection.begin(); it != collection.end();)
+
+        void endSentence()
         {
-            if (it->second < minOccurrences)
-                it = collection.erase(it);
-            else
-                it++;
+            windowPos = 0;
         }
 
-        return collection;
+    private:
+        ApproximateCounter& counter;
+        bool useLowerCase;
+        vector<string> window;
+        size_t windowPos = 0;
+        string wordKey;
+        string pairKey;
+    };
+
+    // Siehe Header
+    ApproximateCounter createApproximateWordDistribution(const std::string& text, const ApproximateOptions& options, bool useLowerCase)
+    {
+        ApproximateCounter counter(options);
+        ApproximateCollector collector(counter, useLowerCase, 0);
+        scanTokens(text, DefaultCharClass(), collector);
+        return counter;
     }
 
     // Siehe Header
-    wordPairs findConnectedWordsAsync(const std::string& text, int minOccurrences, int range)
+    ApproximateCounter findConnectedWordsApproximate(const std::string& text, const ApproximateOptions& options, int range)
+    {
+        ApproximateCounter counter(options);
+        if (range < 2)
+            return counter;
+
+        ApproximateCollector collector(counter, true, range);
+        scanTokens(text, DefaultCharClass(), collector);
+        return counter;
+    }
+
+    // Siehe Header
+    strPair splitPairKey(std::string_view key)
+    {
+        size_t space = key.find(' ');
+        if (space == string_view::npos)
+            return strPair(key, string_view());
+        return strPair(key.substr(0, space), key.substr(space + 1));
+    }
+
+    // Siehe Header
+    wordDistribution toWordDistribution(const wordIdDistribution& distribution, const Vocabulary& vocabulary)
+    {
+        wordDistribution words;
+        for (size_t id = 0; id < distribution.size(); ++id)
+        {
+            if (distribution[id] > 0)
+                words.emplace(vocabulary.word(static_cast<wordId>(id)), distribution[id]);
+        }
+        return words;
+    }
+
+    // Siehe Header
+    wordPairs toWordPairs(const wordIdPairs& pairs, const Vocabulary& vocabulary)
     {
-        future<wordPairs> res = async(launch::async, findConnectedWords, text, minOccurrences, range);
-        return res.get();
+        wordPairs result;
+        result.reserve(pairs.size());
+        pairs.forEach([&](wordIdPair ids, int count)
+            {
+                result.emplace(strPair(vocabulary.word(ids.first), vocabulary.word(ids.second)), count);
+            });
+        return result;
     }
 
     // Siehe Header
     ReadabilityScore calculateGermanScore(const std::string& text)
     {
-        auto stat = createStatistics(text, defaultWordEnd, defaultSentenceEnd);
+        return calculateGermanScore(createStatistics(text, defaultWordEnd, defaultSentenceEnd));
+    }
+
+    // Siehe Header
+    ReadabilityScore calculateGermanScore(const Stats& stat)
+    {
         double score = 180 - (static_cast<double>(stat.words) / stat.sentense) - 58.5 * (static_cast<double>(stat.syllable) / stat.words);
         
-        if (score >= 90)    //    90 - 100: Sehr leicht.Geeignet fr einen 11 jhrigen Schler.
+        if (score >= 90)    //    90 - 100: Sehr leicht.Geeignet für einen 11 jährigen Schüler.
             return VeryEasy;
         
         if (score >= 80)    //    80 - 90 : Leicht
@@ -449,7 +1194,7 @@ namespace AnalyserLib
         if (score >= 70)    //    70 - 80 : Mittelleicht
             return MediumEasy;
         
-        if (score >= 60)    //    60 - 70 : Mittel.Geeignet fr 13 - 15 jhrige Schler.
+        if (score >= 60)    //    60 - 70 : Mittel.Geeignet für 13 - 15 jährige Schüler.
             return Medium;
         
         if (score >= 50)    //    50 - 60 : Mittelschwer
@@ -458,6 +1203,6 @@ namespace AnalyserLib
         if (score >= 30)    //    30 - 50 : Schwer
             return Hard;
         
-        return VeryHard;    //    0 - 30 : Sehr schwer.Geeignet fr Akademiker.
+        return VeryHard;    //    0 - 30 : Sehr schwer.Geeignet für Akademiker.
     }
 }
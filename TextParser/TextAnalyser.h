@@ -1,9 +1,9 @@
 /**
 * TextAnalyser.h
 * 
-* Das ist eine Bibliothek fr die Analyse von Texten. Texte knnen aus Dateien geladen und bereinigt werden.
-* Sie enthlt Basisfunktionen wie Wortanzahl, Wortverteilung, Wort- oder Satzlnge.
-* Zustzlich kann man sich auch den Lesbarkeitswert berechnen lassen oder hufige vorkommen von wortpaaren ausgeben lassen
+* Das ist eine Bibliothek für die Analyse von Texten. Texte können aus Dateien geladen und bereinigt werden.
+* Sie enthält Basisfunktionen wie Wortanzahl, Wortverteilung, Wort- oder Satzlänge.
+* Zusätzlich kann man sich auch den Lesbarkeitswert berechnen lassen oder häufige vorkommen von wortpaaren ausgeben lassen
 * 
 * Autor: Alexander Stiller
 * Version: 1.0
@@ -12,15 +12,24 @@
 #ifndef TEXTANALYSER
 #define TEXTANALYSER
 
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <map>
 #include <regex>
+#include "ApproximateCounter.h"
+#include "CleanupFilters.h"
+#include "PairCounter.h"
+#include "StopWordFilter.h"
+#include "Vocabulary.h"
 
 namespace AnalyserLib
 {
-	/// defines fr bessere lesbarkeit
+	/// defines für bessere lesbarkeit
 	using wordDistribution = std::unordered_map<std::string, int>;
 	using constStringList = const std::vector<std::string>;
 	using wordLengthDistibution = std::map<int, int>;
@@ -29,98 +38,258 @@ namespace AnalyserLib
 	#define defaultSentenceEnd ".!?"
 	#define syllableDetection "aeiouy"
 
+	/**
+	* Flags für die Einteilung von Zeichen. Eine CharTable speichert sie für alle 256 Byte-Werte.
+	*/
+	enum charFlag : unsigned char
+	{
+		charLetter = 1,
+		charWordEnd = 2,
+		charSentenceEnd = 4,
+		charVowel = 8
+	};
+
+	/**
+	* Eine Tabelle mit den charFlag Werten für jedes Byte. Sie wird einmal pro Kombination aus Trennzeichen erstellt,
+	* damit in den Schleifen nur noch ein Tabellenzugriff pro Zeichen nötig ist und keine Suche in den Trennzeichen.
+	*/
+	struct CharTable
+	{
+		unsigned char flags[256] = {};
+
+		constexpr unsigned char operator[](char c) const { return flags[static_cast<unsigned char>(c)]; }
+	};
+
+	/**
+	* Erstellt eine CharTable. Buchstaben sind a-z, A-Z, die deutschen Sonderzeichen (Latin-1) und die UTF-8 Startbytes lateinischer Buchstaben.
+	*
+	* @param	wordEnd: Zeichen die ein Wort beenden
+	*			sentenceEnd (default = defaultSentenceEnd ".!?"): Zeichen die einen Satz beenden
+	*			vowels (default = syllableDetection "aeiouy"): Zeichen die für die Silbenerkennung gezählt werden
+	* @return	Gibt die fertige Tabelle zurück
+	*/
+	constexpr CharTable makeCharTable(std::string_view wordEnd, std::string_view sentenceEnd = defaultSentenceEnd, std::string_view vowels = syllableDetection)
+	{
+		CharTable table{};
+		for (int c = 'a'; c <= 'z'; ++c)
+		{
+			table.flags[c] |= charLetter;
+			table.flags[c - 'a' + 'A'] |= charLetter;
+		}
+		// ÄäÖöÜüß
+		for (char c : std::string_view("\xC4\xE4\xD6\xF6\xDC\xFC\xDF"))
+			table.flags[static_cast<unsigned char>(c)] |= charLetter;
+		// Startbytes der UTF-8 Buchstaben U+00C0 bis U+024F (ä ist C3 A4), die Folgebytes bleiben neutral.
+		// So zählt jeder lateinische Buchstabe in UTF-8 einmal und trennt kein Wort. In Latin-1 sind es Ã bis É.
+		for (int c = 0xC3; c <= 0xC9; ++c)
+			table.flags[c] |= charLetter;
+
+		for (char c : wordEnd)
+			table.flags[static_cast<unsigned char>(c)] |= charWordEnd;
+		for (char c : sentenceEnd)
+			table.flags[static_cast<unsigned char>(c)] |= charSentenceEnd;
+		for (char c : vowels)
+			table.flags[static_cast<unsigned char>(c)] |= charVowel;
+		return table;
+	}
+
+	/// Die Tabelle für die Standard Trennzeichen, wird zur Compilezeit erstellt
+	inline constexpr CharTable defaultCharTable = makeCharTable(defaultWordEnd, defaultSentenceEnd, syllableDetection);
+
+	/**
+	* Zeichenklassen für die Schleifen, die als Template Parameter übergeben werden.
+	* DefaultCharClass nutzt die Standardtabelle die schon zur Compilezeit bekannt ist,
+	* RuntimeCharClass eine Tabelle für selbst gewählte Trennzeichen.
+	*/
+	struct DefaultCharClass
+	{
+		constexpr unsigned char operator()(char c) const { return defaultCharTable[c]; }
+	};
+	struct RuntimeCharClass
+	{
+		const CharTable& table;
+		unsigned char operator()(char c) const { return table[c]; }
+	};
+
 	/// ein vector of string, bessere lesbarkeit
 	using stringList = std::vector<std::string>;
 	/// ein const vector of string, bessere lesbarkeit
 	using constStringList = const std::vector<std::string>;
 
 	/**
-	* Unterteilt einen Text in kleinere Segmente. Je nachdem was fr Zeichen bergeben werde kann man in Worte, Stze oder was gewnscht unterteilen.
+	* Unterteilt einen Text in kleinere Segmente. Je nachdem was für Zeichen übergeben werde kann man in Worte, Sätze oder was gewünscht unterteilen.
 	*
-	* @param	text: der bergebene Text der unterteilt werden soll
-	*			useLowerCase (default = false): wenn es gesetzt ist wird der text in lowercase bertragen
-	*			endingPattern (defult = defaultWordEnd " .,-!?\n"): Jedes Zeichen in dem string sogt dafr das ein Teilstring erzeugt wird.
-	* @return	Gibt ein vector of String mit den unterteilten strings zurck
+	* @param	text: der übergebene Text der unterteilt werden soll
+	*			useLowerCase (default = false): wenn es gesetzt ist wird der text in lowercase übertragen, auch Umlaute und Akzente in UTF-8 und Latin-1 (siehe toLowerUtf8)
+	*			endingPattern (defult = defaultWordEnd " .,-!?\n"): Jedes Zeichen in dem string sogt dafür das ein Teilstring erzeugt wird.
+	* @return	Gibt ein vector of String mit den unterteilten strings zurück
 	*/
 	stringList splitTextIntoStringList(const std::string& text, bool useLowerCase = false, const std::string& endingPattern = defaultWordEnd);
 
 	/**
-	* Async version
+	* Async version. Der Text wird an Wortenden in Teile zerlegt die parallel unterteilt werden.
+	* Das Ergebnis ist identisch zur normalen Version, die Anzahl der Threads wird mit setThreadCount festgelegt.
 	*/
 	stringList splitTextIntoStringListAsync(const std::string& text, bool useLowerCase = false, const std::string& endingPattern = defaultWordEnd);
 
 	/**
-	* Zhlt alle Worte in dem bergebenen Text
+	* Ein Wort aus dem Text ohne Kopie. value zeigt direkt in den Text und ist nur so lange gültig wie der Text selbst.
+	*/
+	struct Token
+	{
+		std::string_view value;
+		size_t position;
+	};
+
+	/**
+	* Zerlegt einen Text erst beim iterieren in Worte, ohne einen stringList anzulegen.
+	* Die Worte werden genauso getrennt wie bei splitTextIntoStringList.
+	*
+	* Beispiel:	for (Token t : tokenize(text)) { ... }
+	*/
+	class TokenRange
+	{
+	public:
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Token;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Token*;
+			using reference = const Token&;
+
+			iterator() = default;
+			iterator(const TokenRange* range, size_t position) : range(range), next(position) { ++(*this); }
+
+			reference operator*() const { return current; }
+			pointer operator->() const { return &current; }
+			iterator& operator++();
+			iterator operator++(int) { iterator tmp = *this; ++(*this); return tmp; }
+			bool operator==(const iterator& o) const { return current.position == o.current.position; }
+			bool operator!=(const iterator& o) const { return !(*this == o); }
+
+		private:
+			const TokenRange* range = nullptr;
+			size_t next = 0;
+			Token current{ {}, std::string_view::npos };
+		};
+
+		TokenRange(std::string_view text, std::string_view endingPattern = defaultWordEnd)
+			: text(text), useDefaultTable(endingPattern == defaultWordEnd),
+			table(useDefaultTable ? defaultCharTable : makeCharTable(endingPattern))
+		{
+		}
+
+		iterator begin() const { return iterator(this, 0); }
+		iterator end() const { return iterator(); }
+
+	private:
+		std::string_view text;
+		bool useDefaultTable;
+		CharTable table;
+	};
+
+	/**
+	* Erzeugt eine TokenRange über den Text. Der Text muss so lange existieren wie die TokenRange genutzt wird.
+	*
+	* @param	text: der Text der unterteilt werden soll
+	*			endingPattern (defult = defaultWordEnd " .,-!?\n"): Jedes Zeichen in dem string beendet ein Wort.
+	* @return	Gibt eine TokenRange zurück über die man mit einer for Schleife iterieren kann
+	*/
+	inline TokenRange tokenize(std::string_view text, std::string_view endingPattern = defaultWordEnd)
+	{
+		return TokenRange(text, endingPattern);
+	}
+
+	/**
+	* Zählt alle Worte in dem übergebenen Text
 	*
-	* @param	text: ein Text im dem alle Wrter gezhlt werden sollen
+	* @param	text: ein Text im dem alle Wörter gezählt werden sollen
 	* @return	Die Anzahl aller Worte
 	*/
-	int countTotalWords(const std::string& text);
+	std::int64_t countTotalWords(const std::string& text);
 
 	/**
-	* Async version
+	* Async version. Der Text wird in Teile zerlegt die parallel gezählt werden.
 	*/
-	int countTotalWordsAsync(const std::string& text);
+	std::int64_t countTotalWordsAsync(const std::string& text);
 
 	/**
-	* Zhlt die Hufigkeit jedes Wortes im Text. Convertiert intern den Text in eine Liste von Wrtern
+	* Zählt die Häufigkeit jedes Wortes im Text. Convertiert intern den Text in eine Liste von Wörtern
 	*
-	* @param	text: Der Text in dem alle Wrter aufgelistet werden sollen
-	*			useLowerCase (default = false): wenn useLowerCase gesetzt ist wird der jedes wort in lowercase convertiert
-	* @return	Gibt eine Unordered map of string int zurck. Key ist das Wort und der Value ist die Hufigkeit wie oft ein Wort vorgekommen ist
+	* @param	text: Der Text in dem alle Wörter aufgelistet werden sollen
+	*			useLowerCase (default = false): wenn useLowerCase gesetzt ist wird der jedes wort in lowercase convertiert, auch Umlaute und Akzente in UTF-8 und Latin-1 (siehe toLowerUtf8)
+	* @return	Gibt eine Unordered map of string int zurück. Key ist das Wort und der Value ist die Häufigkeit wie oft ein Wort vorgekommen ist
 	*/
 	wordDistribution createWordDistribution(const std::string& text, bool useLowerCase = false);
 	
 	/**
-	* Zhlt die Hufigkeit jedes Wortes im Text. Convertiert intern den Text in eine Liste von Wrtern
+	* Zählt die Häufigkeit jedes Wortes im Text. Convertiert intern den Text in eine Liste von Wörtern
 	*
-	* @param	text: Der Text in dem alle Wrter aufgelistet werden sollen
-	*			stopWords: Eine Liste von Strings die ignoriert werden sollen und somit nicht mitgezhlt werden
+	* @param	text: Der Text in dem alle Wörter aufgelistet werden sollen
+	*			stopWords: Eine Liste von Strings die ignoriert werden sollen und somit nicht mitgezählt werden
 	*			useLowerCase (default = false): wenn useLowerCase gesetzt ist wird der jedes wort in lowercase convertiert
-	* @return	Gibt eine Unordered map of string int zurck. Key ist das Wort und der Value ist die Hufigkeit wie oft ein Wort vorgekommen ist
+	* @return	Gibt eine Unordered map of string int zurück. Key ist das Wort und der Value ist die Häufigkeit wie oft ein Wort vorgekommen ist
 	*/
 	wordDistribution createWordDistribution(const std::string& text, constStringList& stopWords, bool caseSensitive = false);
 	
 	/**
-	* Zhlt die Hufigkeit jedes Wortes im Text
+	* Zählt die Häufigkeit jedes Wortes im Text
 	*
-	* @param	wordList: Eine Liste von Wrtern die evaluiert werden soll
-	*			stopWords: Eine Liste von Strings die ignoriert werden sollen und somit nicht mitgezhlt werden
-	* @return	Gibt eine Unordered map of string int zurck. Key ist das Wort und der Value ist die Hufigkeit wie oft ein Wort vorgekommen ist
+	* @param	wordList: Eine Liste von Wörtern die evaluiert werden soll
+	*			stopWords: Eine Liste von Strings die ignoriert werden sollen und somit nicht mitgezählt werden
+	* @return	Gibt eine Unordered map of string int zurück. Key ist das Wort und der Value ist die Häufigkeit wie oft ein Wort vorgekommen ist
 	*/
 	wordDistribution createWordDistribution(constStringList& wordList, constStringList& stopWords);
 
 	/**
-	* Async version
+	* Zählt die Häufigkeit jedes Wortes im Text ohne die Stoppwörter aus dem Filter
+	*
+	* @param	text: Der Text in dem alle Wörter aufgelistet werden sollen
+	*			stopWords: Die Stoppwörter, z.B. StopWordFilter::german()
+	*			useLowerCase (default = false): wenn useLowerCase gesetzt ist wird der jedes wort in lowercase convertiert
+	* @return	Gibt eine Unordered map of string int zurück. Key ist das Wort und der Value ist die Häufigkeit wie oft ein Wort vorgekommen ist
+	*/
+	wordDistribution createWordDistribution(const std::string& text, const StopWordFilter& stopWords, bool useLowerCase = false);
+
+	/**
+	* Zählt die Häufigkeit jedes Wortes in der Liste ohne die Stoppwörter aus dem Filter
+	*
+	* @param	wordList: Eine Liste von Wörtern die evaluiert werden soll
+	*			stopWords: Die Stoppwörter, z.B. StopWordFilter::german()
+	* @return	Gibt eine Unordered map of string int zurück. Key ist das Wort und der Value ist die Häufigkeit wie oft ein Wort vorgekommen ist
+	*/
+	wordDistribution createWordDistribution(constStringList& wordList, const StopWordFilter& stopWords);
+
+	/**
+	* Async version. Die Wortliste wird in Teile zerlegt, deren Verteilungen parallel erstellt und zusammengeführt werden.
 	*/
 	wordDistribution createWordDistributionAsync(constStringList& wordList, constStringList& stopWords);
 
 	/**
-	* Enum zum einstellen mit welcher methode der Text aufgerumt werden soll
+	* Async version mit StopWordFilter
 	*/
-	enum cleanupType
-	{
-		None = 0,
-		plain = 1,
-		removeAllSigns = 2,
-		HTML = 4,
-		Markdown = 8
-	};
+	wordDistribution createWordDistributionAsync(constStringList& wordList, const StopWordFilter& stopWords);
+
 	/**
-	* Entfernt unerwnschte zeichen aus dem Text. Zeilenumbrche und berflssige Leerzeichen werden immer entfernt
+	* Entfernt unerwünschte zeichen aus dem Text. Zeilenumbrüche und überflüssige Leerzeichen werden immer entfernt.
+	* Der Text läuft in Blöcken durch eine CleanupPipeline, die Methoden können kombiniert werden, z.B. HTML | removeAllSigns.
 	*
-	* @param	origin: Der Text der aufgerumt werden soll. Origin wird in dieser Funktion direkt angepasst und ist gleichzeitig der return Wert.
-	*			type (default=plain): Definiert die Methode mit der der Text aufgerumt werden soll
+	* @param	origin: Der Text der aufgeräumt werden soll. Origin wird in dieser Funktion direkt angepasst und ist gleichzeitig der return Wert.
+	*			type (default=plain): Definiert die Methoden mit denen der Text aufgeräumt werden soll
 	* @return	void
 	*/
 	void cleanUpText(std::string& origin, cleanupType type = cleanupType::plain);
 
 	/**
-	* Ld eine text datei und gibt einen aufgerumten String zurck
+	* Läd eine text datei und gibt einen aufgeräumten String zurück. Die Datei wird gemappt und nur einmal kopiert,
+	* Zeilenumbrüche bleiben erhalten (\r\n wird zu \n). Soll der Text nicht aufgeräumt werden kann die Datei auch
+	* direkt mit MappedFile geöffnet und der view an analyseText übergeben werden.
 	*
 	* @param	path: Der Pfad und die Datei die geladen werden soll
-	*			type (default=plain): Definiert die Methode mit der der Text aufgerumt werden soll
-	* @return	Gibt den geladenen und aufgerumten Text zurck. Bei Fehlern einen leeren string.
+	*			type (default=plain): Definiert die Methode mit der der Text aufgeräumt werden soll
+	* @return	Gibt den geladenen und aufgeräumten Text zurück. Bei Fehlern einen leeren string.
 	*/
 	std::string readFile(const std::string& path, cleanupType type = cleanupType::plain);
 
@@ -130,7 +299,8 @@ namespace AnalyserLib
 	struct SearchResult
 	{
 		std::string value;
-		int position;
+		/// Position im Text, 64 bit damit auch Dateien über 2 GB funktionieren
+		std::uint64_t position;
 	};
 	/// ein Vector of SearchResult
 	using searchList = std::vector<SearchResult>;
@@ -139,20 +309,31 @@ namespace AnalyserLib
 	*
 	* @param	text: Der Text der nach dem Muster durchsucht werden soll
 	*			pattern: Gibt das Muster an nach dem gesucht werden soll
-	* @return	Gibt einen Vector of SearchResult zurck. Enthlt alle gefundenen string mit ihrere jeweiligen Position im Text.
+	* @return	Gibt einen Vector of SearchResult zurück. Enthält alle gefundenen string mit ihrere jeweiligen Position im Text.
 	*/
 	searchList findPatterns(const std::string& text, const std::regex& pattern);
 
 	/**
-	* Berechnet die durchschnittliche Wortlnge
+	* Suche nach Pattern im Text. Einfache Muster wie \b\w{6}\b werden mit dem PatternMatcher ohne std::regex gesucht,
+	* das Ergebnis ist dasselbe wie mit std::regex. Für mehrere Suchen mit demselben Muster oder Treffer ohne Kopie
+	* kann direkt ein PatternMatcher genutzt werden.
+	*
+	* @param	text: Der Text der nach dem Muster durchsucht werden soll
+	*			pattern: Das Muster in ECMAScript Syntax
+	* @return	Gibt einen Vector of SearchResult zurück. Enthält alle gefundenen string mit ihrere jeweiligen Position im Text.
+	*/
+	searchList findPatterns(const std::string& text, std::string_view pattern);
+
+	/**
+	* Berechnet die durchschnittliche Wortlänge
 	*
 	* @param	text: Der Text zum berechnen
-	* @return	Gibt die durchschnittliche Wortlnge aus
+	* @return	Gibt die durchschnittliche Wortlänge aus
 	*/
 	double calculateWordLength(const std::string& text);
 
 	/**
-	* Berechnet die durchschnittliche Satzlnge anhand von Wrtern
+	* Berechnet die durchschnittliche Satzlänge anhand von Wörtern
 	*
 	* @param	text: Der Text zum berechnen
 	* @return	Gibt die durchschnittliche Wortanzahl pro Satz aus
@@ -160,7 +341,7 @@ namespace AnalyserLib
 	double calculateSentenceLengthByWords(const std::string& text);
 
 	/**
-	* Berechnet die durchschnittliche Satzlnge anhand von Zeichen
+	* Berechnet die durchschnittliche Satzlänge anhand von Zeichen
 	*
 	* @param	text: Der Text zum berechnen
 	* @return	Gibt die durchschnittliche Zeichenanzahl pro Satz aus
@@ -168,24 +349,24 @@ namespace AnalyserLib
 	double calculateSentenceLengthByLetters(const std::string& text);
 
 	/**
-	* Berechnet die durchschnittliche Wortlngen verteilung. Also wie viele Worte gibt es von einer bestimmten lnge
+	* Berechnet die durchschnittliche Wortlängen verteilung. Also wie viele Worte gibt es von einer bestimmten länge
 	*
 	* @param	text: Der Text zum berechnen
 	*			endingPattern (defult = defaultWordEnd " .,-!?\n"): Damit wird definiert wann ein Wort zu ende ist und ein neues Wort beginnt.
-	* @return	Gibt eine map of int int zurck. Key ist die Anzahl der Buchstaben im Wort und der Value ist die Anzahl der Worte mit der selben Buchstaben zahl.
+	* @return	Gibt eine map of int int zurück. Key ist die Anzahl der Buchstaben im Wort und der Value ist die Anzahl der Worte mit der selben Buchstaben zahl.
 	*/
 	wordLengthDistibution calculateWordLengthDistibution(const std::string& text, const std::string& endingPattern = defaultWordEnd);
 
 	/**
-	* Async version
+	* Async version. Der Text wird an Wortenden in Teile zerlegt die parallel ausgewertet werden.
 	*/
 	wordLengthDistibution calculateWordLengthDistibutionAsync(const std::string& text, const std::string& endingPattern = defaultWordEnd);
 
-	/// ein string tuple um 2 Worte zu verknpfen
+	/// ein string tuple um 2 Worte zu verknüpfen
 	using strPair = std::pair<std::string, std::string>;
 	/**
 	* Erzeugt ein Hash aus zwei strings.
-	* Dieses Struct wird bentigt damit strPair als Key fr die map genutzt werden kann.
+	* Dieses Struct wird benötigt damit strPair als Key für die map genutzt werden kann.
 	*/
 	struct PairHash
 	{
@@ -193,55 +374,279 @@ namespace AnalyserLib
 		{
 			size_t h1 = std::hash<std::string>{}(o.first);
 			size_t h2 = std::hash<std::string>{}(o.second);
-			return h1 ^ (h2 << 1);
+			// wie boost::hash_combine, damit (a, b) und (b, a) bzw. gleiche Worte nicht zusammenfallen
+			return h1 ^ (h2 + static_cast<size_t>(0x9e3779b97f4a7c15ULL) + (h1 << 6) + (h1 >> 2));
 		}
 	};
 	// Eine Map mit einem Tuple als key und einem eigenem struct um aus dem tuple ein hash zu generieren
 	using wordPairs = std::unordered_map<strPair, int, PairHash>;
 	/**
 	* Findet herraus welche Worte in einem Satz zusammen auftreten in einer festgelegten Reichweite.
-	* Kann verwendet werden fr eine "Ko - Okkurrenz Analyse".
+	* Kann verwendet werden für eine "Ko - Okkurrenz Analyse".
 	* 
 	* @param	text: Der Text zum durchsuchen
 	*			minOccurrences (default=2): Legt fest wie oft eine Paarung auftreten muss damit es in der Ausgabe landet.
-	*			range (default=2): Legt die reichweite fest in der Paarungen auftreten knnen. Ein Wert unter 2 ist nicht sinnvoll.
-	* @return	Gibt eine Unordered Map of strPair int zurck. Der Key besteht aus einem string paar, die beiden Worte die in einem Satz vorgekommen sind.
+	*			range (default=2): Legt die reichweite fest in der Paarungen auftreten können. Ein Wert unter 2 ist nicht sinnvoll.
+	* @return	Gibt eine Unordered Map of strPair int zurück. Der Key besteht aus einem string paar, die beiden Worte die in einem Satz vorgekommen sind.
 	*			Der Value ist die Anzahl wie oft die Kombination vorgekommen ist.
 	*/
 	wordPairs findConnectedWords(const std::string& text, int minOccurrences = 2, int range = 2);
 
 	/**
-	* Async version
+	* Async version. Der Text wird an Satzenden in Teile zerlegt, die Paare werden parallel gezählt und erst nach dem
+	* Zusammenführen nach minOccurrences gefiltert.
 	*/
 	wordPairs findConnectedWordsAsync(const std::string& text, int minOccurrences = 2, int range = 2);
 
 	/**
-	* Ein enum fr die bessere Einteilung des Lesbarkeitswertes
+	* Wie findConnectedWords, aber die Stoppwörter werden vorher aus dem Text entfernt.
+	* Sie belegen keinen Platz in der Reichweite, die Worte davor und danach bilden also ein Paar.
+	*/
+	wordPairs findConnectedWords(const std::string& text, const StopWordFilter& stopWords, int minOccurrences = 2, int range = 2);
+
+	/**
+	* Wie createWordDistribution, aber die Worte werden im Vocabulary abgelegt und nach ihrer Id gezählt.
+	*
+	* @param	text: Der Text in dem alle Wörter gezählt werden sollen
+	*			vocabulary: Der Wortschatz in den neue Worte eingetragen werden. Kann für mehrere Texte genutzt werden.
+	*			useLowerCase (default = false): wenn useLowerCase gesetzt ist wird jedes Wort in lowercase convertiert
+	* @return	Gibt die Häufigkeit jeder wordId zurück. Der Vector hat die Größe des Vocabulary nach dem Aufruf.
+	*/
+	wordIdDistribution createWordIdDistribution(const std::string& text, Vocabulary& vocabulary, bool useLowerCase = false);
+
+	/**
+	* Wie findConnectedWords, aber die Worte werden im Vocabulary abgelegt und die Paare nach ihren Ids gezählt.
+	* Dadurch wird pro Paar nur ein 64 bit Wert gehasht und jedes Wort nur einmal gespeichert.
+	*
+	* @param	text: Der Text zum durchsuchen
+	*			vocabulary: Der Wortschatz in den neue Worte (lowercase) eingetragen werden
+	*			minOccurrences (default=2): Legt fest wie oft eine Paarung auftreten muss damit es in der Ausgabe landet.
+	*			range (default=2): Legt die reichweite fest in der Paarungen auftreten können
+	* @return	Gibt die Häufigkeit jedes wordIdPair zurück
+	*/
+	wordIdPairs findConnectedWordIds(const std::string& text, Vocabulary& vocabulary, int minOccurrences = 2, int range = 2);
+
+	/**
+	* Näherungsweise Version von createWordDistribution mit fester Speichergröße für sehr große Texte.
+	* Mehrere Ergebnisse können mit ApproximateCounter::merge zusammengeführt werden.
+	*
+	* @param	text: Der Text in dem alle Wörter gezählt werden sollen
+	*			options: Größe von Count-Min Sketch und topK Liste
+	*			useLowerCase (default = false): wenn useLowerCase gesetzt ist wird jedes Wort in lowercase convertiert
+	* @return	Gibt den ApproximateCounter mit Schätzungen und den häufigsten Worten zurück
+	*/
+	ApproximateCounter createApproximateWordDistribution(const std::string& text, const ApproximateOptions& options = ApproximateOptions(), bool useLowerCase = false);
+
+	/**
+	* Näherungsweise Version von findConnectedWords mit fester Speichergröße. Ein Paar wird als "erstes zweites"
+	* mit einem Leerzeichen dazwischen gezählt, splitPairKey macht daraus wieder ein strPair.
+	*
+	* @param	text: Der Text zum durchsuchen
+	*			options: Größe von Count-Min Sketch und topK Liste
+	*			range (default=2): Legt die reichweite fest in der Paarungen auftreten können
+	* @return	Gibt den ApproximateCounter mit Schätzungen und den häufigsten Paaren zurück
+	*/
+	ApproximateCounter findConnectedWordsApproximate(const std::string& text, const ApproximateOptions& options = ApproximateOptions(), int range = 2);
+
+	/**
+	* Zerlegt den Schlüssel eines Paares aus findConnectedWordsApproximate wieder in beide Worte
+	*/
+	strPair splitPairKey(std::string_view key);
+
+	/**
+	* Wandelt eine Verteilung mit Ids in eine mit strings um. Ids mit Häufigkeit 0 werden ausgelassen.
+	*/
+	wordDistribution toWordDistribution(const wordIdDistribution& distribution, const Vocabulary& vocabulary);
+
+	/**
+	* Wandelt Wortpaare mit Ids in Wortpaare mit strings um
+	*/
+	wordPairs toWordPairs(const wordIdPairs& pairs, const Vocabulary& vocabulary);
+
+	/**
+	* Statistische Daten über einen Text
+	*/
+	struct Stats
+	{
+		std::int64_t letters;
+		std::int64_t words;
+		std::int64_t sentense;
+		std::int64_t syllable;
+	};
+
+	/**
+	* Berechnet die durchschnittliche Wortlänge aus bereits vorhandenen Stats, z.B. von AnalyzedDocument
+	*/
+	double calculateWordLength(const Stats& stat);
+
+	/**
+	* Berechnet die durchschnittliche Wortanzahl pro Satz aus bereits vorhandenen Stats
+	*/
+	double calculateSentenceLengthByWords(const Stats& stat);
+
+	/**
+	* Berechnet die durchschnittliche Zeichenanzahl pro Satz aus bereits vorhandenen Stats
+	*/
+	double calculateSentenceLengthByLetters(const Stats& stat);
+
+	/**
+	* Enum zum auswählen welche Werte analyseText berechnen soll. Die Werte können mit | kombiniert werden.
+	*/
+	enum analysisMetric
+	{
+		metricStats = 1,
+		metricWordLength = 2,
+		metricWordDistribution = 4,
+		metricWordPairs = 8,
+		metricAll = 15
+	};
+
+	/**
+	* Einstellungen für analyseText. Die Standardwerte entsprechen denen der einzelnen Funktionen.
+	*/
+	struct AnalysisOptions
+	{
+		/// Zeichen die ein Wort beenden. Die Satzendezeichen sollten hier ebenfalls enthalten sein.
+		std::string wordEnd = defaultWordEnd;
+		/// Zeichen die einen Satz beenden
+		std::string sentenceEnd = defaultSentenceEnd;
+		/// wenn es gesetzt ist werden die Worte der Wortverteilung in lowercase convertiert. Wortpaare sind immer lowercase.
+		bool useLowerCase = false;
+		/// siehe findConnectedWords
+		int minOccurrences = 2;
+		/// siehe findConnectedWords
+		int range = 2;
+		/// wenn größer als 0 werden höchstens so viele unterschiedliche Wortpaare gezählt, siehe PairCounter::setMaxEntries
+		size_t maxPairEntries = 0;
+		/// Stoppwörter die in Wortverteilung und Wortpaaren nicht gezählt werden. Der Filter muss bis zum Ende der Analyse gültig bleiben.
+		const StopWordFilter* stopWords = nullptr;
+	};
+
+	/**
+	* Das Ergebnis von analyseText. Nicht angeforderte Werte bleiben leer.
+	*/
+	struct AnalysisResult
+	{
+		Stats stats{};
+		wordLengthDistibution wordLengths;
+		wordDistribution words;
+		wordPairs pairs;
+	};
+
+	/**
+	* Berechnet alle angeforderten Werte in einem einzigen Durchlauf über den Text.
+	* Die Funktionen wie countTotalWords, calculateWordLengthDistibution, createWordDistribution oder findConnectedWords nutzen diese Funktion intern.
+	*
+	* @param	text: Der Text der analysiert werden soll
+	*			metrics (default = metricAll): Kombination aus analysisMetric Werten die berechnet werden sollen
+	*			options: Trennzeichen und Einstellungen für Wortverteilung und Wortpaare
+	* @return	Gibt ein AnalysisResult mit allen angeforderten Werten zurück
+	*/
+	AnalysisResult analyseText(std::string_view text, int metrics = metricAll, const AnalysisOptions& options = AnalysisOptions());
+
+	/**
+	* Async version von analyseText. Der Text wird an Wort- bzw. Satzenden in einen Teil pro Thread zerlegt,
+	* die Teile werden im Thread Pool analysiert und die Ergebnisse zusammengeführt. Das Ergebnis ist identisch zu analyseText.
+	*/
+	AnalysisResult analyseTextAsync(std::string_view text, int metrics = metricAll, const AnalysisOptions& options = AnalysisOptions());
+
+	/**
+	* Analysiert einen Text der in beliebigen Teilen ankommt, z.B. beim lesen einer Datei die nicht in den Speicher passt.
+	* Wort-, Satz- und Silbenzustand sowie die letzten Worte für die Wortpaare werden zwischen den Teilen weitergeführt.
+	* Das Ergebnis ist identisch zu analyseText über den ganzen Text. Gespeichert wird nur das angefangene Wort am Ende
+	* eines Teils, der Speicher wächst also mit dem Wortschatz und nicht mit der Länge des Textes.
+	*/
+	class StreamAnalyser
+	{
+	public:
+		/**
+		* @param	metrics (default = metricAll): Kombination aus analysisMetric Werten die berechnet werden sollen
+		*			options: Trennzeichen und Einstellungen für Wortverteilung und Wortpaare, siehe analyseText
+		*/
+		explicit StreamAnalyser(int metrics = metricAll, const AnalysisOptions& options = AnalysisOptions());
+		~StreamAnalyser();
+
+		StreamAnalyser(StreamAnalyser&& other) noexcept;
+		StreamAnalyser& operator=(StreamAnalyser&& other) noexcept;
+
+		/**
+		* Analysiert den nächsten Teil des Textes. Der Teil darf mitten in einem Wort enden.
+		*
+		* @param	chunk: Der nächste Teil des Textes, wird nach dem Aufruf nicht mehr gebraucht
+		*/
+		void feed(std::string_view chunk);
+
+		/**
+		* Beendet den Text und gibt das Ergebnis zurück. Danach kann ein neuer Text mit feed begonnen werden.
+		*
+		* @return	Gibt ein AnalysisResult mit allen angeforderten Werten zurück
+		*/
+		AnalysisResult finish();
+
+		/**
+		* @return	Gibt die Anzahl der Zeichen zurück die seit dem letzten finish übergeben wurden
+		*/
+		std::uint64_t size() const;
+
+	private:
+		struct State;
+		std::unique_ptr<State> state;
+	};
+
+	/**
+	* Liest einen Stream in Blöcken und analysiert ihn mit dem StreamAnalyser
+	*
+	* @param	input: Der Stream, z.B. ein ifstream im binary Modus
+	*			metrics (default = metricAll): Kombination aus analysisMetric Werten die berechnet werden sollen
+	*			options: Trennzeichen und Einstellungen für Wortverteilung und Wortpaare
+	* @return	Gibt ein AnalysisResult mit allen angeforderten Werten zurück
+	*/
+	AnalysisResult analyseStream(std::istream& input, int metrics = metricAll, const AnalysisOptions& options = AnalysisOptions());
+
+	/**
+	* Legt fest wie viele Threads die Async Funktionen nutzen
+	*
+	* @param	count: Anzahl der Threads, bei 0 wird die Anzahl der CPU Kerne genutzt
+	*/
+	void setThreadCount(unsigned count);
+
+	/**
+	* @return	Gibt die Anzahl der Threads zurück die von den Async Funktionen genutzt werden
+	*/
+	unsigned getThreadCount();
+
+	/**
+	* Ein enum für die bessere Einteilung des Lesbarkeitswertes
 	*/
 	enum ReadabilityScore
 	{
-		VeryEasy,     // 90100: Suitable for an 11-year-old student
-		Easy,         // 8090
-		MediumEasy,   // 7080
-		Medium,       // 6070: Suitable for students aged 1315
-		MediumHard,   // 5060
-		Hard,         // 3050
-		VeryHard      // 030: Suitable for academics
+		VeryEasy,     // 90–100: Suitable for an 11-year-old student
+		Easy,         // 80–90
+		MediumEasy,   // 70–80
+		Medium,       // 60–70: Suitable for students aged 13–15
+		MediumHard,   // 50–60
+		Hard,         // 30–50
+		VeryHard      // 0–30: Suitable for academics
 	};
 	/**
 	 * Berechnet den Lesbarkeitswert eines Textes anhand des "Flesch - Reading - Ease - Score".
-	 * Die Berechnung bezieht sich auf deutsche wrter und Texte.
+	 * Die Berechnung bezieht sich auf deutsche wörter und Texte.
 	 *
 	 * @param	text: Der Text zum berechnen des Scores
-	 * @return	Gibt den Score als ReadabilityScore Enum zurck.
+	 * @return	Gibt den Score als ReadabilityScore Enum zurück.
 	 */
 	ReadabilityScore calculateGermanScore(const std::string& text);
 
+	/**
+	* Berechnet den Lesbarkeitswert aus bereits vorhandenen Stats
+	*/
+	ReadabilityScore calculateGermanScore(const Stats& stat);
+
 	/**
 	* Konvertiert das ReadabilityScore enum in einen String
 	* 
 	* @param	s: Das enum was dargestellt werden soll
-	* @return	Gibt den passenden String fr das ReadabilityScore Enum zurck.
+	* @return	Gibt den passenden String für das ReadabilityScore Enum zurück.
 	*/
 	inline std::string scoreToString(ReadabilityScore s)
 	{
@@ -259,9 +664,48 @@ namespace AnalyserLib
 	};
 
 	/**
-	* Rumt den Cache auf der inter bei dieser Bibliothek erstellt wird
+	* Räumt den Cache auf der inter bei dieser Bibliothek erstellt wird
 	*/
 	void clearCache();
+
+	/**
+	* Zähler des Stats Caches
+	*/
+	struct CacheCounters
+	{
+		std::uint64_t hits;
+		std::uint64_t misses;
+		/// Einträge die wegen der Kapazität entfernt wurden
+		std::uint64_t evictions;
+		/// aktuelle Anzahl an Einträgen
+		size_t size;
+	};
+
+	/**
+	* Legt fest wie viele Statistiken der Cache höchstens speichert (default 4096). Danach werden die am längsten
+	* nicht genutzten Einträge entfernt. 0 schaltet den Cache ab.
+	*/
+	void setCacheCapacity(size_t capacity);
+
+	/**
+	* @return	Gibt Treffer, Fehlschläge, entfernte Einträge und die Größe des Caches zurück
+	*/
+	CacheCounters getCacheCounters();
+
+	/**
+	* Gibt die Statistik eines Dokuments zurück. Der Cache nutzt nur die Id als Schlüssel, bei einem Treffer wird der
+	* Text also nicht gelesen. Die Id muss für einen geänderten Text neu vergeben oder mit forgetDocument entfernt werden.
+	*
+	* @param	documentId: Eine eindeutige Id für den Text
+	*			text: Der Text, wird nur analysiert wenn es keinen Eintrag gibt
+	* @return	Gibt die Stats mit den Standard Trennzeichen zurück
+	*/
+	Stats getDocumentStats(std::uint64_t documentId, const std::string& text);
+
+	/**
+	* Entfernt die gespeicherte Statistik eines Dokuments aus dem Cache
+	*/
+	void forgetDocument(std::uint64_t documentId);
 }
 
 #endif // !TEXTANALYSER
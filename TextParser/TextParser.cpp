@@ -1,7 +1,9 @@
 #include <iostream>
 #include <string>
 #include "TextAnalyser.h"
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <chrono>
 
 using namespace std;
@@ -73,6 +75,7 @@ void BenchMark()
     string originalText = readFile("Goethe--Faust.txt");
     BenchMarkRun(originalText, "splitTextIntoStringList(text)", [](string& str) {splitTextIntoStringList(str); });
     BenchMarkRun(originalText, "splitTextIntoStringList(text, true)", [](string& str) {splitTextIntoStringList(str, true); });
+    BenchMarkRun(originalText, "tokenize(text)", [](string& str) {size_t n = 0; for (const Token& t : tokenize(str)) n += t.value.size(); });
 
     BenchMarkRun(originalText, "countTotalWords(text)", [](string& str) {countTotalWords(str); });
 
@@ -82,7 +85,7 @@ void BenchMark()
     BenchMarkRun(originalText, "cleanUpText(text)", [](string& str) {cleanUpText(str); });
     BenchMarkRun(originalText, "cleanUpText(text,cleanupType::removeAllSigns)", [](string& str) {cleanUpText(str,cleanupType::removeAllSigns); });
 
-    BenchMarkRun(originalText, "findPatterns(text, \\b\\w{4}\\b)", [](string& str) {findPatterns(str, regex(R"(\b\w{6}\b)")); });
+    BenchMarkRun(originalText, "findPatterns(text, \\b\\w{6}\\b)", [](string& str) {findPatterns(str, R"(\b\w{6}\b)"); });
 
     BenchMarkRun(originalText, "calculateWordLength(text)", [](string& str) {calculateWordLength(str); });
     BenchMarkRun(originalText, "calculateSentenceLengthByWords(text)", [](string& str) {calculateSentenceLengthByWords(str); });
@@ -99,8 +102,10 @@ void BenchMark()
 
 int main()
 {
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
+#endif
     
     //DoBaseTest();
     //NimmaMehr("Rabe.txt");
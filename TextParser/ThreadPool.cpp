@@ -0,0 +1,167 @@
+#include "ThreadPool.h"
+#include "TextAnalyser.h"
+#include <atomic>
+#include <exception>
+using namespace std;
+
+namespace AnalyserLib
+{
+    // Siehe Header
+    ThreadPool::ThreadPool(unsigned workerCount)
+    {
+        for (unsigned i = 0; i < workerCount; ++i)
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    // Siehe Header
+    ThreadPool::~ThreadPool()
+    {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCondition.notify_all();
+        for (thread& t : workers)
+            t.join();
+    }
+
+    /**
+    * [intern]
+    * Holt Aufgaben aus der Warteschlange bis der Pool beendet wird
+    */
+    void ThreadPool::workerLoop()
+    {
+        for (;;)
+        {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(queueMutex);
+                queueCondition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    // Siehe Header
+    void ThreadPool::post(std::function<void()> task)
+    {
+        if (workers.empty())
+        {
+            task();
+            return;
+        }
+        {
+            lock_guard<mutex> lock(queueMutex);
+            tasks.push(move(task));
+        }
+        queueCondition.notify_one();
+    }
+
+    /**
+    * [intern]
+    * Der gemeinsame Zustand eines parallelFor Aufrufs. Jeder Thread holt sich den nächsten freien Index,
+    * Helfer die erst nach dem Ende starten finden keinen Index mehr und beenden sich sofort.
+    */
+    struct ParallelJob
+    {
+        atomic<size_t> next{ 0 };
+        atomic<size_t> done{ 0 };
+        size_t count = 0;
+        const function<void(size_t)>* f = nullptr;
+        mutex doneMutex;
+        condition_variable doneCondition;
+        exception_ptr error;
+
+        void run()
+        {
+            for (;;)
+            {
+                size_t i = next.fetch_add(1);
+                if (i >= count)
+                    return;
+
+                try
+                {
+                    (*f)(i);
+                }
+                catch (...)
+                {
+                    lock_guard<mutex> lock(doneMutex);
+                    if (!error)
+                        error = current_exception();
+                }
+
+                if (done.fetch_add(1) + 1 == count)
+                {
+                    lock_guard<mutex> lock(doneMutex);
+                    doneCondition.notify_all();
+                }
+            }
+        }
+    };
+
+    // Siehe Header
+    void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& f)
+    {
+        if (count == 0)
+            return;
+
+        auto job = make_shared<ParallelJob>();
+        job->count = count;
+        job->f = &f;
+
+        size_t helpers = min(count - 1, workers.size());
+        for (size_t i = 0; i < helpers; ++i)
+            post([job] { job->run(); });
+        job->run();
+
+        unique_lock<mutex> lock(job->doneMutex);
+        job->doneCondition.wait(lock, [&] { return job->done.load() == job->count; });
+        if (job->error)
+            rethrow_exception(job->error);
+    }
+
+    /// Der Pool für die Async Funktionen und die eingestellte Anzahl an Threads (0 = Anzahl der CPU Kerne)
+    static mutex sharedPoolMutex;
+    static shared_ptr<ThreadPool> sharedPool;
+    static unsigned configuredThreads = 0;
+
+    /**
+    * [intern]
+    * Die eingestellte Anzahl an Threads, sharedPoolMutex muss gesperrt sein
+    */
+    unsigned configuredThreadCount()
+    {
+        if (configuredThreads > 0)
+            return configuredThreads;
+        return max(1u, thread::hardware_concurrency());
+    }
+
+    // Siehe Header
+    unsigned getThreadCount()
+    {
+        lock_guard<mutex> lock(sharedPoolMutex);
+        return configuredThreadCount();
+    }
+
+    // Siehe Header
+    void setThreadCount(unsigned count)
+    {
+        lock_guard<mutex> lock(sharedPoolMutex);
+        configuredThreads = count;
+        sharedPool.reset();
+    }
+
+    // Siehe Header
+    std::shared_ptr<ThreadPool> getThreadPool()
+    {
+        lock_guard<mutex> lock(sharedPoolMutex);
+        if (!sharedPool)
+            sharedPool = make_shared<ThreadPool>(configuredThreadCount() - 1);
+        return sharedPool;
+    }
+}
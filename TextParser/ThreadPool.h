@@ -0,0 +1,71 @@
+/**
+* ThreadPool.h
+*
+* Ein Thread Pool für die Async Funktionen. Die Threads werden einmal erstellt und für alle Aufrufe wiederverwendet.
+* Die Anzahl der Threads wird mit setThreadCount aus TextAnalyser.h festgelegt.
+*/
+#pragma once
+#ifndef TEXTANALYSER_THREADPOOL
+#define TEXTANALYSER_THREADPOOL
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace AnalyserLib
+{
+	/**
+	* Ein Pool mit einer festen Anzahl an Worker Threads und einer gemeinsamen Warteschlange
+	*/
+	class ThreadPool
+	{
+	public:
+		/**
+		* @param	workerCount: Anzahl der Worker Threads. Bei 0 läuft alles im aufrufenden Thread.
+		*/
+		explicit ThreadPool(unsigned workerCount);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		* Fügt eine Aufgabe in die Warteschlange ein. Ohne Worker Threads wird sie sofort ausgeführt.
+		*/
+		void post(std::function<void()> task);
+
+		/**
+		* Führt f(0) bis f(count - 1) parallel aus und wartet bis alle fertig sind.
+		* Der aufrufende Thread arbeitet mit, dadurch kann parallelFor auch aus einer Aufgabe im Pool aufgerufen werden.
+		* Eine Exception aus f wird nach dem Ende aller Aufrufe im aufrufenden Thread weitergeworfen.
+		*
+		* @param	count: Anzahl der Aufrufe
+		*			f: Die Funktion die mit dem Index aufgerufen wird
+		*/
+		void parallelFor(size_t count, const std::function<void(size_t)>& f);
+
+		/// Anzahl der Threads inklusive dem aufrufenden Thread
+		unsigned concurrency() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> workers;
+		std::queue<std::function<void()>> tasks;
+		std::mutex queueMutex;
+		std::condition_variable queueCondition;
+		bool stopping = false;
+	};
+
+	/**
+	* Gibt den Pool zurück den die Async Funktionen nutzen. Er wird beim ersten Aufruf
+	* und nach jedem setThreadCount neu erstellt, laufende Aufrufe behalten ihren alten Pool.
+	*/
+	std::shared_ptr<ThreadPool> getThreadPool();
+}
+
+#endif // !TEXTANALYSER_THREADPOOL
@@ -0,0 +1,232 @@
+#include "TokenTable.h"
+#include "Metrics.h"
+#include "StopWordFilter.h"
+#include "Utf8.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    // Siehe Header
+    TokenTable::TokenTable(const AnalysisOptions& options)
+        : analysisOptions(options), table(makeCharTable(options.wordEnd, options.sentenceEnd))
+    {
+    }
+
+    // Siehe Header
+    TokenTable::TokenTable(std::string_view text, const AnalysisOptions& options)
+        : TokenTable(options)
+    {
+        build(text);
+    }
+
+    // Siehe Header
+    void TokenTable::clear()
+    {
+        arena.clear();
+        offsets.clear();
+        lengths.clear();
+        positions.clear();
+        sentences.clear();
+        ids.clear();
+        letterCounts.clear();
+        words.clear();
+    }
+
+    // Siehe Header
+    void TokenTable::build(std::string_view text)
+    {
+        ANALYSER_STAGE_TIMER(stageTokenize);
+        clear();
+        // grobe Schätzung, im Deutschen hat ein Wort mit Trennzeichen etwa 6 bis 7 Zeichen
+        size_t expected = text.size() / 6;
+        arena.reserve(text.size());
+        offsets.reserve(expected);
+        lengths.reserve(expected);
+        positions.reserve(expected);
+        sentences.reserve(expected);
+        ids.reserve(expected);
+        letterCounts.reserve(expected);
+
+        string lower;
+        uint32_t sentence = 0;
+        size_t lastEnd = 0;
+        for (const Token& t : tokenize(text, analysisOptions.wordEnd))
+        {
+            // zwischen dem letzten und diesem Wort liegt ein Satzende
+            if (!offsets.empty())
+            {
+                for (size_t i = lastEnd; i < t.position; ++i)
+                {
+                    if (table[text[i]] & charSentenceEnd)
+                    {
+                        sentence++;
+                        break;
+                    }
+                }
+            }
+            lastEnd = t.position + t.value.size();
+
+            uint32_t letterCount = 0;
+            for (char c : t.value)
+                letterCount += (table[c] & charLetter) ? 1 : 0;
+
+            string_view word = t.value;
+            if (analysisOptions.useLowerCase)
+            {
+                toLowerUtf8(word, lower);
+                word = lower;
+            }
+
+            offsets.push_back(arena.size());
+            lengths.push_back(static_cast<uint32_t>(word.size()));
+            positions.push_back(t.position);
+            sentences.push_back(sentence);
+            ids.push_back(words.intern(word));
+            letterCounts.push_back(letterCount);
+            arena.append(word);
+        }
+        ANALYSER_STAGE_ADD(stageTokenize, fieldBytesIn, text.size());
+        ANALYSER_STAGE_ADD(stageTokenize, fieldTokens, offsets.size());
+        ANALYSER_STAGE_ADD(stageTokenize, fieldSentences, sentenceCount());
+    }
+
+    // Siehe Header
+    wordIdDistribution TokenTable::wordIdCounts() const
+    {
+        wordIdDistribution counts(words.size(), 0);
+        for (wordId id : ids)
+            counts[id]++;
+        return counts;
+    }
+
+    // Siehe Header
+    wordDistribution TokenTable::wordCounts() const
+    {
+        wordIdDistribution counts = wordIdCounts();
+        wordDistribution result;
+        result.reserve(counts.size());
+        for (wordId id = 0; id < counts.size(); ++id)
+        {
+            string_view word = words.word(id);
+            if (!analysisOptions.stopWords || !analysisOptions.stopWords->contains(word))
+                result.emplace(string(word), counts[id]);
+        }
+        return result;
+    }
+
+    // Siehe Header
+    wordLengthDistibution TokenTable::wordLengths() const
+    {
+        // erst in einem flachen Array zählen, die map bekommt nur einen Eintrag pro Länge
+        vector<int> counts;
+        for (uint32_t letters : letterCounts)
+        {
+            if (letters >= counts.size())
+                counts.resize(letters + 1, 0);
+            counts[letters]++;
+        }
+
+        wordLengthDistibution result;
+        for (size_t letters = 0; letters < counts.size(); ++letters)
+        {
+            if (counts[letters] > 0)
+                result.emplace(static_cast<int>(letters), counts[letters]);
+        }
+        return result;
+    }
+
+    // Siehe Header
+    wordPairs TokenTable::pairs() const
+    {
+        int range = analysisOptions.range;
+        if (range < 2 || analysisOptions.minOccurrences < 1 || empty())
+            return wordPairs();
+
+        // jedes unterschiedliche Wort wird nur einmal in lowercase umgewandelt, Stoppwörter bekommen invalidWordId
+        Vocabulary pairWords;
+        vector<wordId> pairIds(words.size());
+        string lower;
+        for (wordId id = 0; id < words.size(); ++id)
+        {
+            toLowerUtf8(words.word(id), lower);
+            bool isStopWord = analysisOptions.stopWords && analysisOptions.stopWords->contains(lower);
+            pairIds[id] = isStopWord ? invalidWordId : pairWords.intern(lower);
+        }
+
+        // wie das Fenster bei analyseText, nur über die Spalten statt über den Text
+        wordIdPairs counter;
+        counter.setMaxEntries(analysisOptions.maxPairEntries);
+        vector<wordId> window(static_cast<size_t>(range - 1));
+        size_t windowPos = 0;
+        uint32_t currentSentence = sentences[0];
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (sentences[i] != currentSentence)
+            {
+                currentSentence = sentences[i];
+                windowPos = 0;
+            }
+
+            wordId id = pairIds[ids[i]];
+            if (id == invalidWordId)
+                continue;
+
+            size_t count = min(windowPos, window.size());
+            for (size_t d = count; d > 0; --d)
+                counter.add(window[(windowPos - d) % window.size()], id);
+            window[windowPos % window.size()] = id;
+            windowPos++;
+        }
+
+        if (analysisOptions.minOccurrences > 1)
+            counter.prune(analysisOptions.minOccurrences);
+
+        wordPairs result;
+        result.reserve(counter.size());
+        counter.forEach([&](wordIdPair pair, int count)
+            {
+                result.emplace(strPair(pairWords.word(pair.first), pairWords.word(pair.second)), count);
+            });
+        return result;
+    }
+
+    /**
+    * [intern]
+    * Die wordId eines Suchbegriffs, umgewandelt wie die Worte der Tabelle
+    */
+    wordId TokenTable::lookup(std::string_view word) const
+    {
+        if (!analysisOptions.useLowerCase)
+            return words.find(word);
+        string lower;
+        toLowerUtf8(word, lower);
+        return words.find(lower);
+    }
+
+    // Siehe Header
+    std::vector<size_t> TokenTable::find(std::string_view word) const
+    {
+        vector<size_t> hits;
+        wordId wanted = lookup(word);
+        if (wanted == invalidWordId)
+            return hits;
+
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (ids[i] == wanted)
+                hits.push_back(i);
+        }
+        return hits;
+    }
+
+    // Siehe Header
+    size_t TokenTable::count(std::string_view word) const
+    {
+        wordId wanted = lookup(word);
+        if (wanted == invalidWordId)
+            return 0;
+        return static_cast<size_t>(std::count(ids.begin(), ids.end(), wanted));
+    }
+}
@@ -0,0 +1,122 @@
+/**
+* TokenTable.h
+*
+* Alle Worte eines Dokuments einmal zerlegt und normalisiert, als Spalten abgelegt. Die Bytes der Worte liegen
+* hintereinander in einem Speicherblock, daneben je ein vector für Offset, Länge, Position im Text, Satz und wordId.
+* Wortverteilung, Wortlängen, Wortpaare und die Suche laufen danach nur noch linear über die Spalten.
+*/
+#pragma once
+#ifndef TEXTANALYSER_TOKENTABLE
+#define TEXTANALYSER_TOKENTABLE
+
+#include "TextAnalyser.h"
+#include <cstdint>
+#include <string_view>
+
+namespace AnalyserLib
+{
+	/**
+	* Spaltentabelle der Worte eines Textes. Mit useLowerCase aus den AnalysisOptions werden die Worte wie bei
+	* createWordDistribution umgewandelt, sonst wie im Text übernommen. Jedes unterschiedliche Wort bekommt eine wordId
+	* im eigenen Vocabulary. Der Text wird nach build nicht mehr gebraucht.
+	*
+	* Statt einem string pro Wort gibt es nur wenige große Blöcke, die bei einem neuen build wiederverwendet werden.
+	* Nach build kann die Tabelle von mehreren Threads gelesen werden.
+	*/
+	class TokenTable
+	{
+	public:
+		/**
+		* @param	options: wordEnd, sentenceEnd und useLowerCase für build, der Rest für die Auswertungen
+		*/
+		explicit TokenTable(const AnalysisOptions& options = AnalysisOptions());
+
+		/**
+		* Erstellt die Tabelle direkt für text
+		*/
+		TokenTable(std::string_view text, const AnalysisOptions& options = AnalysisOptions());
+
+		/**
+		* Zerlegt den Text wie tokenize und ersetzt den bisherigen Inhalt. Der Speicher der Spalten bleibt erhalten.
+		*/
+		void build(std::string_view text);
+
+		void clear();
+
+		/// Anzahl der Worte
+		size_t size() const { return offsets.size(); }
+		bool empty() const { return offsets.empty(); }
+
+		/// Das normalisierte Wort, gültig bis zum nächsten build oder clear
+		std::string_view token(size_t i) const { return std::string_view(arena.data() + offsets[i], lengths[i]); }
+
+		/// Position des Wortes im ursprünglichen Text
+		std::uint64_t position(size_t i) const { return positions[i]; }
+
+		/// Nummer des Satzes, ein neuer Satz beginnt wenn zwischen zwei Worten ein Satzende steht (wie bei den Wortpaaren)
+		std::uint32_t sentence(size_t i) const { return sentences[i]; }
+
+		/// Die Id des normalisierten Wortes in vocabulary()
+		wordId id(size_t i) const { return ids[i]; }
+
+		/// Anzahl der Buchstaben im ursprünglichen Wort, wie bei calculateWordLengthDistibution
+		std::uint32_t letters(size_t i) const { return letterCounts[i]; }
+
+		/// Anzahl der Sätze mit mindestens einem Wort
+		std::uint32_t sentenceCount() const { return empty() ? 0 : sentences.back() + 1; }
+
+		const Vocabulary& vocabulary() const { return words; }
+		const AnalysisOptions& options() const { return analysisOptions; }
+
+		/**
+		* Wie createWordDistribution bzw. analyseText mit metricWordDistribution, Stoppwörter aus den options werden nicht gezählt
+		*/
+		wordDistribution wordCounts() const;
+
+		/**
+		* @return	Gibt die Häufigkeit jeder wordId zurück, ohne Stoppwörter zu filtern
+		*/
+		wordIdDistribution wordIdCounts() const;
+
+		/**
+		* Wie calculateWordLengthDistibution
+		*/
+		wordLengthDistibution wordLengths() const;
+
+		/**
+		* Wie findConnectedWords mit minOccurrences, range, maxPairEntries und stopWords aus den options.
+		* Die Paare sind auch ohne useLowerCase immer lowercase.
+		*/
+		wordPairs pairs() const;
+
+		/**
+		* Sucht ein Wort, es wird dafür genauso umgewandelt wie die Worte der Tabelle
+		*
+		* @return	Gibt die Nummern aller Vorkommen in der Tabelle zurück, aufsteigend
+		*/
+		std::vector<size_t> find(std::string_view word) const;
+
+		/**
+		* @return	Gibt zurück wie oft das Wort vorkommt
+		*/
+		size_t count(std::string_view word) const;
+
+	private:
+		wordId lookup(std::string_view word) const;
+
+		AnalysisOptions analysisOptions;
+		CharTable table;
+
+		/// die Bytes aller Worte hintereinander
+		std::string arena;
+		std::vector<size_t> offsets;
+		std::vector<std::uint32_t> lengths;
+		std::vector<std::uint64_t> positions;
+		std::vector<std::uint32_t> sentences;
+		std::vector<wordId> ids;
+		std::vector<std::uint32_t> letterCounts;
+		Vocabulary words;
+	};
+}
+
+#endif // !TEXTANALYSER_TOKENTABLE
@@ -0,0 +1,300 @@
+#include "Utf8.h"
+#include "SimdKernels.h"
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /// [intern] Die Tabelle deckt U+0000 bis U+024F und U+1E00 bis U+1EFF ab
+    constexpr char32_t latinEnd = 0x250;
+    constexpr char32_t extendedFirst = 0x1E00;
+    constexpr char32_t extendedEnd = 0x1F00;
+    constexpr size_t unicodeTableSize = latinEnd + (extendedEnd - extendedFirst);
+
+    /**
+    * [intern]
+    * Bereiche von Buchstaben (Unicode Kategorie L) in der Tabelle
+    */
+    struct LetterRange
+    {
+        char32_t first;
+        char32_t last;
+    };
+
+    static constexpr LetterRange letterRanges[] = {
+        { 0x0041, 0x005A }, { 0x0061, 0x007A }, { 0x00AA, 0x00AA }, { 0x00B5, 0x00B5 }, { 0x00BA, 0x00BA },
+        { 0x00C0, 0x00D6 }, { 0x00D8, 0x00F6 }, { 0x00F8, 0x024F }, { 0x1E00, 0x1EFF }
+    };
+
+    /**
+    * [intern]
+    * Großbuchstaben von first bis last in Schritten von step, der Kleinbuchstabe ist der Code Point plus delta
+    */
+    struct CaseRange
+    {
+        char32_t first;
+        char32_t last;
+        int delta;
+        int step;
+    };
+
+    static constexpr CaseRange caseRanges[] = {
+        { 0x0041, 0x005A, 32, 1 }, { 0x00C0, 0x00D6, 32, 1 }, { 0x00D8, 0x00DE, 32, 1 }, { 0x0100, 0x012E, 1, 2 },
+        { 0x0130, 0x0130, -199, 1 }, { 0x0132, 0x0136, 1, 2 }, { 0x0139, 0x0147, 1, 2 }, { 0x014A, 0x0176, 1, 2 },
+        { 0x0178, 0x0178, -121, 1 }, { 0x0179, 0x017D, 1, 2 }, { 0x0181, 0x0181, 210, 1 }, { 0x0182, 0x0184, 1, 2 },
+        { 0x0186, 0x0186, 206, 1 }, { 0x0187, 0x0187, 1, 1 }, { 0x0189, 0x018A, 205, 1 }, { 0x018B, 0x018B, 1, 1 },
+        { 0x018E, 0x018E, 79, 1 }, { 0x018F, 0x018F, 202, 1 }, { 0x0190, 0x0190, 203, 1 }, { 0x0191, 0x0191, 1, 1 },
+        { 0x0193, 0x0193, 205, 1 }, { 0x0194, 0x0194, 207, 1 }, { 0x0196, 0x0196, 211, 1 }, { 0x0197, 0x0197, 209, 1 },
+        { 0x0198, 0x0198, 1, 1 }, { 0x019C, 0x019C, 211, 1 }, { 0x019D, 0x019D, 213, 1 }, { 0x019F, 0x019F, 214, 1 },
+        { 0x01A0, 0x01A4, 1, 2 }, { 0x01A6, 0x01A6, 218, 1 }, { 0x01A7, 0x01A7, 1, 1 }, { 0x01A9, 0x01A9, 218, 1 },
+        { 0x01AC, 0x01AC, 1, 1 }, { 0x01AE, 0x01AE, 218, 1 }, { 0x01AF, 0x01AF, 1, 1 }, { 0x01B1, 0x01B2, 217, 1 },
+        { 0x01B3, 0x01B5, 1, 2 }, { 0x01B7, 0x01B7, 219, 1 }, { 0x01B8, 0x01B8, 1, 1 }, { 0x01BC, 0x01BC, 1, 1 },
+        { 0x01C4, 0x01C4, 2, 1 }, { 0x01C5, 0x01C5, 1, 1 }, { 0x01C7, 0x01C7, 2, 1 }, { 0x01C8, 0x01C8, 1, 1 },
+        { 0x01CA, 0x01CA, 2, 1 }, { 0x01CB, 0x01DB, 1, 2 }, { 0x01DE, 0x01EE, 1, 2 }, { 0x01F1, 0x01F1, 2, 1 },
+        { 0x01F2, 0x01F4, 1, 2 }, { 0x01F6, 0x01F6, -97, 1 }, { 0x01F7, 0x01F7, -56, 1 }, { 0x01F8, 0x021E, 1, 2 },
+        { 0x0220, 0x0220, -130, 1 }, { 0x0222, 0x0232, 1, 2 }, { 0x023A, 0x023A, 10795, 1 }, { 0x023B, 0x023B, 1, 1 },
+        { 0x023D, 0x023D, -163, 1 }, { 0x023E, 0x023E, 10792, 1 }, { 0x0241, 0x0241, 1, 1 }, { 0x0243, 0x0243, -195, 1 },
+        { 0x0244, 0x0244, 69, 1 }, { 0x0245, 0x0245, 71, 1 }, { 0x0246, 0x024E, 1, 2 }, { 0x1E00, 0x1E94, 1, 2 },
+        { 0x1E9E, 0x1E9E, -7615, 1 }, { 0x1EA0, 0x1EFE, 1, 2 }
+    };
+
+    /**
+    * [intern]
+    * Die flache Tabelle, wird zur Compilezeit aus den Bereichen erstellt
+    */
+    struct UnicodeTable
+    {
+        bool letter[unicodeTableSize] = {};
+        int16_t lowerDelta[unicodeTableSize] = {};
+    };
+
+    constexpr size_t noTableIndex = SIZE_MAX;
+
+    constexpr size_t tableIndex(char32_t codePoint)
+    {
+        if (codePoint < latinEnd)
+            return codePoint;
+        if (codePoint >= extendedFirst && codePoint < extendedEnd)
+            return codePoint - extendedFirst + latinEnd;
+        return noTableIndex;
+    }
+
+    constexpr UnicodeTable makeUnicodeTable()
+    {
+        UnicodeTable table{};
+        for (const LetterRange& r : letterRanges)
+        {
+            for (char32_t c = r.first; c <= r.last; ++c)
+                table.letter[tableIndex(c)] = true;
+        }
+        for (const CaseRange& r : caseRanges)
+        {
+            for (char32_t c = r.first; c <= r.last; c += r.step)
+                table.lowerDelta[tableIndex(c)] = static_cast<int16_t>(r.delta);
+        }
+        return table;
+    }
+
+    static constexpr UnicodeTable unicodeTable = makeUnicodeTable();
+
+    // Siehe Header
+    char32_t decodeUtf8(std::string_view text, size_t& pos)
+    {
+        auto byteAt = [&](size_t i) { return static_cast<unsigned char>(text[i]); };
+        auto isContinuation = [&](size_t i) { return i < text.size() && (byteAt(i) & 0xC0) == 0x80; };
+
+        unsigned char lead = byteAt(pos);
+        if (lead >= 0xC2 && lead <= 0xDF && isContinuation(pos + 1))
+        {
+            char32_t c = (char32_t(lead & 0x1F) << 6) | (byteAt(pos + 1) & 0x3F);
+            pos += 2;
+            return c;
+        }
+        if (lead >= 0xE0 && lead <= 0xEF && isContinuation(pos + 1) && isContinuation(pos + 2))
+        {
+            char32_t c = (char32_t(lead & 0x0F) << 12) | (char32_t(byteAt(pos + 1) & 0x3F) << 6) | (byteAt(pos + 2) & 0x3F);
+            // zu lange Kodierungen und Surrogates sind kein gültiges UTF-8
+            if (c >= 0x800 && (c < 0xD800 || c > 0xDFFF))
+            {
+                pos += 3;
+                return c;
+            }
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4 && isContinuation(pos + 1) && isContinuation(pos + 2) && isContinuation(pos + 3))
+        {
+            char32_t c = (char32_t(lead & 0x07) << 18) | (char32_t(byteAt(pos + 1) & 0x3F) << 12)
+                | (char32_t(byteAt(pos + 2) & 0x3F) << 6) | (byteAt(pos + 3) & 0x3F);
+            if (c >= 0x10000 && c <= 0x10FFFF)
+            {
+                pos += 4;
+                return c;
+            }
+        }
+
+        // ASCII oder ein Latin-1 Byte
+        ++pos;
+        return lead;
+    }
+
+    // Siehe Header
+    void appendUtf8(std::string& out, char32_t codePoint)
+    {
+        if (codePoint < 0x80)
+            out.push_back(static_cast<char>(codePoint));
+        else if (codePoint < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    // Siehe Header
+    bool isAscii(std::string_view text)
+    {
+        constexpr uint64_t highBits = 0x8080808080808080ULL;
+        const char* data = text.data();
+        size_t i = 0;
+
+        // 32 Byte pro Durchlauf, das Oder der vier Worte wird nur einmal geprüft
+        for (; i + 32 <= text.size(); i += 32)
+        {
+            uint64_t w[4];
+            memcpy(w, data + i, sizeof(w));
+            if ((w[0] | w[1] | w[2] | w[3]) & highBits)
+                return false;
+        }
+        for (; i + 8 <= text.size(); i += 8)
+        {
+            uint64_t w;
+            memcpy(&w, data + i, sizeof(w));
+            if (w & highBits)
+                return false;
+        }
+        for (; i < text.size(); ++i)
+        {
+            if (data[i] & 0x80)
+                return false;
+        }
+        return true;
+    }
+
+    // Siehe Header
+    bool isLetter(char32_t codePoint)
+    {
+        size_t i = tableIndex(codePoint);
+        return i != noTableIndex && unicodeTable.letter[i];
+    }
+
+    // Siehe Header
+    char32_t toLower(char32_t codePoint)
+    {
+        size_t i = tableIndex(codePoint);
+        return i == noTableIndex ? codePoint : static_cast<char32_t>(codePoint + unicodeTable.lowerDelta[i]);
+    }
+
+    // Siehe Header
+    void toLowerUtf8(std::string_view word, std::string& out)
+    {
+        out.clear();
+        if (isAscii(word))
+        {
+            out.assign(word);
+            for (char& c : out)
+            {
+                if (c >= 'A' && c <= 'Z')
+                    c += 'a' - 'A';
+            }
+            return;
+        }
+
+        out.reserve(word.size());
+        for (size_t i = 0; i < word.size();)
+        {
+            unsigned char c = static_cast<unsigned char>(word[i]);
+            if (c < 0x80)
+            {
+                out.push_back(static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c));
+                ++i;
+                continue;
+            }
+
+            size_t start = i;
+            char32_t lower = toLower(decodeUtf8(word, i));
+            // ein einzelnes Latin-1 Byte bleibt ein Latin-1 Byte, alle Latin-1 Großbuchstaben haben ihren Kleinbuchstaben in Latin-1
+            if (i - start == 1)
+                out.push_back(static_cast<char>(lower <= 0xFF ? lower : c));
+            else
+                appendUtf8(out, lower);
+        }
+    }
+
+    // Siehe Header
+    Utf8TokenRange::iterator& Utf8TokenRange::iterator::operator++()
+    {
+        string_view text = range->text;
+        const CharTable& table = range->table;
+        size_t i = next;
+
+        if (range->ascii && range->useDefaultTable)
+        {
+            if (i < text.size() && !(defaultCharTable[text[i]] & charLetter))
+                i = findLetterSimd(text, i + 1);
+        }
+        else
+        {
+            while (i < text.size())
+            {
+                unsigned char c = static_cast<unsigned char>(text[i]);
+                if (c < 0x80)
+                {
+                    if (table.flags[c] & charLetter)
+                        break;
+                    ++i;
+                    continue;
+                }
+
+                size_t after = i;
+                if (isLetter(decodeUtf8(text, after)))
+                    break;
+                i = after;
+            }
+        }
+
+        if (i >= text.size())
+        {
+            next = text.size();
+            current = { {}, string_view::npos };
+            return *this;
+        }
+
+        // Wortenden sind nur ASCII Zeichen, in einer UTF-8 Folge sind alle Bytes ab 0x80
+        size_t startIdx = i;
+        if (range->useDefaultTable)
+            i = findWordEndSimd(text, i + 1);
+        else
+        {
+            ++i;
+            while (i < text.size() && (static_cast<unsigned char>(text[i]) >= 0x80 || (table[text[i]] & (charLetter | charWordEnd)) != charWordEnd))
+                ++i;
+        }
+
+        current = { text.substr(startIdx, i - startIdx), startIdx };
+        next = i;
+        return *this;
+    }
+}
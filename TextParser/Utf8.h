@@ -0,0 +1,150 @@
+/**
+* Utf8.h
+*
+* Zerlegen und Umwandeln von UTF-8 Text nach Code Points. Buchstaben und Kleinbuchstaben kommen aus einer kleinen Tabelle
+* für die lateinischen Schriften (U+0000 bis U+024F und U+1E00 bis U+1EFF), ohne locale.
+* Ungültige UTF-8 Bytes werden als Latin-1 gelesen, so funktionieren auch ältere Latin-1 Texte weiter.
+*/
+#pragma once
+#ifndef TEXTANALYSER_UTF8
+#define TEXTANALYSER_UTF8
+
+#include "TextAnalyser.h"
+#include <string>
+#include <string_view>
+
+namespace AnalyserLib
+{
+	/**
+	* Liest einen Code Point ab pos. Ist an pos keine gültige UTF-8 Folge, wird das Byte als Latin-1 Zeichen gelesen.
+	*
+	* @param	text: Der Text
+	*			pos: Die Position des ersten Bytes, steht danach hinter dem Zeichen
+	* @return	Gibt den Code Point zurück
+	*/
+	char32_t decodeUtf8(std::string_view text, size_t& pos);
+
+	/**
+	* Hängt einen Code Point als UTF-8 an out an
+	*/
+	void appendUtf8(std::string& out, char32_t codePoint);
+
+	/**
+	* Prüft 8 Byte auf einmal ob der Text nur ASCII Zeichen enthält
+	*/
+	bool isAscii(std::string_view text);
+
+	/**
+	* @return	Gibt true zurück wenn der Code Point ein Buchstabe ist. Außerhalb der Tabelle immer false.
+	*/
+	bool isLetter(char32_t codePoint);
+
+	/**
+	* @return	Gibt den Kleinbuchstaben zurück, außerhalb der Tabelle und für Kleinbuchstaben den Code Point selbst
+	*/
+	char32_t toLower(char32_t codePoint);
+
+	/**
+	* Schreibt das Wort in Kleinbuchstaben nach out. out wird vorher geleert und kann für jedes Wort wiederverwendet werden,
+	* dann wird nach den ersten Worten kein Speicher mehr angelegt. Reine ASCII Worte werden ohne Dekodieren umgewandelt.
+	* Gültige UTF-8 Folgen bleiben UTF-8, einzelne Latin-1 Bytes bleiben Latin-1 (Ä wird zu ä in der jeweiligen Kodierung).
+	*
+	* @param	word: Das Wort
+	*			out: Der Puffer für das Ergebnis
+	*/
+	void toLowerUtf8(std::string_view word, std::string& out);
+
+	/**
+	* Ruft f(char) für jedes Byte des Wortes in Kleinbuchstaben auf, ohne das Wort zu kopieren. Anders als bei toLowerUtf8
+	* wird ein einzelnes Latin-1 Byte dabei als UTF-8 ausgegeben, so ergeben Ü in Latin-1 und Ü in UTF-8 die gleichen Bytes.
+	* Für Vergleiche ohne Groß- und Kleinschreibung, z.B. im StopWordFilter und in der KeywordSearch.
+	*
+	* @param	word: Das Wort
+	*			f: Bekommt die Bytes der Reihe nach
+	*/
+	template<class F>
+	void forEachFoldedByte(std::string_view word, F&& f)
+	{
+		for (size_t pos = 0; pos < word.size();)
+		{
+			char c = word[pos];
+			if (static_cast<unsigned char>(c) < 0x80)
+			{
+				f((c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c);
+				++pos;
+				continue;
+			}
+
+			// höchstens 4 Byte, bleibt im Puffer des strings
+			std::string lower;
+			appendUtf8(lower, toLower(decodeUtf8(word, pos)));
+			for (char b : lower)
+				f(b);
+		}
+	}
+
+	/**
+	* Wie tokenize, aber ein Wort beginnt mit einem Buchstaben nach Code Points, z.B. auch mit É oder den polnischen und vietnamesischen Buchstaben.
+	* Ein Wort endet wie bei tokenize an einem ASCII Zeichen aus endingPattern. Ist der ganze Text ASCII,
+	* werden die gleichen SIMD Kernels wie bei tokenize genutzt.
+	*
+	* Beispiel:	for (Token t : tokenizeUtf8(text)) { ... }
+	*/
+	class Utf8TokenRange
+	{
+	public:
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Token;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const Token*;
+			using reference = const Token&;
+
+			iterator() = default;
+			iterator(const Utf8TokenRange* range, size_t position) : range(range), next(position) { ++(*this); }
+
+			reference operator*() const { return current; }
+			pointer operator->() const { return &current; }
+			iterator& operator++();
+			iterator operator++(int) { iterator tmp = *this; ++(*this); return tmp; }
+			bool operator==(const iterator& o) const { return current.position == o.current.position; }
+			bool operator!=(const iterator& o) const { return !(*this == o); }
+
+		private:
+			const Utf8TokenRange* range = nullptr;
+			size_t next = 0;
+			Token current{ {}, std::string_view::npos };
+		};
+
+		Utf8TokenRange(std::string_view text, std::string_view endingPattern = defaultWordEnd)
+			: text(text), ascii(isAscii(text)), useDefaultTable(endingPattern == defaultWordEnd),
+			table(useDefaultTable ? defaultCharTable : makeCharTable(endingPattern))
+		{
+		}
+
+		iterator begin() const { return iterator(this, 0); }
+		iterator end() const { return iterator(); }
+
+	private:
+		std::string_view text;
+		bool ascii;
+		bool useDefaultTable;
+		CharTable table;
+	};
+
+	/**
+	* Erzeugt eine Utf8TokenRange über den Text. Der Text muss so lange existieren wie die Utf8TokenRange genutzt wird.
+	*
+	* @param	text: der Text der unterteilt werden soll
+	*			endingPattern (defult = defaultWordEnd " .,-!?\n"): Jedes Zeichen in dem string beendet ein Wort.
+	* @return	Gibt eine Utf8TokenRange zurück über die man mit einer for Schleife iterieren kann
+	*/
+	inline Utf8TokenRange tokenizeUtf8(std::string_view text, std::string_view endingPattern = defaultWordEnd)
+	{
+		return Utf8TokenRange(text, endingPattern);
+	}
+}
+
+#endif // !TEXTANALYSER_UTF8
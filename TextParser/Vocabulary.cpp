@@ -0,0 +1,70 @@
+#include "Vocabulary.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace AnalyserLib
+{
+    /// [intern] Größe der Blöcke in denen die Worte gespeichert werden
+    static const size_t vocabularyBlockSize = 1 << 16;
+
+    // Siehe Header
+    wordId Vocabulary::intern(std::string_view word)
+    {
+        auto it = ids.find(word);
+        if (it != ids.end())
+            return it->second;
+
+        wordId id = static_cast<wordId>(words.size());
+        string_view stored = store(word);
+        words.push_back(stored);
+#ifdef ANALYSER_METRICS
+        size_t buckets = ids.bucket_count();
+        ids.emplace(stored, id);
+        ANALYSER_COUNTER_ADD(counterHashResizes, ids.bucket_count() != buckets ? 1 : 0);
+#else
+        ids.emplace(stored, id);
+#endif
+        return id;
+    }
+
+    // Siehe Header
+    wordId Vocabulary::find(std::string_view word) const
+    {
+        auto it = ids.find(word);
+        return it == ids.end() ? invalidWordId : it->second;
+    }
+
+    // Siehe Header
+    void Vocabulary::clear()
+    {
+        ids.clear();
+        words.clear();
+        blocks.clear();
+        blockFree = 0;
+        blockPos = nullptr;
+    }
+
+    /**
+    * [intern]
+    * Kopiert das Wort in den aktuellen Block. Ist er voll wird ein neuer angelegt, sehr lange Worte bekommen einen eigenen.
+    */
+    string_view Vocabulary::store(string_view word)
+    {
+        if (word.size() > blockFree)
+        {
+            size_t size = max(vocabularyBlockSize, word.size());
+            blocks.push_back(make_unique<char[]>(size));
+            blockPos = blocks.back().get();
+            blockFree = size;
+        }
+
+        memcpy(blockPos, word.data(), word.size());
+        string_view stored(blockPos, word.size());
+        blockPos += word.size();
+        blockFree -= word.size();
+        return stored;
+    }
+}
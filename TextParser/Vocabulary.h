@@ -0,0 +1,72 @@
+/**
+* Vocabulary.h
+*
+* Ein Wortschatz der jedem unterschiedlichen Wort eine fortlaufende Id gibt. Jedes Wort wird nur einmal gespeichert,
+* Wortverteilung und Wortpaare können dann mit den Ids statt mit den strings gezählt werden.
+*/
+#pragma once
+#ifndef TEXTANALYSER_VOCABULARY
+#define TEXTANALYSER_VOCABULARY
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace AnalyserLib
+{
+	/// die Id eines Wortes im Vocabulary
+	using wordId = std::uint32_t;
+	/// wird von Vocabulary::find zurückgegeben wenn das Wort unbekannt ist
+	inline constexpr wordId invalidWordId = 0xFFFFFFFFu;
+
+	/// ein Wortpaar aus zwei Ids
+	using wordIdPair = std::pair<wordId, wordId>;
+
+	/// Häufigkeit jedes Wortes, der Index ist die wordId
+	using wordIdDistribution = std::vector<int>;
+
+	/**
+	* Ordnet jedem unterschiedlichen Wort eine Id von 0 bis size() - 1 zu. Die Worte liegen in großen Blöcken,
+	* die string_views von word() bleiben gültig bis clear() aufgerufen oder das Vocabulary zerstört wird.
+	*/
+	class Vocabulary
+	{
+	public:
+		/**
+		* Gibt die Id des Wortes zurück. Unbekannte Worte werden mit der nächsten freien Id angelegt.
+		*/
+		wordId intern(std::string_view word);
+
+		/**
+		* @return	Gibt die Id des Wortes zurück oder invalidWordId wenn es unbekannt ist
+		*/
+		wordId find(std::string_view word) const;
+
+		/**
+		* @return	Gibt das Wort zu einer Id zurück. Die Id muss kleiner als size() sein.
+		*/
+		std::string_view word(wordId id) const { return words[id]; }
+
+		/// Anzahl der unterschiedlichen Worte
+		size_t size() const { return words.size(); }
+
+		/**
+		* Entfernt alle Worte, die Ids werden wieder ab 0 vergeben
+		*/
+		void clear();
+
+	private:
+		std::string_view store(std::string_view word);
+
+		std::vector<std::unique_ptr<char[]>> blocks;
+		size_t blockFree = 0;
+		char* blockPos = nullptr;
+		std::vector<std::string_view> words;
+		std::unordered_map<std::string_view, wordId> ids;
+	};
+}
+
+#endif // !TEXTANALYSER_VOCABULARY